@@ -1,50 +1,12 @@
-TARGET = SIRview
+TEMPLATE = subdirs
 
-QT += core gui
+# Numerical core, without widgets, the GUI application and the solve service
+# client linking against it
 
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets printsupport
+SUBDIRS += \
+    core \
+    app \
+    client
 
-CONFIG += c++11
-
-# The following define makes your compiler emit warnings if you use
-# any Qt feature that has been marked deprecated (the exact warnings
-# depend on your compiler). Please consult the documentation of the
-# deprecated API in order to know how to port your code away from it.
-DEFINES += QT_DEPRECATED_WARNINGS
-
-# You can also make your code fail to compile if it uses deprecated APIs.
-# In order to do so, uncomment the following line.
-# You can also select to disable deprecated APIs only up to a certain version of Qt.
-#DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
-
-INCLUDEPATH += C:/Development/boost_1_76_0
-
-SOURCES += \
-    basemodel.cpp \
-    main.cpp \
-    mainwidget.cpp \
-    phasespacemodel.cpp \
-    phasespacewidget.cpp \
-    qcustomplot.cpp \
-    scenario.cpp \
-    scenariomodel.cpp \
-    scenariosiramodel.cpp \
-    scenariowidget.cpp \
-    snapshot.cpp
-
-HEADERS += \
-    basemodel.h \
-    customvalidator.h \
-    mainwidget.h \
-    models.h \
-    phasespacemodel.h \
-    phasespacewidget.h \
-    qcustomplot.h \
-    scenario.h \
-    scenariogenericmodel.h \
-    scenariomodel.h \
-    scenariosiramodel.h \
-    scenariowidget.h \
-    snapshot.h
-
-QMAKE_CXXFLAGS_RELEASE += /MT
+app.depends = core
+client.depends = core
@@ -0,0 +1,355 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "animationexporter.h"
+#include <algorithm>
+
+AnimationExporter::AnimationExporter(int frameWidth, int frameHeight, int frames, int framesPerSecond)
+{
+    // Video encoders require even frame dimensions
+
+    width = frameWidth & ~1;
+    height = frameHeight & ~1;
+    numFrames = frames;
+    fps = framesPerSecond;
+
+    area = QRectF(70.0, 40.0, width - 100.0, height - 100.0);
+}
+
+int AnimationExporter::getNumFrames() const
+{
+    return numFrames;
+}
+
+bool AnimationExporter::exportScenarios(QString fileName, int modelIndex, const std::vector<Scenario> &scenarios, const std::vector<QString> &variableNames)
+{
+    const Qt::GlobalColor variableColors[4] = {Qt::blue, Qt::red, Qt::darkGreen, Qt::magenta};
+
+    double timeStart = scenarios.front().timeStart;
+    double timeEnd = scenarios.back().timeEnd;
+
+    int frames = numFrames;
+
+    // Scenarios are copied, their solved trajectories are shared
+
+    return exportFrames(fileName, [=](int frameIndex, QPainter &painter){
+        double time = timeStart + (timeEnd - timeStart) * frameIndex / std::max(frames - 1, 1);
+
+        drawAxes(painter, timeStart, timeEnd, 0.0, 1.0, "t/Tr", "Fractions");
+        drawTitle(painter, QString("t/Tr = %1").arg(time, 0, 'f', 2));
+
+        size_t dimension = variableNames.size();
+
+        std::vector<QPolygonF> lines(dimension);
+        state_type x;
+
+        for (size_t j = 0; j < scenarios.size(); j++)
+        {
+            const Trajectory &trajectory = *scenarios[j].trajectory;
+
+            double segmentStart = scenarios[j].timeStart;
+            double segmentEnd = j + 1 < scenarios.size() ? scenarios[j + 1].timeStart : scenarios[j].timeEnd;
+
+            if (time < segmentStart || trajectory.times.empty())
+            {
+                break;
+            }
+
+            double stop = std::min(time, segmentEnd);
+
+            for (size_t i = 0; i < trajectory.times.size() && trajectory.times[i] < stop; i++)
+            {
+                for (size_t k = 0; k < dimension; k++)
+                {
+                    lines[k] << mapToArea(trajectory.times[i], trajectory.steps[i][k], timeStart, timeEnd, 0.0, 1.0);
+                }
+            }
+
+            // Solution at the end of the segment from dense output
+
+            x = scenarios[j].denseState(stop, modelIndex);
+
+            for (size_t k = 0; k < dimension; k++)
+            {
+                lines[k] << mapToArea(stop, x[k], timeStart, timeEnd, 0.0, 1.0);
+            }
+        }
+
+        painter.setClipRect(area);
+
+        for (size_t k = 0; k < dimension; k++)
+        {
+            QColor color(variableColors[k % 4]);
+
+            painter.setPen(QPen(color, 2.0));
+            painter.drawPolyline(lines[k]);
+
+            if (!lines[k].isEmpty())
+            {
+                painter.setBrush(color);
+                painter.drawEllipse(lines[k].last(), 4.0, 4.0);
+                painter.setBrush(Qt::NoBrush);
+            }
+        }
+
+        painter.setClipping(false);
+
+        // Legend
+
+        for (size_t k = 0; k < dimension; k++)
+        {
+            painter.setPen(QPen(QColor(variableColors[k % 4]), 2.0));
+            painter.drawText(QPointF(area.right() - 120.0, area.top() + 20.0 * (k + 1)), variableNames[k]);
+        }
+    });
+}
+
+bool AnimationExporter::exportFrames(QString fileName, std::function<void(int frameIndex, QPainter &painter)> drawFrame)
+{
+    bool imageSequence = fileName.endsWith(".png", Qt::CaseInsensitive);
+
+    QProcess encoder;
+
+    if (!imageSequence)
+    {
+        QString path = encoderPath();
+
+        if (path.isEmpty())
+        {
+            return false;
+        }
+
+        // QImage::Format_RGB32 pixels are stored as BGRA bytes on little-endian machines
+
+        QStringList arguments;
+        arguments << "-y" << "-loglevel" << "error";
+        arguments << "-f" << "rawvideo" << "-pixel_format" << "bgra";
+        arguments << "-video_size" << QString("%1x%2").arg(width).arg(height);
+        arguments << "-framerate" << QString::number(fps);
+        arguments << "-i" << "-";
+        arguments << "-pix_fmt" << "yuv420p" << fileName;
+
+        encoder.start(path, arguments);
+
+        if (!encoder.waitForStarted())
+        {
+            return false;
+        }
+    }
+
+    QString baseName = fileName.left(fileName.size() - 4);
+
+    int batchSize = 2 * std::max(QThread::idealThreadCount(), 1);
+    bool success = true;
+
+    for (int first = 0; first < numFrames && success; first += batchSize)
+    {
+        int last = std::min(first + batchSize, numFrames);
+
+        std::vector<QFuture<QImage>> frames;
+
+        for (int frameIndex = first; frameIndex < last; frameIndex++)
+        {
+            frames.push_back(QtConcurrent::run([=](){
+                QImage image = renderFrame(frameIndex, drawFrame);
+
+                if (imageSequence)
+                {
+                    image.save(QString("%1_%2.png").arg(baseName).arg(frameIndex, 5, 10, QChar('0')), "PNG");
+                }
+
+                return image;
+            }));
+        }
+
+        // Frames are written to the encoder in order
+
+        for (size_t i = 0; i < frames.size(); i++)
+        {
+            QImage image = frames[i].result();
+
+            if (!imageSequence && success)
+            {
+                const char *bits = reinterpret_cast<const char*>(image.constBits());
+                qint64 numBytes = static_cast<qint64>(image.bytesPerLine()) * image.height();
+
+                if (encoder.write(bits, numBytes) != numBytes)
+                {
+                    success = false;
+                }
+
+                while (success && encoder.bytesToWrite() > 0)
+                {
+                    success = encoder.waitForBytesWritten(-1);
+                }
+            }
+        }
+    }
+
+    if (!imageSequence)
+    {
+        encoder.closeWriteChannel();
+        encoder.waitForFinished(-1);
+
+        success = success && encoder.exitStatus() == QProcess::NormalExit && encoder.exitCode() == 0;
+    }
+
+    return success;
+}
+
+QImage AnimationExporter::renderFrame(int frameIndex, const std::function<void(int, QPainter&)> &drawFrame) const
+{
+    QImage image(width, height, QImage::Format_RGB32);
+    image.fill(Qt::white);
+
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing);
+
+    drawFrame(frameIndex, painter);
+
+    painter.end();
+
+    return image;
+}
+
+QPointF AnimationExporter::mapToArea(double x, double y, double xMin, double xMax, double yMin, double yMax) const
+{
+    return QPointF(area.left() + area.width() * (x - xMin) / (xMax - xMin), area.bottom() - area.height() * (y - yMin) / (yMax - yMin));
+}
+
+void AnimationExporter::drawAxes(QPainter &painter, double xMin, double xMax, double yMin, double yMax, QString xLabel, QString yLabel) const
+{
+    painter.setPen(QPen(Qt::black, 1.0));
+    painter.setBrush(Qt::NoBrush);
+    painter.drawRect(area);
+
+    int numTicks = 5;
+
+    for (int i = 0; i <= numTicks; i++)
+    {
+        double x = xMin + (xMax - xMin) * i / numTicks;
+        QPointF xTick = mapToArea(x, yMin, xMin, xMax, yMin, yMax);
+
+        painter.drawLine(xTick, xTick - QPointF(0.0, 5.0));
+        painter.drawText(QRectF(xTick.x() - 40.0, xTick.y() + 5.0, 80.0, 20.0), Qt::AlignHCenter | Qt::AlignTop, QString::number(x, 'g', 4));
+
+        double y = yMin + (yMax - yMin) * i / numTicks;
+        QPointF yTick = mapToArea(xMin, y, xMin, xMax, yMin, yMax);
+
+        painter.drawLine(yTick, yTick + QPointF(5.0, 0.0));
+        painter.drawText(QRectF(yTick.x() - 65.0, yTick.y() - 10.0, 60.0, 20.0), Qt::AlignRight | Qt::AlignVCenter, QString::number(y, 'g', 4));
+    }
+
+    painter.drawText(QRectF(area.left(), area.bottom() + 30.0, area.width(), 20.0), Qt::AlignHCenter | Qt::AlignTop, xLabel);
+
+    painter.save();
+    painter.translate(area.left() - 55.0, area.center().y());
+    painter.rotate(-90.0);
+    painter.drawText(QRectF(-area.height() / 2.0, -20.0, area.height(), 20.0), Qt::AlignHCenter | Qt::AlignBottom, yLabel);
+    painter.restore();
+}
+
+void AnimationExporter::drawTitle(QPainter &painter, QString title) const
+{
+    painter.setPen(QPen(Qt::black, 1.0));
+    painter.drawText(QRectF(area.left(), 5.0, area.width(), area.top() - 10.0), Qt::AlignHCenter | Qt::AlignVCenter, title);
+}
+
+QString AnimationExporter::encoderPath()
+{
+    return QStandardPaths::findExecutable("ffmpeg");
+}
+
+bool AnimationExporter::settingsDialog(QWidget *parent, int &width, int &height, int &numFrames, int &fps, QLayout *extraLayout, const std::function<void()> &accepted)
+{
+    QLabel *widthLabel = new QLabel("Width (px)");
+
+    QSpinBox *widthSpinBox = new QSpinBox;
+    widthSpinBox->setRange(64, 4096);
+    widthSpinBox->setValue(width);
+
+    QLabel *heightLabel = new QLabel("Height (px)");
+
+    QSpinBox *heightSpinBox = new QSpinBox;
+    heightSpinBox->setRange(64, 2160);
+    heightSpinBox->setValue(height);
+
+    QLabel *numFramesLabel = new QLabel("Frames");
+
+    QSpinBox *numFramesSpinBox = new QSpinBox;
+    numFramesSpinBox->setRange(2, 100000);
+    numFramesSpinBox->setValue(numFrames);
+
+    QLabel *fpsLabel = new QLabel("Frames per second");
+
+    QSpinBox *fpsSpinBox = new QSpinBox;
+    fpsSpinBox->setRange(1, 120);
+    fpsSpinBox->setValue(fps);
+
+    QPushButton *acceptButton = new QPushButton("Accept");
+
+    QVBoxLayout *dialogVBoxLayout = new QVBoxLayout;
+
+    if (extraLayout != nullptr)
+    {
+        dialogVBoxLayout->addLayout(extraLayout);
+    }
+
+    dialogVBoxLayout->addWidget(widthLabel);
+    dialogVBoxLayout->addWidget(widthSpinBox);
+    dialogVBoxLayout->addWidget(heightLabel);
+    dialogVBoxLayout->addWidget(heightSpinBox);
+    dialogVBoxLayout->addWidget(numFramesLabel);
+    dialogVBoxLayout->addWidget(numFramesSpinBox);
+    dialogVBoxLayout->addWidget(fpsLabel);
+    dialogVBoxLayout->addWidget(fpsSpinBox);
+    dialogVBoxLayout->addWidget(acceptButton);
+
+    QDialog dialog(parent);
+    dialog.setLayout(dialogVBoxLayout);
+
+    QObject::connect(acceptButton, &QPushButton::clicked, &dialog, &QDialog::accept);
+
+    if (dialog.exec() != QDialog::Accepted)
+    {
+        return false;
+    }
+
+    width = widthSpinBox->value();
+    height = heightSpinBox->value();
+    numFrames = numFramesSpinBox->value();
+    fps = fpsSpinBox->value();
+
+    if (accepted)
+    {
+        accepted();
+    }
+
+    return true;
+}
+
+QString AnimationExporter::fileDialog(QWidget *parent)
+{
+    QString filters = "Image sequence (*.png)";
+
+    if (!encoderPath().isEmpty())
+    {
+        filters.prepend("Video (*.mp4);;");
+    }
+
+    return QFileDialog::getSaveFileName(parent, "Export animation", "", filters);
+}
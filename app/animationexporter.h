@@ -0,0 +1,78 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef ANIMATIONEXPORTER_H
+#define ANIMATIONEXPORTER_H
+
+#include "scenario.h"
+#include <vector>
+#include <functional>
+#include <QString>
+#include <QImage>
+#include <QPainter>
+#include <QPolygonF>
+#include <QRectF>
+#include <QProcess>
+#include <QStandardPaths>
+#include <QThread>
+#include <QFuture>
+#include <QtConcurrent>
+#include <QWidget>
+#include <QDialog>
+#include <QLabel>
+#include <QSpinBox>
+#include <QPushButton>
+#include <QVBoxLayout>
+#include <QFileDialog>
+
+// Exports animations as PNG image sequences, or as videos when an ffmpeg
+// encoder is found, in which case raw frames are piped to it
+// Frames are drawn offscreen on QImages, in parallel batches
+
+class AnimationExporter
+{
+public:
+    AnimationExporter(int frameWidth, int frameHeight, int frames, int framesPerSecond);
+
+    int getNumFrames() const;
+
+    bool exportScenarios(QString fileName, int modelIndex, const std::vector<Scenario> &scenarios, const std::vector<QString> &variableNames);
+    bool exportFrames(QString fileName, std::function<void(int frameIndex, QPainter &painter)> drawFrame);
+
+    QPointF mapToArea(double x, double y, double xMin, double xMax, double yMin, double yMax) const;
+    void drawAxes(QPainter &painter, double xMin, double xMax, double yMin, double yMax, QString xLabel, QString yLabel) const;
+    void drawTitle(QPainter &painter, QString title) const;
+
+    static QString encoderPath();
+
+    // Widgets of extraLayout belong to the dialog, so their values are read in accepted, before it is destroyed
+
+    static bool settingsDialog(QWidget *parent, int &width, int &height, int &numFrames, int &fps, QLayout *extraLayout = nullptr, const std::function<void()> &accepted = nullptr);
+    static QString fileDialog(QWidget *parent);
+
+private:
+    int width;
+    int height;
+    int numFrames;
+    int fps;
+
+    QRectF area;
+
+    QImage renderFrame(int frameIndex, const std::function<void(int, QPainter&)> &drawFrame) const;
+};
+
+#endif // ANIMATIONEXPORTER_H
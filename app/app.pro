@@ -0,0 +1,80 @@
+TARGET = SIRview
+
+QT += core gui
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets printsupport concurrent network
+
+CONFIG += c++17
+
+# The following define makes your compiler emit warnings if you use
+# any Qt feature that has been marked deprecated (the exact warnings
+# depend on your compiler). Please consult the documentation of the
+# deprecated API in order to know how to port your code away from it.
+DEFINES += QT_DEPRECATED_WARNINGS
+
+# You can also make your code fail to compile if it uses deprecated APIs.
+# In order to do so, uncomment the following line.
+# You can also select to disable deprecated APIs only up to a certain version of Qt.
+#DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
+
+INCLUDEPATH += C:/Development/boost_1_76_0
+
+# Numerical core library
+
+INCLUDEPATH += $$PWD/../core
+DEPENDPATH += $$PWD/../core
+
+win32:CONFIG(release, debug|release): CORE_LIB_DIR = $$OUT_PWD/../core/release
+else:win32:CONFIG(debug, debug|release): CORE_LIB_DIR = $$OUT_PWD/../core/debug
+else: CORE_LIB_DIR = $$OUT_PWD/../core
+
+LIBS += -L$$CORE_LIB_DIR -lsirviewcore
+
+win32-msvc*: PRE_TARGETDEPS += $$CORE_LIB_DIR/sirviewcore.lib
+else: PRE_TARGETDEPS += $$CORE_LIB_DIR/libsirviewcore.a
+
+SOURCES += \
+    animationexporter.cpp \
+    basemodel.cpp \
+    batchexporter.cpp \
+    headless.cpp \
+    heatmapwidget.cpp \
+    localsolveserver.cpp \
+    main.cpp \
+    mainwidget.cpp \
+    phasespacemodel.cpp \
+    phasespacewidget.cpp \
+    qcustomplot.cpp \
+    scenariomodel.cpp \
+    scenariosiramodel.cpp \
+    scenariowidget.cpp \
+    sensitivitywidget.cpp \
+    seriesslots.cpp \
+    session.cpp \
+    snapshot.cpp \
+    snapshotcache.cpp
+
+HEADERS += \
+    animationexporter.h \
+    basemodel.h \
+    batchexporter.h \
+    customvalidator.h \
+    headless.h \
+    heatmapwidget.h \
+    jobprogressdialog.h \
+    localsolveserver.h \
+    mainwidget.h \
+    phasespacemodel.h \
+    phasespacewidget.h \
+    qcustomplot.h \
+    scenariogenericmodel.h \
+    scenariomodel.h \
+    scenariosiramodel.h \
+    scenariowidget.h \
+    sensitivitywidget.h \
+    seriesslots.h \
+    session.h \
+    snapshot.h \
+    snapshotcache.h
+
+QMAKE_CXXFLAGS_RELEASE += /MT
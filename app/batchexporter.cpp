@@ -0,0 +1,134 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "batchexporter.h"
+
+BatchExporter::BatchExporter(QString directoryPath, int imageWidth, int imageHeight, QString imageFormat):
+    directory(directoryPath),
+    width(imageWidth),
+    height(imageHeight),
+    format(imageFormat){}
+
+void BatchExporter::addPlot(QCustomPlot *plot, QString name)
+{
+    // Recording must happen on the GUI thread, as it lays out the plot
+
+    QPicture picture;
+
+    QCPPainter painter;
+    painter.begin(&picture);
+
+    if (format == "pdf")
+    {
+        painter.setMode(QCPPainter::pmVectorized);
+    }
+
+    plot->toPainter(&painter, width, height);
+    painter.end();
+
+    picture.setBoundingRect(QRect(0, 0, width, height));
+
+    QString fileName = directory.filePath(fileNamePart(name) + "." + format);
+
+    futures.push_back(QtConcurrent::run(&BatchExporter::writePicture, picture, fileName, format, width, height));
+}
+
+int BatchExporter::numPlots() const
+{
+    return static_cast<int>(futures.size());
+}
+
+int BatchExporter::numFinished() const
+{
+    int numFinished = 0;
+
+    for (size_t i = 0; i < futures.size(); i++)
+    {
+        if (futures[i].isFinished())
+        {
+            numFinished++;
+        }
+    }
+
+    return numFinished;
+}
+
+int BatchExporter::waitForFinished()
+{
+    int numFiles = 0;
+
+    for (size_t i = 0; i < futures.size(); i++)
+    {
+        futures[i].waitForFinished();
+
+        if (futures[i].result())
+        {
+            numFiles++;
+        }
+    }
+
+    futures.clear();
+
+    return numFiles;
+}
+
+QString BatchExporter::fileNamePart(QString text)
+{
+    for (int i = 0; i < text.size(); i++)
+    {
+        if (!text[i].isLetterOrNumber())
+        {
+            text[i] = '_';
+        }
+    }
+
+    return text;
+}
+
+bool BatchExporter::writePicture(QPicture picture, QString fileName, QString format, int width, int height)
+{
+    if (format == "pdf")
+    {
+        QPdfWriter writer(fileName);
+        writer.setResolution(72);
+        writer.setPageSize(QPageSize(QSizeF(width, height), QPageSize::Point, QString(), QPageSize::ExactMatch));
+        writer.setPageMargins(QMarginsF(0, 0, 0, 0));
+
+        QPainter painter;
+
+        if (!painter.begin(&writer))
+        {
+            return false;
+        }
+
+        painter.drawPicture(0, 0, picture);
+        painter.end();
+
+        return true;
+    }
+    else
+    {
+        QImage image(width, height, QImage::Format_RGB32);
+        image.fill(Qt::white);
+
+        QPainter painter(&image);
+        painter.drawPicture(0, 0, picture);
+        painter.end();
+
+        return image.save(fileName, format.toLatin1().constData());
+    }
+}
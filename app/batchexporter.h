@@ -0,0 +1,60 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef BATCHEXPORTER_H
+#define BATCHEXPORTER_H
+
+#include "qcustomplot.h"
+#include <vector>
+#include <QString>
+#include <QPicture>
+#include <QImage>
+#include <QPainter>
+#include <QPdfWriter>
+#include <QPageSize>
+#include <QDir>
+#include <QFuture>
+#include <QtConcurrent>
+
+// Exports many plots at once to PNG, JPG or PDF files
+// Plots are recorded on the GUI thread, then rasterized, encoded and
+// written concurrently on worker threads
+
+class BatchExporter
+{
+public:
+    BatchExporter(QString directoryPath, int imageWidth, int imageHeight, QString imageFormat);
+
+    void addPlot(QCustomPlot *plot, QString name);
+    int numPlots() const;
+    int numFinished() const;
+    int waitForFinished();
+
+    static QString fileNamePart(QString text);
+
+private:
+    QDir directory;
+    int width;
+    int height;
+    QString format;
+
+    std::vector<QFuture<bool>> futures;
+
+    static bool writePicture(QPicture picture, QString fileName, QString format, int width, int height);
+};
+
+#endif // BATCHEXPORTER_H
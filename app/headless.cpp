@@ -0,0 +1,294 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "headless.h"
+#include "modelcatalog.h"
+#include "scenariointegrator.h"
+#include "exportjob.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <QCoreApplication>
+#include <QFile>
+#include <QByteArray>
+#include <QList>
+
+static const char *usage = "Usage: SIRview --headless [-f text|full|columnar] [-o output] [input]\n";
+
+static int fail(QString message)
+{
+    std::fprintf(stderr, "SIRview: %s\n", message.toLocal8Bit().constData());
+    return 1;
+}
+
+bool isHeadlessInvocation(int argc, char *argv[])
+{
+    return argc > 1 && std::strcmp(argv[1], "--headless") == 0;
+}
+
+// Parses a scenario chain description, see headless.h
+
+static bool parseScenarioChain(const QByteArray &input, int &modelIndex, std::vector<Scenario> &scenarios, QString &error)
+{
+    modelIndex = -1;
+
+    std::vector<double> initialConditions;
+
+    QList<QByteArray> lines = input.split('\n');
+
+    for (int l = 0; l < lines.size(); l++)
+    {
+        QByteArray line = lines[l];
+
+        int comment = line.indexOf('#');
+        if (comment >= 0) line.truncate(comment);
+
+        QList<QByteArray> tokens = line.simplified().split(' ');
+
+        if (tokens.isEmpty() || tokens[0].isEmpty()) continue;
+
+        QByteArray directive = tokens[0].toLower();
+        tokens.removeFirst();
+
+        QString location = QString("line %1: ").arg(l + 1);
+
+        // Numeric arguments
+
+        std::vector<double> values;
+
+        if (directive != "model")
+        {
+            for (const QByteArray &token : tokens)
+            {
+                bool ok;
+                double value = token.toDouble(&ok);
+
+                if (!ok || !std::isfinite(value))
+                {
+                    error = location + QString("invalid number \"%1\"").arg(QString::fromLocal8Bit(token));
+                    return false;
+                }
+
+                values.push_back(value);
+            }
+        }
+
+        if (directive == "model")
+        {
+            if (modelIndex >= 0)
+            {
+                error = location + "model already given";
+                return false;
+            }
+
+            modelIndex = findScenarioModel(QString::fromLocal8Bit(tokens.join(' ')));
+
+            if (modelIndex < 0)
+            {
+                error = location + QString("unknown model \"%1\"").arg(QString::fromLocal8Bit(tokens.join(' ')));
+                return false;
+            }
+
+            const ModelDefinition &definition = scenarioModelDefinitions()[modelIndex];
+            initialConditions.assign(definition.initialConditions.begin(), definition.initialConditions.end());
+        }
+        else if (modelIndex < 0)
+        {
+            error = location + "model must be given first";
+            return false;
+        }
+        else if (directive == "initial")
+        {
+            if (!scenarios.empty())
+            {
+                error = location + "initial conditions must precede scenarios";
+                return false;
+            }
+
+            if (values.size() != initialConditions.size())
+            {
+                error = location + QString("expected %1 initial conditions").arg(initialConditions.size());
+                return false;
+            }
+
+            initialConditions = values;
+        }
+        else if (directive == "scenario")
+        {
+            const ModelDefinition &definition = scenarioModelDefinitions()[modelIndex];
+
+            std::vector<double> parameterMin(definition.parameterMin.begin(), definition.parameterMin.end());
+            std::vector<double> parameterMax(definition.parameterMax.begin(), definition.parameterMax.end());
+            std::vector<double> parameters = scenarios.empty() ? std::vector<double>(definition.parameterInit.begin(), definition.parameterInit.end()) : scenarios.back().parameters;
+
+            if (values.size() < 2 || values.size() > 2 + parameters.size())
+            {
+                error = location + QString("expected time start, time end and up to %1 parameters").arg(parameters.size());
+                return false;
+            }
+
+            double timeStart = values[0];
+            double timeEnd = values[1];
+
+            if (timeEnd <= timeStart)
+            {
+                error = location + "time end must be greater than time start";
+                return false;
+            }
+
+            if (!scenarios.empty() && (timeStart < scenarios.back().timeStart || timeStart > scenarios.back().timeEnd))
+            {
+                error = location + "time start must lie within the previous scenario";
+                return false;
+            }
+
+            for (size_t k = 2; k < values.size(); k++)
+            {
+                parameters[k - 2] = values[k];
+            }
+
+            double timeStartMin = scenarios.empty() ? timeStart : scenarios.back().timeStart;
+            double timeStartMax = scenarios.empty() ? timeStart : scenarios.back().timeEnd;
+
+            scenarios.push_back(Scenario(initialConditions, parameters, parameterMin, parameterMax, timeStart, timeStartMin, timeStartMax, timeEnd, timeStart, timeEnd));
+        }
+        else
+        {
+            error = location + QString("unknown directive \"%1\"").arg(QString::fromLocal8Bit(directive));
+            return false;
+        }
+    }
+
+    if (modelIndex < 0)
+    {
+        error = "no model given";
+        return false;
+    }
+
+    if (scenarios.empty())
+    {
+        error = "no scenarios given";
+        return false;
+    }
+
+    return true;
+}
+
+int runHeadless(int argc, char *argv[])
+{
+    // No widgets nor platform plugins, so that startup stays cheap
+
+    QCoreApplication application(argc, argv);
+    application.setApplicationName("SIRview");
+
+    // Arguments
+
+    QString inputFileName = "-";
+    QString outputFileName = "-";
+    ExportJob::Format format = ExportJob::Text;
+
+    bool inputGiven = false;
+
+    for (int i = 2; i < argc; i++)
+    {
+        QByteArray argument = argv[i];
+
+        if ((argument == "-o" || argument == "-f") && i + 1 < argc)
+        {
+            QByteArray value = argv[++i];
+
+            if (argument == "-o")
+                outputFileName = QString::fromLocal8Bit(value);
+            else if (value == "text")
+                format = ExportJob::Text;
+            else if (value == "full")
+                format = ExportJob::FullPrecisionText;
+            else if (value == "columnar")
+                format = ExportJob::Columnar;
+            else
+            {
+                std::fputs(usage, stderr);
+                return fail(QString("unknown format \"%1\"").arg(QString::fromLocal8Bit(value)));
+            }
+        }
+        else if (argument == "-h" || argument == "--help")
+        {
+            std::fputs(usage, stdout);
+            return 0;
+        }
+        else if (!inputGiven && (argument == "-" || !argument.startsWith('-')))
+        {
+            inputFileName = QString::fromLocal8Bit(argument);
+            inputGiven = true;
+        }
+        else
+        {
+            std::fputs(usage, stderr);
+            return fail(QString("unexpected argument \"%1\"").arg(QString::fromLocal8Bit(argument)));
+        }
+    }
+
+    // Input
+
+    QFile inputFile(inputFileName == "-" ? QString() : inputFileName);
+
+    bool opened = inputFileName == "-" ? inputFile.open(stdin, QIODevice::ReadOnly) : inputFile.open(QIODevice::ReadOnly);
+
+    if (!opened)
+        return fail(QString("cannot read %1").arg(inputFileName));
+
+    QByteArray input = inputFile.readAll();
+    inputFile.close();
+
+    int modelIndex;
+    std::vector<Scenario> scenarios;
+    QString error;
+
+    if (!parseScenarioChain(input, modelIndex, scenarios, error))
+        return fail(QString("%1: %2").arg(inputFileName == "-" ? "stdin" : inputFileName, error));
+
+    // Same integration path as the scenario widget
+
+    integrateScenarios(modelIndex, scenarios, 0, false);
+
+    // Output
+
+    const ModelDefinition &definition = scenarioModelDefinitions()[modelIndex];
+
+    ExportSource source;
+    source.modelName = definition.name;
+    source.modelIndex = modelIndex;
+    source.dimension = static_cast<int>(definition.variableShortNames.size());
+    source.variableShortNames.assign(definition.variableShortNames.begin(), definition.variableShortNames.end());
+    source.variableLongNames.assign(definition.variableLongNames.begin(), definition.variableLongNames.end());
+    source.parameterNames.assign(definition.parameterNames.begin(), definition.parameterNames.end());
+    source.scenarios = scenarios;
+
+    bool success = false;
+
+    ExportJob job(source, outputFileName, format);
+
+    QObject::connect(&job, &ExportJob::finished, [&success](bool jobSuccess, bool){ success = jobSuccess; });
+
+    job.run();
+
+    if (!success)
+        return fail(QString("cannot write %1").arg(outputFileName));
+
+    return 0;
+}
@@ -0,0 +1,42 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+// Command line solver without widgets, e.g.
+//
+//     SIRview --headless [-f text|full|columnar] [-o output] [input]
+//
+// Reads a scenario chain from the input file (standard input if omitted or "-"),
+// integrates it as the scenario widget does and writes the result in one of the
+// export formats to the output file (standard output if omitted or "-")
+//
+// Input format, one directive per line, "#" starts a comment:
+//
+//     model SEIR                     model name or index
+//     initial 0.9999999 0 1e-7 0     optional initial conditions
+//     scenario 0 100 2.5 0.1         time start, time end and parameters
+//     scenario 60 200 1.2            missing parameters keep the previous values
+//
+// Each scenario starts from the state of the previous one at its time start
+
+bool isHeadlessInvocation(int argc, char *argv[]);
+int runHeadless(int argc, char *argv[]);
+
+#endif // HEADLESS_H
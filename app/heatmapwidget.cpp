@@ -0,0 +1,319 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "heatmapwidget.h"
+#include <QtConcurrent>
+
+HeatmapWidget::HeatmapWidget(QWidget *parent): QWidget(parent)
+{
+    settings.modelIndex = -1;
+    settings.timeEnd = 0.0;
+
+    resolution = 0;
+    pending = false;
+
+    // Controls
+
+    metricComboBox = new QComboBox;
+    metricComboBox->addItem("Peak infected");
+    metricComboBox->addItem("Time of peak");
+    metricComboBox->addItem("Final size");
+
+    analyticCheckBox = new QCheckBox("Analytic");
+    analyticCheckBox->setToolTip("Closed forms as time goes to infinity, where the model has them for the metric");
+    analyticCheckBox->setEnabled(false);
+
+    xParameterComboBox = new QComboBox;
+    yParameterComboBox = new QComboBox;
+
+    statusLabel = new QLabel;
+
+    QHBoxLayout *controlsHBoxLayout = new QHBoxLayout;
+    controlsHBoxLayout->addWidget(new QLabel("Metric"));
+    controlsHBoxLayout->addWidget(metricComboBox);
+    controlsHBoxLayout->addWidget(analyticCheckBox);
+    controlsHBoxLayout->addWidget(new QLabel("Horizontal"));
+    controlsHBoxLayout->addWidget(xParameterComboBox);
+    controlsHBoxLayout->addWidget(new QLabel("Vertical"));
+    controlsHBoxLayout->addWidget(yParameterComboBox);
+    controlsHBoxLayout->addStretch();
+    controlsHBoxLayout->addWidget(statusLabel);
+
+    // Color map
+
+    plot = new QCustomPlot;
+
+    plot->setInteractions(QCP::iRangeZoom | QCP::iRangeDrag);
+    plot->axisRect()->setupFullAxesBox(true);
+
+    colorMap = new QCPColorMap(plot->xAxis, plot->yAxis);
+    colorMap->setGradient(QCPColorGradient::gpThermal);
+    colorMap->setInterpolate(false);
+
+    colorScale = new QCPColorScale(plot);
+    plot->plotLayout()->addElement(0, 1, colorScale);
+    colorMap->setColorScale(colorScale);
+
+    QCPMarginGroup *marginGroup = new QCPMarginGroup(plot);
+    plot->axisRect()->setMarginGroup(QCP::msBottom | QCP::msTop, marginGroup);
+    colorScale->setMarginGroup(QCP::msBottom | QCP::msTop, marginGroup);
+
+    QVBoxLayout *mainVBoxLayout = new QVBoxLayout;
+    mainVBoxLayout->addLayout(controlsHBoxLayout);
+    mainVBoxLayout->addWidget(plot);
+
+    setLayout(mainVBoxLayout);
+
+    watcher = new QFutureWatcher<std::vector<SweepMetrics>>(this);
+
+    // Signals + Slots
+
+    connect(metricComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged), [=](int){ onMetricComboBoxChanged(); });
+    connect(analyticCheckBox, &QCheckBox::toggled, [=](bool){ onMetricComboBoxChanged(); });
+    connect(xParameterComboBox, QOverload<int>::of(&QComboBox::activated), [=](int){ onParameterComboBoxChanged(true); });
+    connect(yParameterComboBox, QOverload<int>::of(&QComboBox::activated), [=](int){ onParameterComboBoxChanged(false); });
+    connect(watcher, &QFutureWatcher<std::vector<SweepMetrics>>::finished, this, &HeatmapWidget::onLevelFinished);
+}
+
+HeatmapWidget::~HeatmapWidget()
+{
+    // Let a running level stop early, the pool waits for it
+
+    if (canceled)
+        *canceled = true;
+
+    watcher->waitForFinished();
+}
+
+void HeatmapWidget::setModel(const ScenarioModel *model)
+{
+    bool modelChanged = model->modelIndex != settings.modelIndex;
+
+    if (modelChanged)
+    {
+        // Parameter names and ranges of the new model, the first two swept by default
+
+        settings.modelIndex = model->modelIndex;
+
+        parameterMin = model->parameterMin;
+        parameterMax = model->parameterMax;
+
+        xParameterComboBox->clear();
+        yParameterComboBox->clear();
+
+        for (int i = 0; i < model->numParameters; i++)
+        {
+            xParameterComboBox->addItem(model->parameterNames[i]->text());
+            yParameterComboBox->addItem(model->parameterNames[i]->text());
+        }
+
+        xParameterComboBox->setCurrentIndex(0);
+        yParameterComboBox->setCurrentIndex(model->numParameters > 1 ? 1 : 0);
+
+        analyticCheckBox->setEnabled(hasAnalyticPeak(settings.modelIndex) || hasAnalyticFinalSize(settings.modelIndex));
+    }
+
+    const Scenario &scenario = model->scenarios[model->currentScenarioIndex];
+
+    std::vector<double> parameters = scenario.parameters;
+    state_type initialConditions = model->scenarios.front().x0;
+    double timeEnd = model->scenarios.back().timeEnd - model->scenarios.front().timeStart;
+
+    // Swept parameters do not matter, so dragging them leaves the plane unchanged
+
+    int xIndex = xParameterComboBox->currentIndex();
+    int yIndex = yParameterComboBox->currentIndex();
+
+    if (!modelChanged && settings.parameters.size() == parameters.size())
+    {
+        std::vector<double> previous = settings.parameters;
+
+        if (xIndex >= 0) previous[xIndex] = parameters[xIndex];
+        if (yIndex >= 0) previous[yIndex] = parameters[yIndex];
+
+        if (previous == parameters && settings.initialConditions == initialConditions && settings.timeEnd == timeEnd)
+            return;
+    }
+
+    settings.parameters = parameters;
+    settings.initialConditions = initialConditions;
+    settings.timeEnd = timeEnd;
+
+    restart();
+}
+
+bool HeatmapWidget::useAnalytic() const
+{
+    if (!analyticCheckBox->isEnabled() || !analyticCheckBox->isChecked())
+        return false;
+
+    int metric = metricComboBox->currentIndex();
+
+    return (metric == 0 && hasAnalyticPeak(settings.modelIndex)) || (metric == 2 && hasAnalyticFinalSize(settings.modelIndex));
+}
+
+void HeatmapWidget::onMetricComboBoxChanged()
+{
+    // Every metric is computed at once, unless closed forms are used or stop being used
+
+    if (useAnalytic() != settings.analytic)
+        restart();
+    else
+        setColorMapData();
+}
+
+void HeatmapWidget::onParameterComboBoxChanged(bool xChanged)
+{
+    // Keep two different parameters on the axes
+
+    if (xParameterComboBox->currentIndex() == yParameterComboBox->currentIndex() && xParameterComboBox->count() > 1)
+    {
+        QComboBox *other = xChanged ? yParameterComboBox : xParameterComboBox;
+        other->setCurrentIndex((other->currentIndex() + 1) % other->count());
+    }
+
+    restart();
+}
+
+void HeatmapWidget::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+
+    if (pending)
+        restart();
+}
+
+void HeatmapWidget::restart()
+{
+    if (canceled)
+        *canceled = true;
+
+    metrics.clear();
+    resolution = 0;
+
+    // Only computed while shown
+
+    if (!isVisible())
+    {
+        pending = true;
+        return;
+    }
+
+    pending = false;
+
+    if (settings.parameters.size() < 2)
+    {
+        colorMap->data()->clear();
+        statusLabel->setText("The model needs at least two parameters");
+        plot->replot();
+        return;
+    }
+
+    settings.analytic = useAnalytic();
+
+    compute(settings.analytic ? finestResolution : coarsestResolution);
+}
+
+void HeatmapWidget::compute(int gridResolution)
+{
+    int xIndex = xParameterComboBox->currentIndex();
+    int yIndex = yParameterComboBox->currentIndex();
+
+    SweepSettings levelSettings = settings;
+    levelSettings.axes = {
+        SweepAxis{xIndex, parameterMin[xIndex], parameterMax[xIndex], gridResolution},
+        SweepAxis{yIndex, parameterMin[yIndex], parameterMax[yIndex], gridResolution}
+    };
+
+    canceled = std::make_shared<std::atomic<bool>>(false);
+
+    std::shared_ptr<std::atomic<bool>> levelCanceled = canceled;
+
+    statusLabel->setText(QString("Computing %1 x %1").arg(gridResolution));
+
+    watcher->setProperty("resolution", gridResolution);
+    watcher->setFuture(QtConcurrent::run([levelSettings, levelCanceled](){
+        ParameterSweep sweep(levelSettings);
+
+        if (!sweep.run(*levelCanceled, nullptr))
+            return std::vector<SweepMetrics>();
+
+        return sweep.getMetrics();
+    }));
+}
+
+void HeatmapWidget::onLevelFinished()
+{
+    std::vector<SweepMetrics> levelMetrics = watcher->result();
+
+    // Superseded levels are discarded
+
+    if (levelMetrics.empty() || *canceled)
+        return;
+
+    metrics = std::move(levelMetrics);
+    resolution = watcher->property("resolution").toInt();
+
+    setColorMapData();
+
+    if (resolution < finestResolution)
+        compute(2 * resolution);
+    else
+        statusLabel->setText(QString(settings.analytic ? "%1 x %1 analytic" : "%1 x %1").arg(resolution));
+}
+
+void HeatmapWidget::setColorMapData()
+{
+    if (metrics.empty())
+        return;
+
+    int xIndex = xParameterComboBox->currentIndex();
+    int yIndex = yParameterComboBox->currentIndex();
+
+    colorMap->data()->setSize(resolution, resolution);
+    colorMap->data()->setRange(QCPRange(parameterMin[xIndex], parameterMax[xIndex]), QCPRange(parameterMin[yIndex], parameterMax[yIndex]));
+
+    int metric = metricComboBox->currentIndex();
+
+    // Last axis, the vertical one, varies fastest
+
+    for (int i = 0; i < resolution; i++)
+    {
+        for (int j = 0; j < resolution; j++)
+        {
+            const SweepMetrics &point = metrics[i * resolution + j];
+
+            double value = point.peakInfected;
+
+            if (metric == 1)
+                value = point.peakTime;
+            else if (metric == 2)
+                value = point.attackRate;
+
+            colorMap->data()->setCell(i, j, value);
+        }
+    }
+
+    plot->xAxis->setLabel(xParameterComboBox->currentText());
+    plot->yAxis->setLabel(yParameterComboBox->currentText());
+    colorScale->axis()->setLabel(metricComboBox->currentText());
+
+    colorMap->rescaleDataRange(true);
+    plot->rescaleAxes();
+    plot->replot();
+}
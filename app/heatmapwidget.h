@@ -0,0 +1,90 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#ifndef HEATMAPWIDGET_H
+#define HEATMAPWIDGET_H
+
+#include "scenariomodel.h"
+#include "analyticmetrics.h"
+#include "parametersweep.h"
+#include "qcustomplot.h"
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <QWidget>
+#include <QCheckBox>
+#include <QComboBox>
+#include <QLabel>
+#include <QFutureWatcher>
+
+// Metric of the current scenario model over a plane of two of its parameters
+// Other parameters take the values of the current scenario. Each point is integrated
+// from the initial conditions of the first scenario over the time span of the chain
+// The grid is computed in the background, from coarse to fine, and restarts from
+// the coarsest one whenever the model or its parameters change
+// Metrics with a closed form for the model can be taken from it instead, see
+// analyticmetrics.h, on the finest grid at once
+
+class HeatmapWidget: public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit HeatmapWidget(QWidget *parent = nullptr);
+    ~HeatmapWidget();
+
+    void setModel(const ScenarioModel *model);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+
+private:
+    QComboBox *metricComboBox;
+    QCheckBox *analyticCheckBox;
+    QComboBox *xParameterComboBox;
+    QComboBox *yParameterComboBox;
+    QLabel *statusLabel;
+
+    QCustomPlot *plot;
+    QCPColorMap *colorMap;
+    QCPColorScale *colorScale;
+
+    SweepSettings settings;
+    std::vector<double> parameterMin;
+    std::vector<double> parameterMax;
+
+    std::vector<SweepMetrics> metrics;
+    int resolution;
+
+    QFutureWatcher<std::vector<SweepMetrics>> *watcher;
+    std::shared_ptr<std::atomic<bool>> canceled;
+    bool pending;
+
+    static const int coarsestResolution = 8;
+    static const int finestResolution = 128;
+
+    bool useAnalytic() const;
+    void onMetricComboBoxChanged();
+    void onParameterComboBoxChanged(bool xChanged);
+    void restart();
+    void compute(int gridResolution);
+    void onLevelFinished();
+    void setColorMapData();
+};
+
+#endif // HEATMAPWIDGET_H
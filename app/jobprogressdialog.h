@@ -0,0 +1,44 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef JOBPROGRESSDIALOG_H
+#define JOBPROGRESSDIALOG_H
+
+#include <QProgressDialog>
+#include <QString>
+#include <QWidget>
+
+// Non-modal progress of a background job, so that several jobs can run while working
+// Shown only if the job takes a while, canceling it cancels the job, and it is deleted when the job finishes
+
+template <class Job>
+QProgressDialog *jobProgressDialog(Job *job, QString labelText, QWidget *parent)
+{
+    QProgressDialog *progressDialog = new QProgressDialog(labelText, "Cancel", 0, 100, parent);
+    progressDialog->setWindowModality(Qt::NonModal);
+    progressDialog->setMinimumDuration(500);
+    progressDialog->setAutoClose(false);
+    progressDialog->setAutoReset(false);
+
+    QObject::connect(job, &Job::progressChanged, progressDialog, &QProgressDialog::setValue);
+    QObject::connect(progressDialog, &QProgressDialog::canceled, job, &Job::cancel, Qt::DirectConnection);
+    QObject::connect(job, &Job::finished, progressDialog, &QObject::deleteLater);
+
+    return progressDialog;
+}
+
+#endif // JOBPROGRESSDIALOG_H
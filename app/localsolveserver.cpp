@@ -0,0 +1,166 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "localsolveserver.h"
+#include <cstdio>
+#include <cstring>
+#include <QCoreApplication>
+#include <QFutureWatcher>
+#include <QPointer>
+#include <QtConcurrent>
+
+LocalSolveServer::LocalSolveServer(QObject *parent): QObject(parent)
+{
+    server = new QLocalServer(this);
+
+    connect(server, &QLocalServer::newConnection, this, &LocalSolveServer::acceptConnections);
+}
+
+bool LocalSolveServer::listen(QString name)
+{
+    // A previous instance may have left a stale socket behind
+
+    QLocalServer::removeServer(name);
+
+    return server->listen(name);
+}
+
+QString LocalSolveServer::getServerName() const
+{
+    return server->fullServerName();
+}
+
+QString LocalSolveServer::errorString() const
+{
+    return server->errorString();
+}
+
+QString LocalSolveServer::defaultName()
+{
+    return "sirview-solver";
+}
+
+void LocalSolveServer::acceptConnections()
+{
+    while (server->hasPendingConnections())
+    {
+        QLocalSocket *socket = server->nextPendingConnection();
+
+        connections.insert(socket, Connection());
+
+        connect(socket, &QLocalSocket::readyRead, this, [=](){
+            connections[socket].buffer.append(socket->readAll());
+            dispatch(socket);
+        });
+
+        connect(socket, &QLocalSocket::disconnected, this, [=](){
+            connections.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void LocalSolveServer::dispatch(QLocalSocket *socket)
+{
+    auto it = connections.find(socket);
+
+    if (it == connections.end() || it->busy)
+        return;
+
+    QByteArray &buffer = it->buffer;
+
+    if (buffer.size() < static_cast<int>(sizeof(quint32)))
+        return;
+
+    quint32 payloadSize;
+    std::memcpy(&payloadSize, buffer.constData(), sizeof(payloadSize));
+
+    if (payloadSize > solveMaxPayloadSize)
+    {
+        socket->abort();
+        return;
+    }
+
+    if (buffer.size() < static_cast<int>(sizeof(quint32) + payloadSize))
+        return;
+
+    QByteArray payload = buffer.mid(sizeof(quint32), payloadSize);
+    buffer.remove(0, sizeof(quint32) + payloadSize);
+
+    it->busy = true;
+
+    // Solve off the event loop, then answer and continue with buffered requests
+
+    QPointer<QLocalSocket> guardedSocket(socket);
+
+    QFutureWatcher<std::vector<char>> *watcher = new QFutureWatcher<std::vector<char>>(this);
+
+    connect(watcher, &QFutureWatcher<std::vector<char>>::finished, this, [=](){
+        std::vector<char> response = watcher->result();
+        watcher->deleteLater();
+
+        if (guardedSocket.isNull() || !connections.contains(guardedSocket))
+            return;
+
+        // Responses are bounded by the service, a larger one would not fit the frame
+
+        if (response.size() > solveMaxPayloadSize)
+        {
+            guardedSocket->abort();
+            return;
+        }
+
+        quint32 responseSize = static_cast<quint32>(response.size());
+
+        guardedSocket->write(reinterpret_cast<const char*>(&responseSize), sizeof(responseSize));
+        guardedSocket->write(response.data(), static_cast<qint64>(response.size()));
+
+        connections[guardedSocket].busy = false;
+
+        dispatch(guardedSocket);
+    });
+
+    watcher->setFuture(QtConcurrent::run([this, payload](){
+        return service.handle(payload.constData(), static_cast<size_t>(payload.size()));
+    }));
+}
+
+bool isServiceInvocation(int argc, char *argv[])
+{
+    return argc > 1 && std::strcmp(argv[1], "--serve") == 0;
+}
+
+int runSolveService(int argc, char *argv[])
+{
+    QCoreApplication application(argc, argv);
+    application.setApplicationName("SIRview");
+
+    QString name = argc > 2 ? QString::fromLocal8Bit(argv[2]) : LocalSolveServer::defaultName();
+
+    LocalSolveServer solveServer;
+
+    if (!solveServer.listen(name))
+    {
+        std::fprintf(stderr, "SIRview: cannot listen on %s: %s\n", name.toLocal8Bit().constData(), solveServer.errorString().toLocal8Bit().constData());
+        return 1;
+    }
+
+    std::fprintf(stderr, "SIRview: solve service listening on %s\n", solveServer.getServerName().toLocal8Bit().constData());
+
+    return application.exec();
+}
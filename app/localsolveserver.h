@@ -0,0 +1,71 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#ifndef LOCALSOLVESERVER_H
+#define LOCALSOLVESERVER_H
+
+#include "solveservice.h"
+#include <QObject>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+
+// Local solve service, e.g.
+//
+//     SIRview --serve [name]
+//
+// Listens on a local socket (named pipe on Windows) for batched solve requests framed
+// as described in solveprotocol.h. Requests of each connection are answered in order,
+// while different connections are solved concurrently on the global thread pool
+// The same SolveService, and thus its solution cache, is shared by all connections
+
+class LocalSolveServer: public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit LocalSolveServer(QObject *parent = nullptr);
+
+    bool listen(QString name);
+    QString getServerName() const;
+    QString errorString() const;
+
+    static QString defaultName();
+
+private:
+    struct Connection
+    {
+        QByteArray buffer;
+        bool busy = false;
+    };
+
+    QLocalServer *server;
+    SolveService service;
+
+    QHash<QLocalSocket*, Connection> connections;
+
+    void acceptConnections();
+    void dispatch(QLocalSocket *socket);
+};
+
+bool isServiceInvocation(int argc, char *argv[]);
+int runSolveService(int argc, char *argv[]);
+
+#endif // LOCALSOLVESERVER_H
@@ -0,0 +1,75 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "mainwidget.h"
+#include "headless.h"
+#include "localsolveserver.h"
+
+#include <QApplication>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <cstdio>
+#include <io.h>
+#endif
+
+// On Windows the application has no console of its own, so the command line modes write
+// to the console they were started from, unless their streams were redirected
+
+static void attachParentConsole()
+{
+#ifdef _WIN32
+    if (AttachConsole(ATTACH_PARENT_PROCESS))
+    {
+        FILE *stream;
+
+        if (_fileno(stdout) < 0)
+            freopen_s(&stream, "CONOUT$", "w", stdout);
+
+        if (_fileno(stderr) < 0)
+            freopen_s(&stream, "CONOUT$", "w", stderr);
+    }
+#endif
+}
+
+int main(int argc, char *argv[])
+{
+    // Command line solver and solve service, without constructing any widget
+
+    if (isHeadlessInvocation(argc, argv))
+    {
+        attachParentConsole();
+        return runHeadless(argc, argv);
+    }
+
+    if (isServiceInvocation(argc, argv))
+    {
+        attachParentConsole();
+        return runSolveService(argc, argv);
+    }
+
+    QApplication a(argc, argv);
+    a.setApplicationName("SIRview");
+
+    // Optional session file, otherwise the default one is used
+
+    QString sessionFileName = argc > 1 ? QString::fromLocal8Bit(argv[1]) : QString();
+
+    MainWidget w(sessionFileName);
+    w.show();
+    return a.exec();
+}
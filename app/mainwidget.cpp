@@ -0,0 +1,203 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "mainwidget.h"
+
+MainWidget::MainWidget(QString sessionName, QWidget *parent): QWidget(parent)
+{
+    // About
+
+    QString aboutString;
+    aboutString.append("SIRview - Solve and visualize SIR epidemiological models.\n\n");
+    aboutString.append("Authors: J. M. Castelo & J. A. Oteo (Universidad de Valencia)\n");
+    aboutString.append("Code by J. M. Castelo\n\n");
+    aboutString.append("Contact email: jose.maria.castelo@gmail.com\n\n");
+    aboutString.append("Copyright 2021 Jose Maria Castelo & Jose Angel Oteo\n");
+    aboutString.append("Released under GPLv3 license.");
+
+    QLabel *aboutLabel = new QLabel;
+    aboutLabel->setFrameStyle(QFrame::Panel | QFrame::Sunken);
+    aboutLabel->setText(aboutString);
+
+    QFont aboutFont = aboutLabel->font();
+    aboutFont.setPointSize(21);
+    aboutLabel->setFont(aboutFont);
+
+    QVBoxLayout *aboutVBoxLayout = new QVBoxLayout;
+    aboutVBoxLayout->addWidget(aboutLabel);
+    aboutVBoxLayout->setAlignment(aboutLabel, Qt::AlignHCenter | Qt::AlignVCenter);
+
+    QWidget *aboutWidget = new QWidget;
+    aboutWidget->setLayout(aboutVBoxLayout);
+
+    // Model widgets, restored from the last session if any
+
+    sessionFileName = sessionName.isEmpty() ? defaultSessionFileName() : sessionName;
+
+    SessionState session;
+    bool sessionLoaded = QFile::exists(sessionFileName) && loadSession(sessionFileName, session);
+
+    scenarioWidget = new ScenarioWidget(sessionLoaded ? &session : nullptr);
+    phaseSpaceWidget = new PhaseSpaceWidget(sessionLoaded ? &session : nullptr);
+
+    mainTabWidget = new QTabWidget;
+    mainTabWidget->setTabPosition(QTabWidget::North);
+    mainTabWidget->addTab(scenarioWidget, "Scenario editing");
+    mainTabWidget->addTab(phaseSpaceWidget, "Phase-space diagram");
+    mainTabWidget->addTab(aboutWidget, "About");
+
+    // Batch export of all plots
+
+    imgWidth = 800;
+    imgHeight = 600;
+
+    QPushButton *batchExportButton = new QPushButton("Export all plots");
+    mainTabWidget->setCornerWidget(batchExportButton, Qt::TopRightCorner);
+
+    connect(batchExportButton, &QPushButton::clicked, this, &MainWidget::batchExport);
+
+    QVBoxLayout *mainVBoxLayout = new QVBoxLayout;
+    mainVBoxLayout->addWidget(mainTabWidget);
+
+    setLayout(mainVBoxLayout);
+
+    setWindowTitle("SIRview");
+    resize(1200, 800);
+}
+
+MainWidget::~MainWidget()
+{
+
+}
+
+void MainWidget::closeEvent(QCloseEvent *event)
+{
+    // Autosave session
+
+    SessionState session;
+
+    scenarioWidget->getSessionState(session);
+    phaseSpaceWidget->getSessionState(session);
+
+    saveSession(sessionFileName, session);
+
+    QWidget::closeEvent(event);
+}
+
+void MainWidget::batchExport()
+{
+    QLabel *widthLabel = new QLabel("Width (px)");
+
+    QSpinBox *widthSpinBox = new QSpinBox;
+    widthSpinBox->setRange(1, 16384);
+    widthSpinBox->setValue(imgWidth);
+
+    QLabel *heightLabel = new QLabel("Height (px)");
+
+    QSpinBox *heightSpinBox = new QSpinBox;
+    heightSpinBox->setRange(1, 16384);
+    heightSpinBox->setValue(imgHeight);
+
+    QLabel *formatLabel = new QLabel("Format");
+
+    QComboBox *formatComboBox = new QComboBox;
+    formatComboBox->addItem("png");
+    formatComboBox->addItem("jpg");
+    formatComboBox->addItem("pdf");
+
+    QPushButton *acceptButton = new QPushButton("Accept");
+
+    QVBoxLayout *dialogVBoxLayout = new QVBoxLayout;
+    dialogVBoxLayout->addWidget(widthLabel);
+    dialogVBoxLayout->addWidget(widthSpinBox);
+    dialogVBoxLayout->addWidget(heightLabel);
+    dialogVBoxLayout->addWidget(heightSpinBox);
+    dialogVBoxLayout->addWidget(formatLabel);
+    dialogVBoxLayout->addWidget(formatComboBox);
+    dialogVBoxLayout->addWidget(acceptButton);
+
+    QDialog *exportDialog = new QDialog(this);
+    exportDialog->setLayout(dialogVBoxLayout);
+
+    connect(acceptButton, &QPushButton::clicked, exportDialog, &QDialog::accept);
+
+    if (exportDialog->exec() != QDialog::Accepted)
+    {
+        delete exportDialog;
+        return;
+    }
+
+    imgWidth = widthSpinBox->value();
+    imgHeight = heightSpinBox->value();
+
+    QString format = formatComboBox->currentText();
+
+    delete exportDialog;
+
+    QString directory = QFileDialog::getExistingDirectory(this, "Export all plots");
+
+    if (directory.isEmpty()) return;
+
+    // Plots are recorded on the GUI thread, then written on worker threads while a progress dialog is shown
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+
+    BatchExporter exporter(directory, imgWidth, imgHeight, format);
+
+    QStringList failedSnapshots = scenarioWidget->addPlotsToExporter(exporter);
+    phaseSpaceWidget->addPlotsToExporter(exporter);
+
+    QApplication::restoreOverrideCursor();
+
+    QProgressDialog progressDialog("Writing plots", QString(), 0, exporter.numPlots(), this);
+    progressDialog.setWindowTitle("Export all plots");
+    progressDialog.setWindowModality(Qt::WindowModal);
+    progressDialog.setMinimumDuration(500);
+
+    QEventLoop loop;
+    QTimer timer;
+
+    connect(&timer, &QTimer::timeout, &loop, [&](){
+        int numFinished = exporter.numFinished();
+        progressDialog.setValue(numFinished);
+
+        if (numFinished == exporter.numPlots()) loop.quit();
+    });
+
+    if (exporter.numFinished() < exporter.numPlots())
+    {
+        timer.start(50);
+        loop.exec();
+        timer.stop();
+    }
+
+    progressDialog.reset();
+
+    int numFiles = exporter.waitForFinished();
+
+    QString message = QString("%1 plots exported to %2").arg(numFiles).arg(directory);
+
+    if (failedSnapshots.isEmpty())
+    {
+        QMessageBox::information(this, "Export all plots", message);
+    }
+    else
+    {
+        message += "\n\nThe trajectories of these snapshots could not be read back, so their plots were not exported:\n" + failedSnapshots.join("\n");
+        QMessageBox::warning(this, "Export all plots", message);
+    }
+}
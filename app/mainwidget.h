@@ -20,26 +20,50 @@
 
 #include "scenariowidget.h"
 #include "phasespacewidget.h"
+#include "batchexporter.h"
+#include "session.h"
 #include <QWidget>
 #include <QTabWidget>
 #include <QString>
 #include <QLabel>
 #include <QFont>
 #include <QVBoxLayout>
+#include <QPushButton>
+#include <QDialog>
+#include <QSpinBox>
+#include <QComboBox>
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QApplication>
+#include <QCloseEvent>
+#include <QFile>
+#include <QProgressDialog>
+#include <QEventLoop>
+#include <QTimer>
 
 class MainWidget: public QWidget
 {
     Q_OBJECT
 
 public:
-    explicit MainWidget(QWidget *parent = nullptr);
+    explicit MainWidget(QString sessionName = QString(), QWidget *parent = nullptr);
     ~MainWidget();
 
+protected:
+    void closeEvent(QCloseEvent *event) override;
+
 private:
+    QString sessionFileName;
+
     ScenarioWidget *scenarioWidget;
     PhaseSpaceWidget *phaseSpaceWidget;
 
     QTabWidget *mainTabWidget;
+
+    int imgWidth;
+    int imgHeight;
+
+    void batchExport();
 };
 
 #endif // MAINWIDGET_H
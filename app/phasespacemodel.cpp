@@ -16,6 +16,10 @@
 // along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
 
 #include "phasespacemodel.h"
+#include "phasespaceexportjob.h"
+#include "computepool.h"
+#include "jobprogressdialog.h"
+#include <algorithm>
 
 PhaseSpaceModel::PhaseSpaceModel(
     int index,
@@ -62,7 +66,9 @@ PhaseSpaceModel::PhaseSpaceModel(
     plot->setContextMenuPolicy(Qt::CustomContextMenu);
     connect(plot, &QCustomPlot::customContextMenuRequested, this, &PhaseSpaceModel::contextMenuRequest);
 
-    updateInitialConditions(icGridDimension);
+    // Trajectories are integrated or restored from a session by the widget
+
+    setInitialConditionsGrid(icGridDimension);
 }
 
 PhaseSpaceModel::~PhaseSpaceModel()
@@ -95,6 +101,15 @@ void PhaseSpaceModel::updateParameter(int k, double value)
 }
 
 void PhaseSpaceModel::updateInitialConditions(int dim)
+{
+    setInitialConditionsGrid(dim);
+
+    integrate();
+    updateCurves();
+    setCurvesData();
+}
+
+void PhaseSpaceModel::setInitialConditionsGrid(int dim)
 {
     icGridDimension = dim;
 
@@ -142,8 +157,59 @@ void PhaseSpaceModel::updateInitialConditions(int dim)
             initialConditions.push_back(x0);
         }
     }
+}
+
+PhaseSpaceModelState PhaseSpaceModel::getSessionState() const
+{
+    PhaseSpaceModelState state;
+    state.modelIndex = modelIndex;
+    state.parameter = parameter;
+    state.icGridDimension = icGridDimension;
+    state.xAxis = xAxis;
+    state.yAxis = yAxis;
+    state.timeEnd = timeEnd;
+
+    for (size_t i = 0; i < steps.size(); i++)
+    {
+        std::shared_ptr<Trajectory> trajectory = std::make_shared<Trajectory>();
+        trajectory->steps = steps[i];
+        trajectory->times.assign(times[i].begin(), times[i].end());
+        state.trajectories.push_back(trajectory);
+    }
+
+    return state;
+}
+
+void PhaseSpaceModel::restoreSession(const PhaseSpaceModelState &state)
+{
+    parameter = state.parameter;
+    xAxis = state.xAxis;
+    yAxis = state.yAxis;
+    timeEnd = state.timeEnd;
+
+    plot->xAxis->setLabel(variableLongNames[xAxis]->text() + " fraction");
+    plot->yAxis->setLabel(variableLongNames[yAxis]->text() + " fraction");
+
+    setInitialConditionsGrid(state.icGridDimension);
+
+    // Trajectories from the session, if they match the grid
+
+    if (state.trajectories.size() == initialConditions.size())
+    {
+        steps.clear();
+        times.clear();
+
+        for (size_t i = 0; i < state.trajectories.size(); i++)
+        {
+            steps.push_back(state.trajectories[i]->steps);
+            times.push_back(QVector<double>(state.trajectories[i]->times.begin(), state.trajectories[i]->times.end()));
+        }
+    }
+    else
+    {
+        integrate();
+    }
 
-    integrate();
     updateCurves();
     setCurvesData();
 }
@@ -172,40 +238,59 @@ void PhaseSpaceModel::setYAxis(int yIndex)
 
 void PhaseSpaceModel::integrate()
 {
-    using namespace boost::numeric::odeint;
+    integrateTrajectories(modelIndex, parameter, initialConditions, timeEnd, steps, times);
+}
+
+void PhaseSpaceModel::exportTrajectories()
+{
+    QString binaryFilter = tr("Binary phase space files (*.sirp)");
+
+    QString fileName = QFileDialog::getSaveFileName(this, tr("Export trajectories"), "", tr("Data files (*.dat *.txt)") + ";;" + binaryFilter);
+
+    if (fileName.isEmpty()) return;
 
-    typedef runge_kutta_dopri5<state_type> error_stepper_type;
+    PhaseSpaceSource source;
+    source.modelName = name;
+    source.modelIndex = modelIndex;
+    source.dimension = dimension;
 
+    for (int i = 0; i < dimension; i++)
+        source.variableShortNames.push_back(variableShortNames[i]->text());
+
+    for (int i = 0; i < numParameters; i++)
+        source.parameterNames.push_back(parameterNames[i]->text());
+
+    source.parameter = parameter;
+    source.initialConditions = initialConditions;
+    source.timeEnd = timeEnd;
+
+    PhaseSpaceExportJob *job = new PhaseSpaceExportJob(source, fileName, fileName.endsWith(".sirp", Qt::CaseInsensitive));
+
+    jobProgressDialog(job, QString("Exporting %1").arg(QFileInfo(fileName).fileName()), this);
+
+    connect(job, &PhaseSpaceExportJob::finished, this, [=](bool success, bool canceled){
+        job->deleteLater();
+
+        if (!success && !canceled)
+        {
+            QMessageBox::warning(this, tr("Export trajectories"), tr("The trajectories could not be exported to %1.").arg(fileName));
+        }
+    });
+
+    startComputeJob(job);
+}
+
+void PhaseSpaceModel::integrateTrajectories(int modelIndex, const std::vector<double> &parameter, const std::vector<state_type> &initialConditions, double timeEnd, std::vector<std::vector<state_type>> &steps, std::vector<QVector<double>> &times)
+{
     steps.clear();
     times.clear();
 
     for (size_t i = 0; i < initialConditions.size(); i++)
     {
-        state_type x = initialConditions[i];
-
         std::vector<state_type> stepsVector;
         std::vector<double> timesVector;
 
-        if (modelIndex == 0) // SIR model
-        {
-            SIR sir(parameter);
-            integrate_adaptive(make_controlled<error_stepper_type>(1.0e-10, 1.0e-6), sir, x, 0.0, timeEnd, 0.01, push_back_state_and_time(stepsVector, timesVector));
-        }
-        else if (modelIndex == 1) // SIRS model
-        {
-            SIRS sirs(parameter);
-            integrate_adaptive(make_controlled<error_stepper_type>(1.0e-10, 1.0e-6), sirs, x, 0.0, timeEnd, 0.01, push_back_state_and_time(stepsVector, timesVector));
-        }
-        else if (modelIndex == 2) // SIR + Vital dynamics model
-        {
-            SIRVitalDynamics sirVitalDynamics(parameter);
-            integrate_adaptive(make_controlled<error_stepper_type>(1.0e-10, 1.0e-6), sirVitalDynamics, x, 0.0, timeEnd, 0.01, push_back_state_and_time(stepsVector, timesVector));
-        }
-        else if (modelIndex == 3) // SIRS + Vital dynamics model
-        {
-            SIRSVitalDynamics sirsVitalDynamics(parameter);
-            integrate_adaptive(make_controlled<error_stepper_type>(1.0e-10, 1.0e-6), sirsVitalDynamics, x, 0.0, timeEnd, 0.01, push_back_state_and_time(stepsVector, timesVector));
-        }
+        integratePhaseSpaceTrajectory(modelIndex, parameter, initialConditions[i], timeEnd, push_back_state_and_time(stepsVector, timesVector));
 
         steps.push_back(stepsVector);
         times.push_back(QVector<double>(timesVector.begin(), timesVector.end()));
@@ -245,6 +330,49 @@ void PhaseSpaceModel::setCurvesData()
     plot->replot();
 }
 
+bool PhaseSpaceModel::exportAnimation(AnimationExporter &exporter, QString fileName, int parameterIndex, double parameterStart, double parameterEnd)
+{
+    // Copies, since frames are drawn on worker threads
+
+    int index = modelIndex;
+    int xIndex = xAxis;
+    int yIndex = yAxis;
+    int numFrames = exporter.getNumFrames();
+    double time = timeEnd;
+    std::vector<double> p0 = parameter;
+    std::vector<state_type> x0 = initialConditions;
+    QString parameterName = parameterNames[parameterIndex]->text();
+    QString xLabel = plot->xAxis->label();
+    QString yLabel = plot->yAxis->label();
+
+    return exporter.exportFrames(fileName, [=, &exporter](int frameIndex, QPainter &painter){
+        std::vector<double> p = p0;
+        p[parameterIndex] = parameterStart + (parameterEnd - parameterStart) * frameIndex / std::max(numFrames - 1, 1);
+
+        std::vector<std::vector<state_type>> frameSteps;
+        std::vector<QVector<double>> frameTimes;
+
+        integrateTrajectories(index, p, x0, time, frameSteps, frameTimes);
+
+        exporter.drawAxes(painter, 0.0, 1.0, 0.0, 1.0, xLabel, yLabel);
+        exporter.drawTitle(painter, QString("%1 = %2").arg(parameterName).arg(p[parameterIndex], 0, 'g', 4));
+
+        painter.setPen(QPen(Qt::black, 1.0));
+
+        for (size_t i = 0; i < frameSteps.size(); i++)
+        {
+            QPolygonF line;
+
+            for (size_t j = 0; j < frameSteps[i].size(); j++)
+            {
+                line << exporter.mapToArea(frameSteps[i][j][xIndex], frameSteps[i][j][yIndex], 0.0, 1.0, 0.0, 1.0);
+            }
+
+            painter.drawPolyline(line);
+        }
+    });
+}
+
 void PhaseSpaceModel::contextMenuRequest(QPoint pos)
 {
     QMenu *menu = new QMenu(this);
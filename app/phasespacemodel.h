@@ -19,11 +19,10 @@
 #define PHASESPACEMODEL_H
 
 #include "basemodel.h"
-#include "models.h"
+#include "phasespaceintegrator.h"
+#include "animationexporter.h"
+#include "session.h"
 #include "qcustomplot.h"
-#ifndef Q_MOC_RUN
-#include <boost/numeric/odeint.hpp>
-#endif
 #include <list>
 #include <vector>
 #include <QVector>
@@ -35,6 +34,9 @@
 #include <QDialog>
 #include <QString>
 #include <QFileDialog>
+#include <QFileInfo>
+#include <QProgressDialog>
+#include <QMessageBox>
 
 typedef std::vector<double> state_type;
 
@@ -72,11 +74,20 @@ public:
     void updateParameter(int parameterIndex, double value);
 
     void updateInitialConditions(int dim);
+
+    PhaseSpaceModelState getSessionState() const;
+    void restoreSession(const PhaseSpaceModelState &state);
     void updateTimeEnd(double time);
 
     void setXAxis(int xIndex);
     void setYAxis(int yIndex);
 
+    bool exportAnimation(AnimationExporter &exporter, QString fileName, int parameterIndex, double parameterStart, double parameterEnd);
+
+    void exportTrajectories();
+
+    static void integrateTrajectories(int modelIndex, const std::vector<double> &parameter, const std::vector<state_type> &initialConditions, double timeEnd, std::vector<std::vector<state_type>> &steps, std::vector<QVector<double>> &times);
+
 private:
     std::vector<double> parameterInit;
 
@@ -89,6 +100,7 @@ private:
     int imgWidth;
     int imgHeight;
 
+    void setInitialConditionsGrid(int dim);
     void integrate();
     void updateCurves();
     void setCurvesData();
@@ -17,7 +17,7 @@
 
 #include "phasespacewidget.h"
 
-PhaseSpaceWidget::PhaseSpaceWidget(QWidget *parent) : QWidget(parent)
+PhaseSpaceWidget::PhaseSpaceWidget(const SessionState *session, QWidget *parent) : QWidget(parent)
 {
     // Models
 
@@ -26,7 +26,26 @@ PhaseSpaceWidget::PhaseSpaceWidget(QWidget *parent) : QWidget(parent)
     models.push_back(new PhaseSpaceModel(2, "SIR + Vital dynamics", {"S", "I", "R"}, {"Susceptible", "Infected", "Recovered"}, {"P0", "P1"}, {0.0, 0.0}, {20.0, 5.0}, {2.5, 0.1}));
     models.push_back(new PhaseSpaceModel(3, "SIRS + Vital dynamics", {"S", "I", "R"}, {"Susceptible", "Infected", "Recovered"}, {"P0", "P1", "P3"}, {0.0, 0.0, 0.0}, {20.0, 5.0, 5.0}, {2.5, 0.1, 0.1}));
 
-    currentModel = models[0];
+    // Trajectories restored from the session or integrated
+
+    bool restored = session != nullptr && sessionMatches(*session);
+
+    for (size_t i = 0; i < models.size(); i++)
+    {
+        if (restored)
+            models[i]->restoreSession(session->phaseSpaceModels[i]);
+        else
+            models[i]->updateInitialConditions(models[i]->icGridDimension);
+    }
+
+    int modelIndex = restored ? session->phaseSpaceModelIndex : 0;
+
+    currentModel = models[modelIndex];
+
+    animationWidth = 800;
+    animationHeight = 800;
+    animationFrames = 120;
+    animationFps = 30;
 
     // Model selection controls
 
@@ -75,6 +94,11 @@ PhaseSpaceWidget::PhaseSpaceWidget(QWidget *parent) : QWidget(parent)
 
     parameterVBoxLayout = new QVBoxLayout;
 
+    // Trajectories and animation export
+
+    QPushButton *exportTrajectoriesPushButton = new QPushButton("Export trajectories");
+    QPushButton *exportAnimationPushButton = new QPushButton("Export animation");
+
     // Main controls vertical layout
 
     QVBoxLayout *mainControlsVBoxLayout = new QVBoxLayout;
@@ -90,6 +114,8 @@ PhaseSpaceWidget::PhaseSpaceWidget(QWidget *parent) : QWidget(parent)
     mainControlsVBoxLayout->addWidget(timeEndLineEdit);
     mainControlsVBoxLayout->addWidget(parameterLabel);
     mainControlsVBoxLayout->addLayout(parameterVBoxLayout);
+    mainControlsVBoxLayout->addWidget(exportTrajectoriesPushButton);
+    mainControlsVBoxLayout->addWidget(exportAnimationPushButton);
 
     // Plots stacked layout
 
@@ -125,10 +151,13 @@ PhaseSpaceWidget::PhaseSpaceWidget(QWidget *parent) : QWidget(parent)
     connect(yAxisComboBox, QOverload<int>::of(&QComboBox::activated), [=](int variableIndex){ if (variableIndex >= 0) currentModel->setYAxis(variableIndex); });
     connect(icGridDimensionLineEdit, &QLineEdit::returnPressed, [this](){ currentModel->updateInitialConditions(icGridDimensionLineEdit->text().toInt()); });
     connect(timeEndLineEdit, &QLineEdit::returnPressed, [this](){ currentModel->updateTimeEnd(timeEndLineEdit->text().toDouble()); });
+    connect(exportTrajectoriesPushButton, &QPushButton::clicked, [=](){ currentModel->exportTrajectories(); });
+    connect(exportAnimationPushButton, &QPushButton::clicked, this, &PhaseSpaceWidget::exportAnimation);
 
     // Init
 
-    modelComboBox->setCurrentIndex(0);
+    modelComboBox->setCurrentIndex(modelIndex);
+    plotsStackedLayout->setCurrentIndex(modelIndex);
     initAxesComboBoxes();
     updateControls();
     constructParameterControls();
@@ -145,6 +174,141 @@ PhaseSpaceWidget::~PhaseSpaceWidget()
     models.clear();
 }
 
+void PhaseSpaceWidget::addPlotsToExporter(BatchExporter &exporter)
+{
+    for (size_t i = 0; i < models.size(); i++)
+    {
+        exporter.addPlot(models[i]->plot, models[i]->name + " Phase space");
+    }
+}
+
+bool PhaseSpaceWidget::sessionMatches(const SessionState &state) const
+{
+    if (state.phaseSpaceModels.size() != models.size() || state.phaseSpaceModelIndex < 0 || state.phaseSpaceModelIndex >= static_cast<int>(models.size()))
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < models.size(); i++)
+    {
+        const PhaseSpaceModelState &modelState = state.phaseSpaceModels[i];
+        const PhaseSpaceModel *model = models[i];
+
+        if (modelState.modelIndex != model->modelIndex || static_cast<int>(modelState.parameter.size()) != model->numParameters)
+        {
+            return false;
+        }
+
+        if (modelState.xAxis < 0 || modelState.xAxis >= model->dimension || modelState.yAxis < 0 || modelState.yAxis >= model->dimension || modelState.xAxis == modelState.yAxis)
+        {
+            return false;
+        }
+
+        if (modelState.icGridDimension < 1 || modelState.icGridDimension > 1000)
+        {
+            return false;
+        }
+
+        for (const std::shared_ptr<const Trajectory> &trajectory : modelState.trajectories)
+        {
+            if (trajectory->steps.empty() || static_cast<int>(trajectory->steps.front().size()) != model->dimension)
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+void PhaseSpaceWidget::getSessionState(SessionState &state) const
+{
+    state.phaseSpaceModelIndex = modelComboBox->currentIndex();
+    state.phaseSpaceModels.clear();
+
+    for (size_t i = 0; i < models.size(); i++)
+    {
+        state.phaseSpaceModels.push_back(models[i]->getSessionState());
+    }
+}
+
+void PhaseSpaceWidget::exportAnimation()
+{
+    // Sweep of the selected parameter over the frames
+
+    QLabel *parameterLabel = new QLabel("Parameter");
+
+    QComboBox *parameterComboBox = new QComboBox;
+
+    for (int i = 0; i < currentModel->numParameters; i++)
+    {
+        parameterComboBox->addItem(currentModel->parameterNames[i]->text());
+    }
+
+    QLabel *parameterStartLabel = new QLabel("Parameter start");
+
+    QLineEdit *parameterStartLineEdit = new QLineEdit;
+
+    QLabel *parameterEndLabel = new QLabel("Parameter end");
+
+    QLineEdit *parameterEndLineEdit = new QLineEdit;
+
+    auto setParameterRange = [=](int index)
+    {
+        parameterStartLineEdit->setValidator(new CustomValidator(currentModel->parameterMin[index], currentModel->parameterMax[index], 10, parameterStartLineEdit));
+        parameterEndLineEdit->setValidator(new CustomValidator(currentModel->parameterMin[index], currentModel->parameterMax[index], 10, parameterEndLineEdit));
+        parameterStartLineEdit->setText(QString::number(currentModel->parameterMin[index]));
+        parameterEndLineEdit->setText(QString::number(currentModel->parameterMax[index]));
+    };
+
+    setParameterRange(0);
+
+    connect(parameterComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged), [=](int index){ if (index >= 0) setParameterRange(index); });
+
+    QVBoxLayout *sweepVBoxLayout = new QVBoxLayout;
+    sweepVBoxLayout->addWidget(parameterLabel);
+    sweepVBoxLayout->addWidget(parameterComboBox);
+    sweepVBoxLayout->addWidget(parameterStartLabel);
+    sweepVBoxLayout->addWidget(parameterStartLineEdit);
+    sweepVBoxLayout->addWidget(parameterEndLabel);
+    sweepVBoxLayout->addWidget(parameterEndLineEdit);
+
+    int parameterIndex = 0;
+    double parameterStart = 0.0, parameterEnd = 0.0;
+
+    auto readSweep = [&]()
+    {
+        parameterIndex = parameterComboBox->currentIndex();
+        parameterStart = parameterStartLineEdit->text().toDouble();
+        parameterEnd = parameterEndLineEdit->text().toDouble();
+    };
+
+    if (!AnimationExporter::settingsDialog(this, animationWidth, animationHeight, animationFrames, animationFps, sweepVBoxLayout, readSweep))
+    {
+        return;
+    }
+
+    QString fileName = AnimationExporter::fileDialog(this);
+
+    if (fileName.isEmpty())
+    {
+        return;
+    }
+
+    AnimationExporter exporter(animationWidth, animationHeight, animationFrames, animationFps);
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+
+    bool success = currentModel->exportAnimation(exporter, fileName, parameterIndex, parameterStart, parameterEnd);
+
+    QApplication::restoreOverrideCursor();
+
+    if (!success)
+    {
+        QMessageBox::warning(this, "Export animation", "The animation could not be exported.");
+    }
+}
+
 void PhaseSpaceWidget::initAxesComboBoxes()
 {
     xAxisComboBox->clear();
@@ -20,6 +20,8 @@
 
 #include "phasespacemodel.h"
 #include "customvalidator.h"
+#include "batchexporter.h"
+#include "session.h"
 #include <vector>
 #include <QWidget>
 #include <QLabel>
@@ -33,21 +35,32 @@
 #include <QStandardItem>
 #include <QGridLayout>
 #include <QStackedLayout>
+#include <QPushButton>
+#include <QApplication>
+#include <QMessageBox>
 
 class PhaseSpaceWidget : public QWidget
 {
     Q_OBJECT
 
 public:
-    explicit PhaseSpaceWidget(QWidget *parent = nullptr);
+    explicit PhaseSpaceWidget(const SessionState *session = nullptr, QWidget *parent = nullptr);
     ~PhaseSpaceWidget();
 
+    void addPlotsToExporter(BatchExporter &exporter);
+    void getSessionState(SessionState &state) const;
+
 private:
     PhaseSpaceModel *currentModel;
     std::vector<PhaseSpaceModel*> models;
 
     QComboBox *modelComboBox;
 
+    int animationWidth;
+    int animationHeight;
+    int animationFrames;
+    int animationFps;
+
     QComboBox *xAxisComboBox;
     QComboBox *yAxisComboBox;
 
@@ -61,6 +74,10 @@ private:
 
     QStackedLayout *plotsStackedLayout;
 
+    bool sessionMatches(const SessionState &state) const;
+
+    void exportAnimation();
+
     void initAxesComboBoxes();
     void updateAxisComboBox(QComboBox *axisComboBox, int variableIndex);
 
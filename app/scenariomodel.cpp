@@ -0,0 +1,2095 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "scenariomodel.h"
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <QScrollArea>
+
+ScenarioModel::ScenarioModel(
+    int index,
+    QString modelName,
+    std::list<QString> variableShortNamesList,
+    std::list<QString> variableLongNamesList,
+    std::list<QString> parameterNamesList,
+    std::list<double> parameterMinList,
+    std::list<double> parameterMaxList,
+    std::list<double> parameterInitList,
+    std::list<double> initialConditionsList,
+    QWidget *parent): QWidget(parent), BaseModel(index, modelName, variableShortNamesList, variableLongNamesList, parameterNamesList, parameterMinList, parameterMaxList)
+{
+    imgWidth = 800;
+    imgHeight = 600;
+
+    animationFrames = 240;
+    animationFps = 30;
+
+    observedTimeOffset = 0.0;
+    observedTimeScale = 1.0;
+    observedPopulation = 1.0;
+
+    currentScenarioIndex = 0;
+    currentSnapshotIndex = -1;
+
+    for (std::list<double>::iterator it = parameterInitList.begin(); it != parameterInitList.end(); ++it)
+    {
+        parameterInit.push_back(*it);
+    }
+
+    for (std::list<double>::iterator it = initialConditionsList.begin(); it != initialConditionsList.end(); ++it)
+    {
+        initialConditions.push_back(*it);
+    }
+
+    constructPlots();
+    connectPlots();
+}
+
+ScenarioModel::ScenarioModel(const ScenarioModel &model, QWidget *parent): QWidget(parent), BaseModel(model)
+{
+    parameterInit = model.parameterInit;
+
+    initialConditions = model.initialConditions;
+
+    scenarios = model.scenarios;
+    currentScenarioIndex = model.currentScenarioIndex;
+
+    observedTimeOffset = model.observedTimeOffset;
+    observedTimeScale = model.observedTimeScale;
+    observedPopulation = model.observedPopulation;
+
+    constructPlots();
+    constructGraphs();
+}
+
+ScenarioModel::~ScenarioModel()
+{
+    for (size_t i = 0; i < plots.size(); i++)
+    {
+        plots[i]->disconnect();
+        delete plots[i];
+        plots[i] = nullptr;
+    }
+
+    plots.clear();
+
+    allVariablesPlot->disconnect();
+    delete allVariablesPlot;
+    allVariablesPlot = nullptr;
+
+    delete plotsGridWidget;
+    plotsGridWidget = nullptr;
+}
+
+void ScenarioModel::constructPlots()
+{
+    for (int i = 0; i < 2 * dimension; i++)
+    {
+        plots.push_back(new QCustomPlot(this));
+
+        plots[i]->xAxis->setLabel("t/Tr");
+        plots[i]->yAxis->setLabel(variableLongNames[i % dimension]->text() + " fraction");
+
+        plots[i]->yAxis->setRange(0.0, 1.0);
+
+        plots[i]->setInteractions(QCP::iRangeZoom | QCP::iRangeDrag);
+
+        plots[i]->axisRect()->setupFullAxesBox(true);
+        plots[i]->axisRect()->setRangeZoom(Qt::Vertical | Qt::Horizontal);
+        plots[i]->axisRect()->setRangeDrag(Qt::Vertical | Qt::Horizontal);
+    }
+
+    QGridLayout *plotsGridLayout = new QGridLayout;
+
+    if (dimension == 3)
+    {
+        plotsGridLayout->addWidget(plots[0], 0, 0);
+        plotsGridLayout->addWidget(plots[2], 0, 1);
+        plotsGridLayout->addWidget(plots[1], 1, 0, -1, -1);
+    }
+    else if (dimension == 4)
+    {
+        plotsGridLayout->addWidget(plots[0], 0, 0);
+        plotsGridLayout->addWidget(plots[2], 0, 1);
+        plotsGridLayout->addWidget(plots[1], 1, 0);
+        plotsGridLayout->addWidget(plots[3], 1, 1);
+    }
+
+    plotsGridWidget = new QWidget;
+    plotsGridWidget->setLayout(plotsGridLayout);
+
+    allVariablesPlot = new QCustomPlot(this);
+
+    allVariablesPlot->xAxis->setLabel("t/Tr");
+    allVariablesPlot->yAxis->setLabel("All fractions");
+
+    allVariablesPlot->yAxis->setRange(0.0, 1.0);
+
+    allVariablesPlot->setInteractions(QCP::iRangeZoom | QCP::iRangeDrag);
+
+    allVariablesPlot->axisRect()->setupFullAxesBox(true);
+    allVariablesPlot->axisRect()->setRangeZoom(Qt::Vertical | Qt::Horizontal);
+    allVariablesPlot->axisRect()->setRangeDrag(Qt::Vertical | Qt::Horizontal);
+
+    for (int i = 0; i < dimension; i++)
+    {
+        allVariablesSlots.push_back(SeriesSlots(allVariablesPlot, false));
+    }
+}
+
+void ScenarioModel::connectPlots()
+{
+    for (size_t i = 0; i < plots.size(); i++)
+    {
+        plots[i]->setContextMenuPolicy(Qt::CustomContextMenu);
+        connect(plots[i], &QCustomPlot::customContextMenuRequested, [=](QPoint pos){ contextMenuRequest(i, pos); });
+    }
+
+    allVariablesPlot->setContextMenuPolicy(Qt::CustomContextMenu);
+    connect(allVariablesPlot, &QCustomPlot::customContextMenuRequested, [=](QPoint pos){ contextMenuRequest(-1, pos);  });
+}
+
+void ScenarioModel::contextMenuRequest(int plotIndex, QPoint pos)
+{
+    QMenu *menu = new QMenu(this);
+    menu->setAttribute(Qt::WA_DeleteOnClose);
+
+    menu->addAction("Save plot as PNG", [=](){ savePlot(plotIndex, 0, pos); });
+    menu->addAction("Save plot as JPG", [=](){ savePlot(plotIndex, 1, pos); });
+
+    if (plotIndex == -1)
+    {
+        menu->popup(allVariablesPlot->mapToGlobal(pos));
+    }
+    else
+    {
+        menu->popup(plots[plotIndex]->mapToGlobal(pos));
+    }
+}
+
+void ScenarioModel::savePlot(int plotIndex, int format, QPoint pos)
+{
+    QLabel *widthLabel = new QLabel("Width (px)");
+
+    QSpinBox *widthSpinBox = new QSpinBox;
+    widthSpinBox->setRange(1, 4096);
+    widthSpinBox->setValue(imgWidth);
+
+    QLabel *heightLabel = new QLabel("Height (px)");
+
+    QSpinBox *heightSpinBox = new QSpinBox;
+    heightSpinBox->setRange(1, 2160);
+    heightSpinBox->setValue(imgHeight);
+
+    QPushButton *defaultButton = new QPushButton("Accept");
+
+    QVBoxLayout *dialogVBoxLayout = new QVBoxLayout;
+    dialogVBoxLayout->addWidget(widthLabel);
+    dialogVBoxLayout->addWidget(widthSpinBox);
+    dialogVBoxLayout->addWidget(heightLabel);
+    dialogVBoxLayout->addWidget(heightSpinBox);
+    dialogVBoxLayout->addWidget(defaultButton);
+
+    QDialog *sizeDialog = new QDialog(this);
+    sizeDialog->setAttribute(Qt::WA_DeleteOnClose);
+    sizeDialog->setLayout(dialogVBoxLayout);
+
+    connect(widthSpinBox, QOverload<int>::of(&QSpinBox::valueChanged), [&](int value) { imgWidth = value; });
+    connect(heightSpinBox, QOverload<int>::of(&QSpinBox::valueChanged), [&](int value) { imgHeight = value; });
+    connect(defaultButton, &QPushButton::clicked, [&](){
+        widthSpinBox->disconnect();
+        heightSpinBox->disconnect();
+        sizeDialog->done(1);
+    });
+
+    if (plotIndex == -1)
+    {
+        sizeDialog->move(allVariablesPlot->mapToGlobal(pos));
+    }
+    else
+    {
+        sizeDialog->move(plots[plotIndex]->mapToGlobal(pos));
+    }
+
+    sizeDialog->exec();
+
+    if (format == 0)
+    {
+        QString fileName = QFileDialog::getSaveFileName(this, "Save plot", "", tr("Images (*.png)"));
+
+        if (plotIndex == -1)
+        {
+            if (!fileName.isEmpty()) allVariablesPlot->savePng(fileName, imgWidth, imgHeight);
+        }
+        else
+        {
+            if (!fileName.isEmpty()) plots[plotIndex]->savePng(fileName, imgWidth, imgHeight);
+        }
+    }
+    else if (format == 1)
+    {
+        QString fileName = QFileDialog::getSaveFileName(this, "Save plot", "", tr("Images (*.jpg)"));
+
+        if (plotIndex == -1)
+        {
+            if (!fileName.isEmpty()) allVariablesPlot->saveJpg(fileName, imgWidth, imgHeight);
+        }
+        else
+        {
+            if (!fileName.isEmpty()) plots[plotIndex]->saveJpg(fileName, imgWidth, imgHeight);
+        }
+    }
+}
+
+void ScenarioModel::constructGraphs()
+{
+    resizeSlots(scenarios.size());
+    setPlotsData();
+}
+
+void ScenarioModel::resizeSlots(int numScenarios)
+{
+    // Additional plots are constructed after this class, so their slots are created on demand
+
+    while (plotSlots.size() < plots.size())
+    {
+        plotSlots.push_back(SeriesSlots(plots[plotSlots.size()], true));
+    }
+
+    // Only slots of added or removed scenarios are touched
+
+    for (size_t i = 0; i < plotSlots.size(); i++)
+    {
+        plotSlots[i].resize(numScenarios);
+    }
+
+    for (size_t i = 0; i < allVariablesSlots.size(); i++)
+    {
+        allVariablesSlots[i].resize(numScenarios);
+    }
+}
+
+void ScenarioModel::setPlotsData()
+{
+    int jmax = scenarios.size() - 1;
+
+    // Compute left and right data for scenarios until last one
+
+    for (int j = 0; j < jmax; j++)
+    {
+        scenarios[j].setAbscissaOrdinate(scenarios[j + 1].timeStart);
+    }
+
+    // Compute data for last scenario
+
+    scenarios[jmax].setAbscissaOrdinate();
+
+    // Set plots data
+
+    for (int i = 0; i < 2 * dimension; i++)
+    {
+        for (int j = 0; j < jmax; j++)
+        {
+            plotSlots[i].solid(j)->setData(scenarios[j].abscissaLeft, scenarios[j].ordinateLeft[i % dimension], true);
+            plotSlots[i].dashed(j)->setData(scenarios[j].abscissaRight, scenarios[j].ordinateRight[i % dimension], true);
+        }
+
+        plotSlots[i].solid(jmax)->setData(scenarios[jmax].abscissa, scenarios[jmax].ordinate[i % dimension], true);
+        plotSlots[i].dashed(jmax)->data()->clear();
+
+        plots[i]->xAxis->rescale();
+        plots[i]->replot();
+    }
+
+    // Set data for all variables plot
+
+    for (int i = 0; i < dimension; i++)
+    {
+        for (int j = 0; j < jmax; j++)
+        {
+            allVariablesSlots[i].solid(j)->setData(scenarios[j].abscissaLeft, scenarios[j].ordinateLeft[i], true);
+        }
+
+        allVariablesSlots[i].solid(jmax)->setData(scenarios[jmax].abscissa, scenarios[jmax].ordinate[i], true);
+    }
+
+    allVariablesPlot->xAxis->rescale();
+    allVariablesPlot->replot();
+
+    this->setAdditionalPlotsData();
+
+    setObservedPlotsData();
+}
+
+void ScenarioModel::setGraphsOnAddScenario(int scenarioIndex)
+{
+    resizeSlots(scenarioIndex + 1);
+
+    if (scenarioIndex > 0)
+    {
+        setPlotsData();
+    }
+}
+
+void ScenarioModel::setGraphsOnRemoveScenario(int scenarioIndex)
+{
+    resizeSlots(scenarioIndex);
+
+    for (size_t i = 0; i < plots.size(); i++)
+    {
+        plots[i]->xAxis->rescale();
+        plots[i]->replot();
+    }
+}
+
+void ScenarioModel::onTimeStartChanged(int scenarioIndex)
+{
+    if (scenarioIndex - 1 >= 0)
+    {
+        scenarios[scenarioIndex - 1].timeStartMax = scenarios[scenarioIndex].timeStart;
+        scenarios[scenarioIndex - 1].timeEndMin = scenarios[scenarioIndex].timeStart;
+    }
+
+    if (scenarioIndex + 1 < static_cast<int>(scenarios.size()))
+    {
+        scenarios[scenarioIndex + 1].timeStartMin = scenarios[scenarioIndex].timeStart;
+    }
+    else
+    {
+        scenarios[scenarioIndex].timeEndMin = scenarios[scenarioIndex].timeStart;
+    }
+
+}
+
+void ScenarioModel::onTimeEndChanged(int scenarioIndex)
+{
+    if (scenarioIndex + 1 < static_cast<int>(scenarios.size()))
+    {
+        scenarios[scenarioIndex + 1].timeStartMax = scenarios[scenarioIndex].timeEnd;
+    }
+
+    if (scenarioIndex == static_cast<int>(scenarios.size()) - 1)
+    {
+        scenarios[scenarioIndex].timeStartMax = scenarios[scenarioIndex].timeEnd;
+    }
+
+    if (scenarios[scenarioIndex].timeEnd >= scenarios[scenarioIndex].timeEndMax)
+    {
+        scenarios[scenarioIndex].timeEndMax += 10.0;
+    }
+}
+
+void ScenarioModel::shiftTimeRanges(int scenarioIndex, double delta)
+{
+    for (size_t i = scenarioIndex + 1; i < scenarios.size(); i++)
+    {
+        scenarios[i].timeStart += delta;
+        scenarios[i].timeStartMin += delta;
+    }
+
+    if (scenarios.size() == 1)
+    {
+        scenarios[scenarioIndex].timeStartMin += delta;
+    }
+
+    int i0 = scenarioIndex - 1 >= 0 ? scenarioIndex - 1 : 0;
+
+    for (size_t i = i0; i < scenarios.size(); i++)
+    {
+        scenarios[i].timeStartMax += delta;
+    }
+
+    for (size_t i = i0; i < scenarios.size(); i++)
+    {
+        scenarios[i].timeEnd += delta;
+        scenarios[i].timeEndMin += delta;
+        scenarios[i].timeEndMax += delta;
+    }
+}
+
+void ScenarioModel::updateTimeRangeMinMax()
+{
+    for (size_t i = 0; i < scenarios.size(); i++)
+    {
+        onTimeStartChanged(i);
+        onTimeEndChanged(i);
+    }
+}
+
+void ScenarioModel::addScenario()
+{
+    if (scenarios.empty())
+    {
+        Scenario scenario(initialConditions, parameterInit, parameterMin, parameterMax, 0.0, 0.0, 100.0, 100.0, 0.0, 110.0);
+        scenarios.push_back(scenario);
+    }
+    else
+    {
+        Scenario scenario = scenarios.back();
+        scenario.timeStartMin = scenario.timeStart;
+        scenario.timeStartMax = scenario.timeEnd;
+        scenarios.push_back(scenario);
+    }
+
+    currentScenarioIndex = scenarios.size() - 1;
+
+    setGraphsOnAddScenario(currentScenarioIndex);
+}
+
+void ScenarioModel::restoreScenarios(const std::vector<Scenario> &restoredScenarios, int scenarioIndex)
+{
+    scenarios = restoredScenarios;
+
+    for (size_t j = 0; j < scenarios.size(); j++)
+    {
+        scenarios[j].x = scenarios[j].trajectory->steps.back();
+    }
+
+    currentScenarioIndex = scenarioIndex;
+
+    resizeSlots(scenarios.size());
+    setPlotsData();
+}
+
+void ScenarioModel::removeScenario(int scenarioIndex)
+{
+    scenarios.erase(scenarios.begin() + scenarioIndex, scenarios.begin() + scenarios.size());
+    setGraphsOnRemoveScenario(scenarioIndex);
+    currentScenarioIndex = scenarios.size() - 1;
+}
+
+ExportSource ScenarioModel::getExportSource(const std::vector<Scenario> &exportedScenarios) const
+{
+    ExportSource source;
+
+    source.modelName = name;
+    source.modelIndex = modelIndex;
+    source.dimension = dimension;
+
+    for (int i = 0; i < dimension; i++)
+    {
+        source.variableShortNames.push_back(variableShortNames[i]->text());
+        source.variableLongNames.push_back(variableLongNames[i]->text());
+    }
+
+    for (int i = 0; i < numParameters; i++)
+    {
+        source.parameterNames.push_back(parameterNames[i]->text());
+    }
+
+    source.scenarios = exportedScenarios;
+
+    for (size_t j = 0; j < source.scenarios.size(); j++)
+    {
+        source.scenarios[j].clearAbscissaOrdinate();
+    }
+
+    return source;
+}
+
+void ScenarioModel::exportData(const std::vector<Scenario> &exportedScenarios)
+{
+    QString textFilter = tr("Data files (*.dat *.txt)");
+    QString fullPrecisionFilter = tr("Full precision data files (*.dat *.txt)");
+    QString selectedFilter;
+
+    QString fileName = QFileDialog::getSaveFileName(this, tr("Export scenarios"), "", textFilter + ";;" + fullPrecisionFilter + ";;" + tr("Binary columnar files (*.sirb)"), &selectedFilter);
+
+    if (fileName.isEmpty()) return;
+
+    ExportJob::Format format = ExportJob::Text;
+
+    if (fileName.endsWith(".sirb", Qt::CaseInsensitive))
+        format = ExportJob::Columnar;
+    else if (selectedFilter == fullPrecisionFilter)
+        format = ExportJob::FullPrecisionText;
+
+    ExportJob *job = new ExportJob(getExportSource(exportedScenarios), fileName, format);
+
+    jobProgressDialog(job, QString("Exporting %1").arg(QFileInfo(fileName).fileName()), this);
+
+    connect(job, &ExportJob::finished, this, [=](bool success, bool canceled){
+        job->deleteLater();
+
+        if (!success && !canceled)
+        {
+            QMessageBox::warning(this, tr("Export scenarios"), tr("The scenarios could not be exported to %1.").arg(fileName));
+        }
+    });
+
+    ExportJob::threadPool()->start(job);
+}
+
+void ScenarioModel::exportAnimation()
+{
+    if (scenarios.empty()) return;
+
+    if (!AnimationExporter::settingsDialog(this, imgWidth, imgHeight, animationFrames, animationFps)) return;
+
+    QString fileName = AnimationExporter::fileDialog(this);
+
+    if (fileName.isEmpty()) return;
+
+    std::vector<QString> variableNames;
+
+    for (int i = 0; i < dimension; i++)
+    {
+        variableNames.push_back(variableLongNames[i]->text());
+    }
+
+    AnimationExporter exporter(imgWidth, imgHeight, animationFrames, animationFps);
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+
+    bool success = exporter.exportScenarios(fileName, modelIndex, scenarios, variableNames);
+
+    QApplication::restoreOverrideCursor();
+
+    if (!success)
+    {
+        QMessageBox::warning(this, "Export animation", "The animation could not be exported.");
+    }
+}
+
+void ScenarioModel::parameterSweep()
+{
+    SweepSettings settings;
+
+    if (!sweepDialog(settings)) return;
+
+    std::string error;
+
+    if (!ParameterSweep(settings).validate(error))
+    {
+        QMessageBox::warning(this, tr("Parameter sweep"), QString::fromStdString(error));
+        return;
+    }
+
+    QString textFilter = tr("Data files (*.dat *.txt)");
+    QString selectedFilter;
+
+    QString fileName = QFileDialog::getSaveFileName(this, tr("Parameter sweep"), "", textFilter + ";;" + tr("Binary sweep files (*.sirw)"), &selectedFilter);
+
+    if (fileName.isEmpty()) return;
+
+    std::shared_ptr<ParameterSweep> sweep = std::make_shared<ParameterSweep>(settings);
+    bool binary = fileName.endsWith(".sirw", Qt::CaseInsensitive);
+
+    // Integration accounts for most of the time, writing for the rest
+
+    ComputeJob *job = new ComputeJob([=](const std::atomic<bool> &canceled, const std::function<void(double)> &progress){
+        if (!sweep->run(canceled, [&](double fraction){ progress(0.95 * fraction); }))
+            return false;
+
+        std::string nativeFileName = QFile::encodeName(fileName).toStdString();
+
+        bool success = binary ? sweep->writeBinary(nativeFileName) : sweep->writeText(nativeFileName);
+
+        progress(1.0);
+
+        return success;
+    });
+
+    jobProgressDialog(job, QString("Sweeping %1").arg(QFileInfo(fileName).fileName()), this);
+
+    connect(job, &ComputeJob::finished, this, [=](bool success, bool canceled){
+        job->deleteLater();
+
+        if (!success && !canceled)
+        {
+            QMessageBox::warning(this, tr("Parameter sweep"), tr("The sweep could not be written to %1.").arg(fileName));
+        }
+    });
+
+    startComputeJob(job);
+}
+
+bool ScenarioModel::sweepDialog(SweepSettings &settings)
+{
+    QGridLayout *axesGridLayout = new QGridLayout;
+
+    axesGridLayout->addWidget(new QLabel("Minimum"), 0, 1);
+    axesGridLayout->addWidget(new QLabel("Maximum"), 0, 2);
+    axesGridLayout->addWidget(new QLabel("Points"), 0, 3);
+
+    // Range and number of points of each parameter, within its slider range
+
+    const Scenario &scenario = scenarios[currentScenarioIndex];
+
+    std::vector<QCheckBox*> sweptCheckBoxes;
+    std::vector<QLineEdit*> minLineEdits;
+    std::vector<QLineEdit*> maxLineEdits;
+    std::vector<QSpinBox*> pointsSpinBoxes;
+
+    for (int i = 0; i < numParameters; i++)
+    {
+        QCheckBox *checkBox = new QCheckBox(parameterNames[i]->text());
+        checkBox->setChecked(i < 2);
+
+        QLineEdit *minLineEdit = new QLineEdit(QString::number(scenario.parametersMin[i]));
+        minLineEdit->setValidator(new QDoubleValidator(scenario.parametersMin[i], scenario.parametersMax[i], 10, minLineEdit));
+
+        QLineEdit *maxLineEdit = new QLineEdit(QString::number(scenario.parametersMax[i]));
+        maxLineEdit->setValidator(new QDoubleValidator(scenario.parametersMin[i], scenario.parametersMax[i], 10, maxLineEdit));
+
+        QSpinBox *pointsSpinBox = new QSpinBox;
+        pointsSpinBox->setRange(1, 1000000);
+        pointsSpinBox->setValue(100);
+
+        axesGridLayout->addWidget(checkBox, i + 1, 0);
+        axesGridLayout->addWidget(minLineEdit, i + 1, 1);
+        axesGridLayout->addWidget(maxLineEdit, i + 1, 2);
+        axesGridLayout->addWidget(pointsSpinBox, i + 1, 3);
+
+        sweptCheckBoxes.push_back(checkBox);
+        minLineEdits.push_back(minLineEdit);
+        maxLineEdits.push_back(maxLineEdit);
+        pointsSpinBoxes.push_back(pointsSpinBox);
+    }
+
+    // Each point is integrated from the initial conditions of the first scenario
+
+    QLineEdit *timeEndLineEdit = new QLineEdit(QString::number(scenarios.back().timeEnd - scenarios.front().timeStart));
+    timeEndLineEdit->setValidator(new QDoubleValidator(1.0e-6, 1.0e6, 10, timeEndLineEdit));
+
+    QLabel *numPointsLabel = new QLabel;
+
+    auto updateNumPoints = [=](){
+        double numPoints = 1.0;
+
+        for (int i = 0; i < numParameters; i++)
+        {
+            if (sweptCheckBoxes[i]->isChecked())
+                numPoints *= pointsSpinBoxes[i]->value();
+        }
+
+        numPointsLabel->setText(QString("Grid points: %1").arg(numPoints, 0, 'g', 10));
+    };
+
+    for (int i = 0; i < numParameters; i++)
+    {
+        connect(sweptCheckBoxes[i], &QCheckBox::toggled, numPointsLabel, updateNumPoints);
+        connect(pointsSpinBoxes[i], QOverload<int>::of(&QSpinBox::valueChanged), numPointsLabel, updateNumPoints);
+    }
+
+    updateNumPoints();
+
+    // Closed forms, where the model has them, instead of integrating up to time end
+
+    QCheckBox *analyticCheckBox = new QCheckBox("Analytic metrics");
+    analyticCheckBox->setEnabled(hasAnalyticPeak(modelIndex) || hasAnalyticFinalSize(modelIndex));
+    analyticCheckBox->setToolTip("Metrics as time goes to infinity, NaN where the model has no closed form");
+
+    connect(analyticCheckBox, &QCheckBox::toggled, timeEndLineEdit, &QLineEdit::setDisabled);
+
+    QPushButton *acceptButton = new QPushButton("Accept");
+
+    QVBoxLayout *dialogVBoxLayout = new QVBoxLayout;
+    dialogVBoxLayout->addLayout(axesGridLayout);
+    dialogVBoxLayout->addWidget(new QLabel("Time end"));
+    dialogVBoxLayout->addWidget(timeEndLineEdit);
+    dialogVBoxLayout->addWidget(analyticCheckBox);
+    dialogVBoxLayout->addWidget(numPointsLabel);
+    dialogVBoxLayout->addWidget(acceptButton);
+
+    QDialog dialog(this);
+    dialog.setWindowTitle(tr("Parameter sweep"));
+    dialog.setLayout(dialogVBoxLayout);
+
+    connect(acceptButton, &QPushButton::clicked, &dialog, &QDialog::accept);
+
+    if (dialog.exec() != QDialog::Accepted) return false;
+
+    // Parameters not swept keep the values of the current scenario
+
+    settings.modelIndex = modelIndex;
+    settings.parameters = scenario.parameters;
+    settings.initialConditions = scenarios.front().x0;
+    settings.timeEnd = timeEndLineEdit->text().toDouble();
+    settings.analytic = analyticCheckBox->isChecked();
+    settings.axes.clear();
+
+    for (int i = 0; i < numParameters; i++)
+    {
+        if (sweptCheckBoxes[i]->isChecked())
+        {
+            settings.axes.push_back(SweepAxis{i, minLineEdits[i]->text().toDouble(), maxLineEdits[i]->text().toDouble(), pointsSpinBoxes[i]->value()});
+        }
+    }
+
+    return true;
+}
+
+void ScenarioModel::importObservedData()
+{
+    QString fileName = QFileDialog::getOpenFileName(this, tr("Import observed data"), "", tr("Data files (*.csv *.tsv *.txt *.dat);;All files (*)"));
+
+    if (fileName.isEmpty()) return;
+
+    ObservedData data;
+    std::string error;
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+
+    bool success = loadObservedData(QFile::encodeName(fileName).toStdString(), data, error);
+
+    QApplication::restoreOverrideCursor();
+
+    if (!success)
+    {
+        QMessageBox::warning(this, tr("Import observed data"), QString::fromStdString(error));
+        return;
+    }
+
+    if (!observedDataDialog(data)) return;
+
+    // Convert to model units once, plots only resample
+
+    for (size_t i = 0; i < data.times.size(); i++)
+    {
+        data.times[i] = (data.times[i] - observedTimeOffset) / observedTimeScale;
+    }
+
+    for (size_t k = 0; k < data.columns.size(); k++)
+    {
+        for (size_t i = 0; i < data.columns[k].size(); i++)
+        {
+            data.columns[k][i] /= observedPopulation;
+        }
+    }
+
+    sortObservedData(data);
+
+    observedData = std::move(data);
+
+    // Scatter graphs on the plots of each variable, both in the grid and in their own tabs
+
+    if (observedGraphs.empty())
+    {
+        for (int i = 0; i < 2 * dimension; i++)
+        {
+            QCPGraph *graph = plots[i]->addGraph();
+            graph->setLineStyle(QCPGraph::lsNone);
+            graph->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssCircle, Qt::black, 4));
+            observedGraphs.push_back(graph);
+        }
+    }
+
+    setObservedPlotsData();
+}
+
+bool ScenarioModel::observedDataDialog(const ObservedData &data)
+{
+    QVBoxLayout *dialogVBoxLayout = new QVBoxLayout;
+
+    // Observed column of each variable
+
+    std::vector<QComboBox*> columnComboBoxes;
+
+    for (int i = 0; i < dimension; i++)
+    {
+        QComboBox *comboBox = new QComboBox;
+        comboBox->addItem("None");
+
+        for (size_t k = 0; k < data.columnNames.size(); k++)
+        {
+            comboBox->addItem(QString::fromStdString(data.columnNames[k]));
+        }
+
+        if (i < static_cast<int>(observedColumns.size()) && observedColumns[i] + 1 < comboBox->count())
+        {
+            comboBox->setCurrentIndex(observedColumns[i] + 1);
+        }
+
+        dialogVBoxLayout->addWidget(new QLabel(variableLongNames[i]->text()));
+        dialogVBoxLayout->addWidget(comboBox);
+
+        columnComboBoxes.push_back(comboBox);
+    }
+
+    // Conversion to model units
+
+    QLineEdit *timeOffsetLineEdit = new QLineEdit(QString::number(observedTimeOffset));
+    timeOffsetLineEdit->setValidator(new QDoubleValidator(timeOffsetLineEdit));
+
+    QLineEdit *timeScaleLineEdit = new QLineEdit(QString::number(observedTimeScale));
+    timeScaleLineEdit->setValidator(new QDoubleValidator(1.0e-12, 1.0e12, 12, timeScaleLineEdit));
+
+    QLineEdit *populationLineEdit = new QLineEdit(QString::number(observedPopulation));
+    populationLineEdit->setValidator(new QDoubleValidator(1.0e-12, 1.0e15, 12, populationLineEdit));
+
+    QPushButton *acceptButton = new QPushButton("Accept");
+
+    dialogVBoxLayout->addWidget(new QLabel("Time at t/Tr = 0"));
+    dialogVBoxLayout->addWidget(timeOffsetLineEdit);
+    dialogVBoxLayout->addWidget(new QLabel("Time units per Tr"));
+    dialogVBoxLayout->addWidget(timeScaleLineEdit);
+    dialogVBoxLayout->addWidget(new QLabel("Population size"));
+    dialogVBoxLayout->addWidget(populationLineEdit);
+    dialogVBoxLayout->addWidget(acceptButton);
+
+    QDialog dialog(this);
+    dialog.setWindowTitle(tr("Import observed data"));
+    dialog.setLayout(dialogVBoxLayout);
+
+    connect(acceptButton, &QPushButton::clicked, &dialog, &QDialog::accept);
+
+    if (dialog.exec() != QDialog::Accepted) return false;
+
+    observedColumns.clear();
+
+    for (int i = 0; i < dimension; i++)
+    {
+        observedColumns.push_back(columnComboBoxes[i]->currentIndex() - 1);
+    }
+
+    observedTimeOffset = timeOffsetLineEdit->text().toDouble();
+
+    if (timeScaleLineEdit->hasAcceptableInput())
+        observedTimeScale = timeScaleLineEdit->text().toDouble();
+
+    if (populationLineEdit->hasAcceptableInput())
+        observedPopulation = populationLineEdit->text().toDouble();
+
+    return true;
+}
+
+std::vector<double> ScenarioModel::modelTimes() const
+{
+    // Times of the solution shown, each scenario until the start of the next one
+
+    std::vector<double> times;
+
+    for (size_t j = 0; j < scenarios.size(); j++)
+    {
+        const std::vector<double> &scenarioTimes = scenarios[j].trajectory->times;
+
+        double timeSwitch = j + 1 < scenarios.size() ? scenarios[j + 1].timeStart : scenarios[j].timeEnd;
+
+        for (size_t i = 0; i < scenarioTimes.size() && scenarioTimes[i] <= timeSwitch; i++)
+        {
+            if (times.empty() || scenarioTimes[i] > times.back())
+                times.push_back(scenarioTimes[i]);
+        }
+    }
+
+    return times;
+}
+
+void ScenarioModel::setObservedPlotsData()
+{
+    if (observedGraphs.empty()) return;
+
+    std::vector<double> times = modelTimes();
+
+    for (int i = 0; i < dimension; i++)
+    {
+        QVector<double> keys, values;
+
+        if (i < static_cast<int>(observedColumns.size()) && observedColumns[i] >= 0)
+        {
+            std::vector<double> resampledTimes, resampledValues;
+
+            resampleObservations(observedData.times, observedData.columns[observedColumns[i]], times, resampledTimes, resampledValues);
+
+            keys = QVector<double>(resampledTimes.begin(), resampledTimes.end());
+            values = QVector<double>(resampledValues.begin(), resampledValues.end());
+        }
+
+        observedGraphs[i]->setData(keys, values, true);
+        observedGraphs[i + dimension]->setData(keys, values, true);
+
+        plots[i]->replot();
+        plots[i + dimension]->replot();
+    }
+}
+
+void ScenarioModel::fitObservedData()
+{
+    if (observedData.times.empty())
+    {
+        QMessageBox::information(this, tr("Fit to observed data"), tr("Import observed data first."));
+        return;
+    }
+
+    FitSettings settings;
+
+    if (!fitDialog(settings)) return;
+
+    std::string error;
+
+    if (!ParameterFit(settings).validate(error))
+    {
+        QMessageBox::warning(this, tr("Fit to observed data"), QString::fromStdString(error));
+        return;
+    }
+
+    std::shared_ptr<ParameterFit> fit = std::make_shared<ParameterFit>(settings);
+
+    ComputeJob *job = new ComputeJob([fit](const std::atomic<bool> &canceled, const std::function<void(double)> &progress){ return fit->run(canceled, progress); });
+
+    jobProgressDialog(job, "Fitting to observed data", this);
+
+    connect(job, &ComputeJob::finished, this, [=](bool success, bool canceled){
+        job->deleteLater();
+
+        if (canceled) return;
+
+        if (!success)
+        {
+            QMessageBox::warning(this, tr("Fit to observed data"), tr("No start converged to a valid fit."));
+            return;
+        }
+
+        const FitResult &result = fit->getResult();
+
+        // The chain may have been edited while fitting, then the fit no longer applies to it
+
+        if (chainChangedSince(settings.scenarios) || result.scenarios.size() != scenarios.size())
+        {
+            QMessageBox::warning(this, tr("Fit to observed data"), tr("The scenarios changed while fitting, the fit was discarded."));
+            return;
+        }
+
+        if (!fitResultDialog(settings, result)) return;
+
+        // Fitted parameters of every scenario and initial conditions of the first one
+
+        for (size_t i = 0; i < scenarios.size(); i++)
+        {
+            scenarios[i].parameters = result.scenarios[i].parameters;
+        }
+
+        scenarios.front().x0 = result.scenarios.front().x0;
+
+        emit scenariosFitted();
+    });
+
+    startComputeJob(job);
+}
+
+bool ScenarioModel::chainChangedSince(const std::vector<Scenario> &startScenarios) const
+{
+    // Values a background job started from, compared with the chain shown now
+
+    if (startScenarios.size() != scenarios.size())
+        return true;
+
+    for (size_t i = 0; i < scenarios.size(); i++)
+    {
+        const Scenario &start = startScenarios[i];
+        const Scenario &current = scenarios[i];
+
+        if (start.x0 != current.x0 || start.parameters != current.parameters || start.timeStart != current.timeStart || start.timeEnd != current.timeEnd)
+            return true;
+    }
+
+    return false;
+}
+
+bool ScenarioModel::fitDialog(FitSettings &settings)
+{
+    QCheckBox *initialConditionsCheckBox = new QCheckBox("Fit initial conditions");
+    initialConditionsCheckBox->setChecked(false);
+    initialConditionsCheckBox->setToolTip(QString("Initial conditions of the first scenario, with %1 taking up their changes").arg(variableShortNames[0]->text()));
+
+    // Further starts draw parameters at random within their slider ranges
+
+    QSpinBox *startsSpinBox = new QSpinBox;
+    startsSpinBox->setRange(1, ParameterFit::maxStarts);
+    startsSpinBox->setValue(16);
+
+    QSpinBox *iterationsSpinBox = new QSpinBox;
+    iterationsSpinBox->setRange(1, 10000);
+    iterationsSpinBox->setValue(100);
+
+    QLabel *variablesLabel = new QLabel;
+
+    QStringList fittedVariables;
+
+    for (int i = 0; i < dimension; i++)
+    {
+        if (i < static_cast<int>(observedColumns.size()) && observedColumns[i] >= 0)
+            fittedVariables.append(variableLongNames[i]->text());
+    }
+
+    variablesLabel->setText("Fitted variables: " + (fittedVariables.isEmpty() ? QString("none") : fittedVariables.join(", ")));
+
+    QPushButton *acceptButton = new QPushButton("Accept");
+
+    QVBoxLayout *dialogVBoxLayout = new QVBoxLayout;
+    dialogVBoxLayout->addWidget(variablesLabel);
+    dialogVBoxLayout->addWidget(initialConditionsCheckBox);
+    dialogVBoxLayout->addWidget(new QLabel("Starts"));
+    dialogVBoxLayout->addWidget(startsSpinBox);
+    dialogVBoxLayout->addWidget(new QLabel("Maximum iterations"));
+    dialogVBoxLayout->addWidget(iterationsSpinBox);
+    dialogVBoxLayout->addWidget(acceptButton);
+
+    QDialog dialog(this);
+    dialog.setWindowTitle(tr("Fit to observed data"));
+    dialog.setLayout(dialogVBoxLayout);
+
+    connect(acceptButton, &QPushButton::clicked, &dialog, &QDialog::accept);
+
+    if (dialog.exec() != QDialog::Accepted) return false;
+
+    settings.modelIndex = modelIndex;
+    settings.scenarios = scenarios;
+    settings.observedTimes = observedData.times;
+    settings.observedValues.assign(dimension, std::vector<double>());
+
+    for (int i = 0; i < dimension; i++)
+    {
+        if (i < static_cast<int>(observedColumns.size()) && observedColumns[i] >= 0)
+            settings.observedValues[i] = observedData.columns[observedColumns[i]];
+    }
+
+    settings.fitInitialConditions = initialConditionsCheckBox->isChecked();
+    settings.numStarts = startsSpinBox->value();
+    settings.maxIterations = iterationsSpinBox->value();
+
+    return true;
+}
+
+bool ScenarioModel::fitResultDialog(const FitSettings &settings, const FitResult &result)
+{
+    QGridLayout *valuesGridLayout = new QGridLayout;
+
+    valuesGridLayout->addWidget(new QLabel("Value"), 0, 1);
+    valuesGridLayout->addWidget(new QLabel("Standard error"), 0, 2);
+    valuesGridLayout->addWidget(new QLabel(QString("%1% confidence interval").arg(100.0 * ParameterFit::confidenceLevel)), 0, 3);
+
+    // Parameters, then fitted initial conditions
+
+    for (size_t k = 0; k < result.values.size(); k++)
+    {
+        QString name = k < static_cast<size_t>(numParameters) ? parameterNames[k]->text() : QString("%1(0)").arg(variableShortNames[k - numParameters + 1]->text());
+
+        valuesGridLayout->addWidget(new QLabel(name), static_cast<int>(k) + 1, 0);
+        valuesGridLayout->addWidget(new QLabel(QString::number(result.values[k], 'g', 6)), static_cast<int>(k) + 1, 1);
+        valuesGridLayout->addWidget(new QLabel(QString::number(result.standardErrors[k], 'g', 3)), static_cast<int>(k) + 1, 2);
+        valuesGridLayout->addWidget(new QLabel(QString("[%1, %2]").arg(result.lower[k], 0, 'g', 6).arg(result.upper[k], 0, 'g', 6)), static_cast<int>(k) + 1, 3);
+    }
+
+    QLabel *summaryLabel = new QLabel(QString("Sum of squares %1 over %2 observations, %3 iterations from start %4")
+        .arg(result.sumSquares, 0, 'g', 6)
+        .arg(result.numResiduals)
+        .arg(result.iterations)
+        .arg(result.bestStart + 1));
+
+    // Profile likelihoods, computed on demand and shown below the fitted values
+
+    QSpinBox *profilePointsSpinBox = new QSpinBox;
+    profilePointsSpinBox->setRange(1, ProfileLikelihood::maxPoints);
+    profilePointsSpinBox->setValue(10);
+    profilePointsSpinBox->setToolTip("Profile points on each side of the fitted value");
+
+    QLineEdit *profileSpanLineEdit = new QLineEdit("4");
+    profileSpanLineEdit->setValidator(new QDoubleValidator(0.0, 100.0, 3, profileSpanLineEdit));
+    profileSpanLineEdit->setToolTip("Half width of the profiles in standard errors, the slider range if there is none");
+
+    QPushButton *profileButton = new QPushButton("Profile likelihoods");
+
+    QHBoxLayout *profileHBoxLayout = new QHBoxLayout;
+    profileHBoxLayout->addWidget(new QLabel("Points per side"));
+    profileHBoxLayout->addWidget(profilePointsSpinBox);
+    profileHBoxLayout->addWidget(new QLabel("Span"));
+    profileHBoxLayout->addWidget(profileSpanLineEdit);
+    profileHBoxLayout->addWidget(profileButton);
+
+    QWidget *profilesWidget = new QWidget;
+    QGridLayout *profilesGridLayout = new QGridLayout;
+    profilesWidget->setLayout(profilesGridLayout);
+    profilesWidget->hide();
+
+    QPushButton *applyButton = new QPushButton("Apply");
+    QPushButton *discardButton = new QPushButton("Discard");
+
+    QHBoxLayout *buttonsHBoxLayout = new QHBoxLayout;
+    buttonsHBoxLayout->addWidget(applyButton);
+    buttonsHBoxLayout->addWidget(discardButton);
+
+    QVBoxLayout *dialogVBoxLayout = new QVBoxLayout;
+    dialogVBoxLayout->addLayout(valuesGridLayout);
+    dialogVBoxLayout->addWidget(summaryLabel);
+    dialogVBoxLayout->addLayout(profileHBoxLayout);
+    dialogVBoxLayout->addWidget(profilesWidget);
+    dialogVBoxLayout->addLayout(buttonsHBoxLayout);
+
+    QDialog dialog(this);
+    dialog.setWindowTitle(tr("Fit to observed data"));
+    dialog.setLayout(dialogVBoxLayout);
+
+    connect(applyButton, &QPushButton::clicked, &dialog, &QDialog::accept);
+    connect(discardButton, &QPushButton::clicked, &dialog, &QDialog::reject);
+
+    connect(profileButton, &QPushButton::clicked, [&](){
+        ProfileSettings profileSettings;
+        profileSettings.fit = settings;
+        profileSettings.optimum = result;
+        profileSettings.numPoints = profilePointsSpinBox->value();
+        profileSettings.span = profileSpanLineEdit->text().toDouble();
+
+        std::string error;
+
+        if (!ProfileLikelihood(profileSettings).validate(error))
+        {
+            QMessageBox::warning(&dialog, tr("Profile likelihoods"), QString::fromStdString(error));
+            return;
+        }
+
+        profileButton->setEnabled(false);
+
+        std::shared_ptr<ProfileLikelihood> likelihood = std::make_shared<ProfileLikelihood>(profileSettings);
+
+        ComputeJob *job = new ComputeJob([likelihood](const std::atomic<bool> &canceled, const std::function<void(double)> &progress){ return likelihood->run(canceled, progress); });
+
+        jobProgressDialog(job, "Computing profile likelihoods", &dialog);
+
+        // The job outlives the dialog if it is closed while profiling, and is then canceled
+
+        connect(&dialog, &QDialog::finished, job, &ComputeJob::cancel, Qt::DirectConnection);
+        connect(job, &ComputeJob::finished, job, &QObject::deleteLater);
+        connect(job, &ComputeJob::finished, profilesWidget, [=](bool success, bool canceled){
+            profileButton->setEnabled(true);
+
+            if (canceled || !success) return;
+
+            const ProfileLikelihood &profileLikelihood = *likelihood;
+            const std::vector<ParameterProfile> &profiles = profileLikelihood.getProfiles();
+
+            while (QLayoutItem *item = profilesGridLayout->takeAt(0))
+            {
+                delete item->widget();
+                delete item;
+            }
+
+            // One plot per unknown, deviance against the fixed value with the chi-squared threshold dashed
+
+            int numColumns = std::min(static_cast<int>(profiles.size()), 3);
+
+            for (int k = 0; k < static_cast<int>(profiles.size()); k++)
+            {
+                const ParameterProfile &profile = profiles[k];
+
+                QString name = k < numParameters ? parameterNames[k]->text() : QString("%1(0)").arg(variableShortNames[k - numParameters + 1]->text());
+
+                QCustomPlot *plot = new QCustomPlot;
+                plot->setMinimumSize(250, 200);
+                plot->xAxis->setLabel(name);
+                plot->yAxis->setLabel("Deviance");
+
+                QVector<double> keys(profile.values.begin(), profile.values.end());
+                QVector<double> values(profile.deviance.begin(), profile.deviance.end());
+
+                QCPGraph *profileGraph = plot->addGraph();
+                profileGraph->setData(keys, values, true);
+                profileGraph->setPen(QPen(QColor(31, 119, 180), 2));
+                profileGraph->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssDisc, 4));
+
+                QCPGraph *thresholdGraph = plot->addGraph();
+                thresholdGraph->setData({keys.front(), keys.back()}, {profileLikelihood.getThreshold(), profileLikelihood.getThreshold()}, true);
+                thresholdGraph->setPen(QPen(Qt::gray, 1, Qt::DashLine));
+
+                plot->rescaleAxes();
+                plot->yAxis->setRangeLower(0.0);
+
+                QString interval = QString("[%1, %2]").arg(profile.lower, 0, 'g', 6).arg(profile.upper, 0, 'g', 6);
+
+                plot->plotLayout()->insertRow(0);
+                plot->plotLayout()->addElement(0, 0, new QCPTextElement(plot, profile.identifiable ? interval : interval + " not identifiable"));
+
+                profilesGridLayout->addWidget(plot, k / numColumns, k % numColumns);
+            }
+
+            profilesWidget->show();
+            profilesWidget->window()->adjustSize();
+        });
+
+        startComputeJob(job);
+    });
+
+    return dialog.exec() == QDialog::Accepted;
+}
+
+void ScenarioModel::calibrateObservedData()
+{
+    if (observedData.times.empty())
+    {
+        QMessageBox::information(this, tr("Bayesian calibration"), tr("Import observed data first."));
+        return;
+    }
+
+    SamplerSettings settings;
+
+    if (!samplerDialog(settings)) return;
+
+    std::string error;
+
+    if (!PosteriorSampler(settings).validate(error))
+    {
+        QMessageBox::warning(this, tr("Bayesian calibration"), QString::fromStdString(error));
+        return;
+    }
+
+    std::shared_ptr<PosteriorSampler> posteriorSampler = std::make_shared<PosteriorSampler>(settings);
+    std::shared_ptr<PosteriorBands> bands = std::make_shared<PosteriorBands>();
+    std::vector<double> bandTimes = modelTimes();
+
+    // Sampling accounts for most of the time, the predictive bands for the rest
+
+    ComputeJob *job = new ComputeJob([=](const std::atomic<bool> &canceled, const std::function<void(double)> &progress){
+        if (!posteriorSampler->run(canceled, [&](double fraction){ progress(0.95 * fraction); }))
+            return false;
+
+        *bands = posteriorSampler->predictiveBands(bandTimes, 200);
+
+        progress(1.0);
+
+        return true;
+    });
+
+    jobProgressDialog(job, "Sampling the posterior", this);
+
+    connect(job, &ComputeJob::finished, this, [=](bool success, bool canceled){
+        job->deleteLater();
+
+        if (canceled) return;
+
+        if (!success)
+        {
+            QMessageBox::warning(this, tr("Bayesian calibration"), tr("The samples could not be written."));
+            return;
+        }
+
+        posteriorBands = *bands;
+
+        // Band graphs on the plots of each variable, both in the grid and in their own tabs
+
+        if (posteriorGraphs.empty())
+        {
+            for (int i = 0; i < 2 * dimension; i++)
+            {
+                QCPGraph *lowerGraph = plots[i]->addGraph();
+                QCPGraph *upperGraph = plots[i]->addGraph();
+                QCPGraph *medianGraph = plots[i]->addGraph();
+
+                lowerGraph->setPen(QPen(QColor(120, 120, 120, 120)));
+                upperGraph->setPen(QPen(QColor(120, 120, 120, 120)));
+                upperGraph->setBrush(QBrush(QColor(120, 120, 120, 60)));
+                upperGraph->setChannelFillGraph(lowerGraph);
+                medianGraph->setPen(QPen(QColor(80, 80, 80), 1, Qt::DashLine));
+
+                posteriorGraphs.push_back(lowerGraph);
+                posteriorGraphs.push_back(upperGraph);
+                posteriorGraphs.push_back(medianGraph);
+            }
+        }
+
+        setPosteriorPlotsData();
+
+        // Posterior mean and central interval of each unknown
+
+        const PosteriorSampler &sampler = *posteriorSampler;
+        const std::vector<std::vector<double>> &samples = sampler.getSamples();
+        std::vector<std::string> names = sampler.getUnknownNames();
+
+        QString summary;
+
+        for (size_t k = 0; k < names.size(); k++)
+        {
+            std::vector<double> values;
+
+            for (const std::vector<double> &sample : samples)
+                values.push_back(sample[k]);
+
+            std::sort(values.begin(), values.end());
+
+            double mean = std::accumulate(values.begin(), values.end(), 0.0) / values.size();
+            double lower = values[static_cast<size_t>((0.5 - 0.5 * PosteriorSampler::bandLevel) * (values.size() - 1))];
+            double upper = values[static_cast<size_t>((0.5 + 0.5 * PosteriorSampler::bandLevel) * (values.size() - 1))];
+
+            summary.append(QString("%1: %2 [%3, %4]\n").arg(QString::fromStdString(names[k])).arg(mean, 0, 'g', 6).arg(lower, 0, 'g', 6).arg(upper, 0, 'g', 6));
+        }
+
+        QStringList rates;
+
+        for (double rate : sampler.getAcceptanceRates())
+            rates.append(QString::number(rate, 'f', 3));
+
+        summary.append(QString("\nAcceptance rates: %1").arg(rates.join(", ")));
+
+        QMessageBox::information(this, tr("Bayesian calibration"), summary);
+    });
+
+    startComputeJob(job);
+}
+
+bool ScenarioModel::samplerDialog(SamplerSettings &settings)
+{
+    QSpinBox *chainsSpinBox = new QSpinBox;
+    chainsSpinBox->setRange(1, PosteriorSampler::maxChains);
+    chainsSpinBox->setValue(4);
+
+    QSpinBox *burnInSpinBox = new QSpinBox;
+    burnInSpinBox->setRange(0, 10000000);
+    burnInSpinBox->setValue(2000);
+
+    QSpinBox *samplesSpinBox = new QSpinBox;
+    samplesSpinBox->setRange(1, 10000000);
+    samplesSpinBox->setValue(5000);
+
+    QSpinBox *seedSpinBox = new QSpinBox;
+    seedSpinBox->setRange(0, std::numeric_limits<int>::max());
+    seedSpinBox->setValue(1);
+
+    // Samples are optionally streamed to a file as they are drawn
+
+    QLineEdit *fileLineEdit = new QLineEdit;
+    fileLineEdit->setPlaceholderText("Not written");
+
+    QPushButton *browseButton = new QPushButton("Browse");
+
+    connect(browseButton, &QPushButton::clicked, [=](){
+        QString fileName = QFileDialog::getSaveFileName(this, tr("Posterior samples"), "", tr("Data files (*.dat *.txt)"));
+        if (!fileName.isEmpty()) fileLineEdit->setText(fileName);
+    });
+
+    QHBoxLayout *fileHBoxLayout = new QHBoxLayout;
+    fileHBoxLayout->addWidget(fileLineEdit);
+    fileHBoxLayout->addWidget(browseButton);
+
+    QPushButton *acceptButton = new QPushButton("Accept");
+
+    QVBoxLayout *dialogVBoxLayout = new QVBoxLayout;
+    dialogVBoxLayout->addWidget(new QLabel("Chains"));
+    dialogVBoxLayout->addWidget(chainsSpinBox);
+    dialogVBoxLayout->addWidget(new QLabel("Burn-in iterations per chain"));
+    dialogVBoxLayout->addWidget(burnInSpinBox);
+    dialogVBoxLayout->addWidget(new QLabel("Samples per chain"));
+    dialogVBoxLayout->addWidget(samplesSpinBox);
+    dialogVBoxLayout->addWidget(new QLabel("Seed"));
+    dialogVBoxLayout->addWidget(seedSpinBox);
+    dialogVBoxLayout->addWidget(new QLabel("Samples file"));
+    dialogVBoxLayout->addLayout(fileHBoxLayout);
+    dialogVBoxLayout->addWidget(acceptButton);
+
+    QDialog dialog(this);
+    dialog.setWindowTitle(tr("Bayesian calibration"));
+    dialog.setLayout(dialogVBoxLayout);
+
+    connect(acceptButton, &QPushButton::clicked, &dialog, &QDialog::accept);
+
+    if (dialog.exec() != QDialog::Accepted) return false;
+
+    settings.modelIndex = modelIndex;
+    settings.scenarios = scenarios;
+    settings.observedTimes = observedData.times;
+    settings.observedValues.assign(dimension, std::vector<double>());
+
+    for (int i = 0; i < dimension; i++)
+    {
+        if (i < static_cast<int>(observedColumns.size()) && observedColumns[i] >= 0)
+            settings.observedValues[i] = observedData.columns[observedColumns[i]];
+    }
+
+    settings.numChains = chainsSpinBox->value();
+    settings.burnIn = burnInSpinBox->value();
+    settings.numSamples = samplesSpinBox->value();
+    settings.seed = static_cast<uint64_t>(seedSpinBox->value());
+    settings.fileName = QFile::encodeName(fileLineEdit->text()).toStdString();
+
+    return true;
+}
+
+void ScenarioModel::setPosteriorPlotsData()
+{
+    if (posteriorGraphs.empty()) return;
+
+    QVector<double> keys(posteriorBands.times.begin(), posteriorBands.times.end());
+
+    for (int i = 0; i < dimension && i < static_cast<int>(posteriorBands.lower.size()); i++)
+    {
+        QVector<double> lower(posteriorBands.lower[i].begin(), posteriorBands.lower[i].end());
+        QVector<double> upper(posteriorBands.upper[i].begin(), posteriorBands.upper[i].end());
+        QVector<double> median(posteriorBands.median[i].begin(), posteriorBands.median[i].end());
+
+        for (int plot : {i, i + dimension})
+        {
+            posteriorGraphs[3 * plot]->setData(keys, lower, true);
+            posteriorGraphs[3 * plot + 1]->setData(keys, upper, true);
+            posteriorGraphs[3 * plot + 2]->setData(keys, median, true);
+
+            plots[plot]->replot();
+        }
+    }
+}
+
+void ScenarioModel::runEnsemble()
+{
+    EnsembleSettings settings;
+
+    if (!ensembleDialog(settings)) return;
+
+    std::string error;
+
+    if (!MonteCarloEnsemble(settings).validate(error))
+    {
+        QMessageBox::warning(this, tr("Monte Carlo ensemble"), QString::fromStdString(error));
+        return;
+    }
+
+    std::shared_ptr<MonteCarloEnsemble> ensemble = std::make_shared<MonteCarloEnsemble>(settings);
+
+    ComputeJob *job = new ComputeJob([ensemble](const std::atomic<bool> &canceled, const std::function<void(double)> &progress){ return ensemble->run(canceled, progress); });
+
+    jobProgressDialog(job, QString("Solving %1 ensemble members").arg(settings.numMembers), this);
+
+    connect(job, &ComputeJob::finished, this, [=](bool success, bool canceled){
+        job->deleteLater();
+
+        if (!success || canceled) return;
+
+        ensembleBands = ensemble->getBands();
+
+        // Band graphs on the plots of each variable, both in the grid and in their own tabs
+
+        if (ensembleGraphs.empty())
+        {
+            QColor color(31, 119, 180);
+
+            for (int i = 0; i < 2 * dimension; i++)
+            {
+
+                QCPGraph *outerLowerGraph = plots[i]->addGraph();
+                QCPGraph *outerUpperGraph = plots[i]->addGraph();
+                QCPGraph *innerLowerGraph = plots[i]->addGraph();
+                QCPGraph *innerUpperGraph = plots[i]->addGraph();
+                QCPGraph *medianGraph = plots[i]->addGraph();
+
+                outerLowerGraph->setPen(Qt::NoPen);
+                outerUpperGraph->setPen(Qt::NoPen);
+                outerUpperGraph->setBrush(QBrush(QColor(color.red(), color.green(), color.blue(), 40)));
+                outerUpperGraph->setChannelFillGraph(outerLowerGraph);
+
+                innerLowerGraph->setPen(Qt::NoPen);
+                innerUpperGraph->setPen(Qt::NoPen);
+                innerUpperGraph->setBrush(QBrush(QColor(color.red(), color.green(), color.blue(), 80)));
+                innerUpperGraph->setChannelFillGraph(innerLowerGraph);
+
+                medianGraph->setPen(QPen(color.darker(), 2));
+
+                ensembleGraphs.push_back(outerLowerGraph);
+                ensembleGraphs.push_back(outerUpperGraph);
+                ensembleGraphs.push_back(innerLowerGraph);
+                ensembleGraphs.push_back(innerUpperGraph);
+                ensembleGraphs.push_back(medianGraph);
+            }
+        }
+
+        setEnsemblePlotsData();
+
+        int numFailed = ensemble->getNumFailed();
+
+        if (numFailed > 0)
+        {
+            QMessageBox::information(this, tr("Monte Carlo ensemble"), tr("%1 members with non-finite solutions were left out.").arg(numFailed));
+        }
+    });
+
+    startComputeJob(job);
+}
+
+bool ScenarioModel::ensembleDialog(EnsembleSettings &settings)
+{
+    QGridLayout *distributionsGridLayout = new QGridLayout;
+
+    distributionsGridLayout->addWidget(new QLabel("Distribution"), 0, 1);
+    distributionsGridLayout->addWidget(new QLabel("Minimum / mean"), 0, 2);
+    distributionsGridLayout->addWidget(new QLabel("Maximum / deviation"), 0, 3);
+
+    // Distribution of each parameter of each scenario, fixed by default
+
+    std::vector<QComboBox*> typeComboBoxes;
+    std::vector<QLineEdit*> aLineEdits;
+    std::vector<QLineEdit*> bLineEdits;
+
+    int row = 1;
+
+    for (size_t s = 0; s < scenarios.size(); s++)
+    {
+        for (int k = 0; k < numParameters; k++)
+        {
+            double value = scenarios[s].parameters[k];
+
+            QComboBox *typeComboBox = new QComboBox;
+            typeComboBox->addItems({"Fixed", "Uniform", "Normal", "Log-normal"});
+
+            QLineEdit *aLineEdit = new QLineEdit;
+            aLineEdit->setValidator(new QDoubleValidator(aLineEdit));
+
+            QLineEdit *bLineEdit = new QLineEdit;
+            bLineEdit->setValidator(new QDoubleValidator(bLineEdit));
+
+            // Defaults spread the current value by about ten percent
+
+            auto setDefaults = [=](int type){
+                aLineEdit->setEnabled(type != ParameterDistribution::Fixed);
+                bLineEdit->setEnabled(type != ParameterDistribution::Fixed);
+
+                if (type == ParameterDistribution::Uniform)
+                {
+                    aLineEdit->setText(QString::number(std::max(0.9 * value, scenarios[s].parametersMin[k])));
+                    bLineEdit->setText(QString::number(std::min(1.1 * value, scenarios[s].parametersMax[k])));
+                }
+                else if (type == ParameterDistribution::Normal)
+                {
+                    aLineEdit->setText(QString::number(value));
+                    bLineEdit->setText(QString::number(0.1 * value));
+                }
+                else if (type == ParameterDistribution::LogNormal)
+                {
+                    aLineEdit->setText(QString::number(std::log(std::max(value, 1.0e-12))));
+                    bLineEdit->setText(QString::number(0.1));
+                }
+                else
+                {
+                    aLineEdit->setText(QString::number(value));
+                    bLineEdit->clear();
+                }
+            };
+
+            setDefaults(ParameterDistribution::Fixed);
+
+            connect(typeComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged), aLineEdit, setDefaults);
+
+            distributionsGridLayout->addWidget(new QLabel(QString("Scenario %1, %2").arg(s + 1).arg(parameterNames[k]->text())), row, 0);
+            distributionsGridLayout->addWidget(typeComboBox, row, 1);
+            distributionsGridLayout->addWidget(aLineEdit, row, 2);
+            distributionsGridLayout->addWidget(bLineEdit, row, 3);
+
+            typeComboBoxes.push_back(typeComboBox);
+            aLineEdits.push_back(aLineEdit);
+            bLineEdits.push_back(bLineEdit);
+
+            row++;
+        }
+    }
+
+    QWidget *distributionsWidget = new QWidget;
+    distributionsWidget->setLayout(distributionsGridLayout);
+
+    QScrollArea *distributionsScrollArea = new QScrollArea;
+    distributionsScrollArea->setWidget(distributionsWidget);
+    distributionsScrollArea->setWidgetResizable(true);
+
+    QSpinBox *membersSpinBox = new QSpinBox;
+    membersSpinBox->setRange(1, MonteCarloEnsemble::maxMembers);
+    membersSpinBox->setValue(1000);
+
+    QSpinBox *gridSpinBox = new QSpinBox;
+    gridSpinBox->setRange(2, 100000);
+    gridSpinBox->setValue(500);
+
+    QSpinBox *seedSpinBox = new QSpinBox;
+    seedSpinBox->setRange(0, std::numeric_limits<int>::max());
+    seedSpinBox->setValue(1);
+
+    QPushButton *acceptButton = new QPushButton("Accept");
+
+    QVBoxLayout *dialogVBoxLayout = new QVBoxLayout;
+    dialogVBoxLayout->addWidget(distributionsScrollArea);
+    dialogVBoxLayout->addWidget(new QLabel("Members"));
+    dialogVBoxLayout->addWidget(membersSpinBox);
+    dialogVBoxLayout->addWidget(new QLabel("Grid times"));
+    dialogVBoxLayout->addWidget(gridSpinBox);
+    dialogVBoxLayout->addWidget(new QLabel("Seed"));
+    dialogVBoxLayout->addWidget(seedSpinBox);
+    dialogVBoxLayout->addWidget(acceptButton);
+
+    QDialog dialog(this);
+    dialog.setWindowTitle(tr("Monte Carlo ensemble"));
+    dialog.setLayout(dialogVBoxLayout);
+
+    connect(acceptButton, &QPushButton::clicked, &dialog, &QDialog::accept);
+
+    if (dialog.exec() != QDialog::Accepted) return false;
+
+    settings.modelIndex = modelIndex;
+    settings.scenarios = scenarios;
+    settings.distributions.assign(scenarios.size(), std::vector<ParameterDistribution>(numParameters));
+
+    for (size_t s = 0; s < scenarios.size(); s++)
+    {
+        for (int k = 0; k < numParameters; k++)
+        {
+            size_t index = s * numParameters + k;
+
+            settings.distributions[s][k] = ParameterDistribution{typeComboBoxes[index]->currentIndex(), aLineEdits[index]->text().toDouble(), bLineEdits[index]->text().toDouble()};
+        }
+    }
+
+    settings.numMembers = membersSpinBox->value();
+    settings.seed = static_cast<uint64_t>(seedSpinBox->value());
+    settings.times = MonteCarloEnsemble::chainGrid(scenarios, gridSpinBox->value());
+    settings.quantiles = {0.05, 0.25, 0.5, 0.75, 0.95};
+
+    return true;
+}
+
+void ScenarioModel::setEnsemblePlotsData()
+{
+    if (ensembleGraphs.empty() || ensembleBands.values.size() != 5) return;
+
+    QVector<double> keys(ensembleBands.times.begin(), ensembleBands.times.end());
+
+    for (int i = 0; i < dimension; i++)
+    {
+        for (int plot : {i, i + dimension})
+        {
+            // Graphs in quantile order: 5%, 95%, 25%, 75% and median
+
+            const int quantileIndices[5] = {0, 4, 1, 3, 2};
+
+            for (int g = 0; g < 5; g++)
+            {
+                const std::vector<double> &values = ensembleBands.values[quantileIndices[g]][i];
+                ensembleGraphs[5 * plot + g]->setData(keys, QVector<double>(values.begin(), values.end()), true);
+            }
+
+            plots[plot]->replot();
+        }
+    }
+}
+
+void ScenarioModel::globalSensitivity()
+{
+    GlobalSensitivitySettings settings;
+
+    if (!globalSensitivityDialog(settings)) return;
+
+    std::string error;
+
+    if (!GlobalSensitivity(settings).validate(error))
+    {
+        QMessageBox::warning(this, tr("Global sensitivity"), QString::fromStdString(error));
+        return;
+    }
+
+    std::shared_ptr<GlobalSensitivity> analysis = std::make_shared<GlobalSensitivity>(settings);
+
+    ComputeJob *job = new ComputeJob([analysis](const std::atomic<bool> &canceled, const std::function<void(double)> &progress){ return analysis->run(canceled, progress); });
+
+    jobProgressDialog(job, QString("Solving %1 parameter samples").arg(analysis->getNumEvaluations()), this);
+
+    connect(job, &ComputeJob::finished, this, [=](bool success, bool canceled){
+        job->deleteLater();
+
+        if (!success || canceled) return;
+
+        globalSensitivityResultDialog(*analysis);
+    });
+
+    startComputeJob(job);
+}
+
+bool ScenarioModel::globalSensitivityDialog(GlobalSensitivitySettings &settings)
+{
+    QGridLayout *rangesGridLayout = new QGridLayout;
+
+    rangesGridLayout->addWidget(new QLabel("Minimum"), 0, 1);
+    rangesGridLayout->addWidget(new QLabel("Maximum"), 0, 2);
+
+    // Range of each parameter in the first scenario, its slider range by default
+
+    const Scenario &scenario = scenarios.front();
+
+    std::vector<QLineEdit*> minLineEdits;
+    std::vector<QLineEdit*> maxLineEdits;
+
+    for (int i = 0; i < numParameters; i++)
+    {
+        QLineEdit *minLineEdit = new QLineEdit(QString::number(scenario.parametersMin[i]));
+        minLineEdit->setValidator(new QDoubleValidator(scenario.parametersMin[i], scenario.parametersMax[i], 10, minLineEdit));
+
+        QLineEdit *maxLineEdit = new QLineEdit(QString::number(scenario.parametersMax[i]));
+        maxLineEdit->setValidator(new QDoubleValidator(scenario.parametersMin[i], scenario.parametersMax[i], 10, maxLineEdit));
+
+        rangesGridLayout->addWidget(new QLabel(parameterNames[i]->text()), i + 1, 0);
+        rangesGridLayout->addWidget(minLineEdit, i + 1, 1);
+        rangesGridLayout->addWidget(maxLineEdit, i + 1, 2);
+
+        minLineEdits.push_back(minLineEdit);
+        maxLineEdits.push_back(maxLineEdit);
+    }
+
+    // Base samples, a power of two keeps the Sobol points balanced
+
+    QSpinBox *samplesSpinBox = new QSpinBox;
+    samplesSpinBox->setRange(2, GlobalSensitivity::maxSamples);
+    samplesSpinBox->setValue(4096);
+
+    QSpinBox *gridSpinBox = new QSpinBox;
+    gridSpinBox->setRange(2, 100000);
+    gridSpinBox->setValue(500);
+
+    QLabel *numEvaluationsLabel = new QLabel;
+
+    auto updateNumEvaluations = [=](){
+        numEvaluationsLabel->setText(QString("Solves: %1").arg(static_cast<double>(samplesSpinBox->value()) * (numParameters + 2), 0, 'g', 10));
+    };
+
+    connect(samplesSpinBox, QOverload<int>::of(&QSpinBox::valueChanged), numEvaluationsLabel, updateNumEvaluations);
+
+    updateNumEvaluations();
+
+    QPushButton *acceptButton = new QPushButton("Accept");
+
+    QVBoxLayout *dialogVBoxLayout = new QVBoxLayout;
+    dialogVBoxLayout->addLayout(rangesGridLayout);
+    dialogVBoxLayout->addWidget(new QLabel("Base samples"));
+    dialogVBoxLayout->addWidget(samplesSpinBox);
+    dialogVBoxLayout->addWidget(new QLabel("Grid times"));
+    dialogVBoxLayout->addWidget(gridSpinBox);
+    dialogVBoxLayout->addWidget(numEvaluationsLabel);
+    dialogVBoxLayout->addWidget(acceptButton);
+
+    QDialog dialog(this);
+    dialog.setWindowTitle(tr("Global sensitivity"));
+    dialog.setLayout(dialogVBoxLayout);
+
+    connect(acceptButton, &QPushButton::clicked, &dialog, &QDialog::accept);
+
+    if (dialog.exec() != QDialog::Accepted) return false;
+
+    settings.modelIndex = modelIndex;
+    settings.scenarios = scenarios;
+    settings.parameterMin.clear();
+    settings.parameterMax.clear();
+
+    for (int i = 0; i < numParameters; i++)
+    {
+        settings.parameterMin.push_back(minLineEdits[i]->text().toDouble());
+        settings.parameterMax.push_back(maxLineEdits[i]->text().toDouble());
+    }
+
+    settings.numSamples = samplesSpinBox->value();
+    settings.numTimes = gridSpinBox->value();
+
+    return true;
+}
+
+void ScenarioModel::globalSensitivityResultDialog(const GlobalSensitivity &analysis)
+{
+    // First-order and total-effect index of each parameter on each metric
+
+    QGridLayout *indicesGridLayout = new QGridLayout;
+
+    for (int i = 0; i < numParameters; i++)
+    {
+        indicesGridLayout->addWidget(new QLabel(QString("S %1").arg(parameterNames[i]->text())), 0, 2 * i + 1);
+        indicesGridLayout->addWidget(new QLabel(QString("ST %1").arg(parameterNames[i]->text())), 0, 2 * i + 2);
+    }
+
+    const std::vector<SobolIndices> &metricIndices = analysis.getMetricIndices();
+
+    for (int m = 0; m < static_cast<int>(metricIndices.size()); m++)
+    {
+        indicesGridLayout->addWidget(new QLabel(GlobalSensitivity::metricName(m)), m + 1, 0);
+
+        for (int i = 0; i < numParameters; i++)
+        {
+            indicesGridLayout->addWidget(new QLabel(QString::number(metricIndices[m].firstOrder[i], 'f', 3)), m + 1, 2 * i + 1);
+            indicesGridLayout->addWidget(new QLabel(QString::number(metricIndices[m].totalEffect[i], 'f', 3)), m + 1, 2 * i + 2);
+        }
+    }
+
+    // Time-resolved indices of the infected fraction, total effects dashed
+
+    QCustomPlot *plot = new QCustomPlot;
+    plot->setMinimumSize(600, 300);
+    plot->legend->setVisible(true);
+    plot->xAxis->setLabel("Time");
+    plot->yAxis->setLabel("Index of infected");
+
+    QVector<double> keys(analysis.getTimes().begin(), analysis.getTimes().end());
+
+    const std::vector<SobolIndices> &timeIndices = analysis.getTimeIndices();
+
+    for (int i = 0; i < numParameters; i++)
+    {
+        QVector<double> firstOrder, totalEffect;
+
+        for (const SobolIndices &indices : timeIndices)
+        {
+            firstOrder.push_back(indices.firstOrder[i]);
+            totalEffect.push_back(indices.totalEffect[i]);
+        }
+
+        QColor color = QColor::fromHsv(i * 360 / numParameters, 255, 200);
+
+        QCPGraph *firstOrderGraph = plot->addGraph();
+        firstOrderGraph->setData(keys, firstOrder, true);
+        firstOrderGraph->setPen(QPen(color, 2));
+        firstOrderGraph->setName(QString("S %1").arg(parameterNames[i]->text()));
+
+        QCPGraph *totalEffectGraph = plot->addGraph();
+        totalEffectGraph->setData(keys, totalEffect, true);
+        totalEffectGraph->setPen(QPen(color, 2, Qt::DashLine));
+        totalEffectGraph->setName(QString("ST %1").arg(parameterNames[i]->text()));
+    }
+
+    plot->rescaleAxes();
+    plot->yAxis->setRange(0.0, 1.0);
+
+    QPushButton *exportButton = new QPushButton("Export");
+    QPushButton *closeButton = new QPushButton("Close");
+
+    QHBoxLayout *buttonsHBoxLayout = new QHBoxLayout;
+    buttonsHBoxLayout->addWidget(exportButton);
+    buttonsHBoxLayout->addWidget(closeButton);
+
+    QVBoxLayout *dialogVBoxLayout = new QVBoxLayout;
+    dialogVBoxLayout->addLayout(indicesGridLayout);
+    dialogVBoxLayout->addWidget(plot);
+    dialogVBoxLayout->addLayout(buttonsHBoxLayout);
+
+    QDialog dialog(this);
+    dialog.setWindowTitle(tr("Global sensitivity"));
+    dialog.setLayout(dialogVBoxLayout);
+
+    connect(exportButton, &QPushButton::clicked, [&](){
+        QString fileName = QFileDialog::getSaveFileName(&dialog, tr("Export Sobol indices"), "", tr("Data files (*.dat *.txt)"));
+
+        if (!fileName.isEmpty() && !analysis.writeText(QFile::encodeName(fileName).toStdString()))
+            QMessageBox::warning(&dialog, tr("Global sensitivity"), tr("The indices could not be written to %1.").arg(fileName));
+    });
+    connect(closeButton, &QPushButton::clicked, &dialog, &QDialog::accept);
+
+    dialog.exec();
+}
+
+void ScenarioModel::optimizeInterventions()
+{
+    InterventionSettings settings;
+
+    if (!interventionDialog(settings)) return;
+
+    std::string error;
+
+    if (!InterventionOptimizer(settings).validate(error))
+    {
+        QMessageBox::warning(this, tr("Optimize interventions"), QString::fromStdString(error));
+        return;
+    }
+
+    std::shared_ptr<InterventionOptimizer> optimizer = std::make_shared<InterventionOptimizer>(settings);
+
+    ComputeJob *job = new ComputeJob([optimizer](const std::atomic<bool> &canceled, const std::function<void(double)> &progress){ return optimizer->run(canceled, progress); });
+
+    jobProgressDialog(job, QString("Evolving %1 generations").arg(settings.numGenerations), this);
+
+    connect(job, &ComputeJob::finished, this, [=](bool success, bool canceled){
+        job->deleteLater();
+
+        if (!success || canceled) return;
+
+        const InterventionResult &result = optimizer->getResult();
+
+        // The chain may have been edited while optimizing, then the schedule no longer applies to it
+
+        if (chainChangedSince(settings.scenarios) || result.scenarios.size() != scenarios.size())
+        {
+            QMessageBox::warning(this, tr("Optimize interventions"), tr("The scenarios changed while optimizing, the result was discarded."));
+            return;
+        }
+
+        if (!interventionResultDialog(*optimizer)) return;
+
+        // The best chain replaces the current one, with its time ranges updated
+
+        for (size_t i = 0; i < scenarios.size(); i++)
+        {
+            scenarios[i].parameters = result.scenarios[i].parameters;
+            scenarios[i].timeStart = result.scenarios[i].timeStart;
+            scenarios[i].timeEnd = result.scenarios[i].timeEnd;
+            scenarios[i].timeEndMax = result.scenarios[i].timeEndMax;
+        }
+
+        updateTimeRangeMinMax();
+
+        emit scenariosOptimized();
+    });
+
+    startComputeJob(job);
+}
+
+bool ScenarioModel::interventionDialog(InterventionSettings &settings)
+{
+    QComboBox *parameterComboBox = new QComboBox;
+
+    for (int k = 0; k < numParameters; k++)
+        parameterComboBox->addItem(parameterNames[k]->text());
+
+    QComboBox *objectiveComboBox = new QComboBox;
+
+    for (int objective = 0; objective < InterventionOptimizer::NumObjectives; objective++)
+        objectiveComboBox->addItem(InterventionOptimizer::objectiveName(objective));
+
+    // Cost per unit time of an intervention that reduces the parameter to zero
+
+    QLineEdit *costLineEdit = new QLineEdit("0.001");
+    costLineEdit->setValidator(new QDoubleValidator(0.0, 1.0e6, 6, costLineEdit));
+    costLineEdit->setToolTip("Added to the objective per unit time of an intervention, times its relative reduction of the parameter");
+
+    QCheckBox *timesCheckBox = new QCheckBox("Optimize switch times");
+    timesCheckBox->setChecked(true);
+
+    QSpinBox *populationSpinBox = new QSpinBox;
+    populationSpinBox->setRange(4, InterventionOptimizer::maxPopulation);
+    populationSpinBox->setValue(32);
+
+    QSpinBox *generationsSpinBox = new QSpinBox;
+    generationsSpinBox->setRange(1, 100000);
+    generationsSpinBox->setValue(200);
+
+    QSpinBox *gridSpinBox = new QSpinBox;
+    gridSpinBox->setRange(2, 100000);
+    gridSpinBox->setValue(1000);
+
+    QSpinBox *seedSpinBox = new QSpinBox;
+    seedSpinBox->setRange(0, std::numeric_limits<int>::max());
+    seedSpinBox->setValue(1);
+
+    QLabel *scenariosLabel = new QLabel(QString("The first scenario is the baseline, the other %1 are interventions").arg(scenarios.size() - 1));
+
+    QPushButton *acceptButton = new QPushButton("Accept");
+
+    QVBoxLayout *dialogVBoxLayout = new QVBoxLayout;
+    dialogVBoxLayout->addWidget(scenariosLabel);
+    dialogVBoxLayout->addWidget(new QLabel("Intervened parameter"));
+    dialogVBoxLayout->addWidget(parameterComboBox);
+    dialogVBoxLayout->addWidget(new QLabel("Objective"));
+    dialogVBoxLayout->addWidget(objectiveComboBox);
+    dialogVBoxLayout->addWidget(new QLabel("Duration cost"));
+    dialogVBoxLayout->addWidget(costLineEdit);
+    dialogVBoxLayout->addWidget(timesCheckBox);
+    dialogVBoxLayout->addWidget(new QLabel("Population size"));
+    dialogVBoxLayout->addWidget(populationSpinBox);
+    dialogVBoxLayout->addWidget(new QLabel("Generations"));
+    dialogVBoxLayout->addWidget(generationsSpinBox);
+    dialogVBoxLayout->addWidget(new QLabel("Grid times"));
+    dialogVBoxLayout->addWidget(gridSpinBox);
+    dialogVBoxLayout->addWidget(new QLabel("Seed"));
+    dialogVBoxLayout->addWidget(seedSpinBox);
+    dialogVBoxLayout->addWidget(acceptButton);
+
+    QDialog dialog(this);
+    dialog.setWindowTitle(tr("Optimize interventions"));
+    dialog.setLayout(dialogVBoxLayout);
+
+    connect(acceptButton, &QPushButton::clicked, &dialog, &QDialog::accept);
+
+    if (dialog.exec() != QDialog::Accepted) return false;
+
+    settings.modelIndex = modelIndex;
+    settings.scenarios = scenarios;
+    settings.parameterIndex = parameterComboBox->currentIndex();
+    settings.objective = objectiveComboBox->currentIndex();
+    settings.durationCost = costLineEdit->text().toDouble();
+    settings.optimizeTimes = timesCheckBox->isChecked();
+    settings.populationSize = populationSpinBox->value();
+    settings.numGenerations = generationsSpinBox->value();
+    settings.numTimes = gridSpinBox->value();
+    settings.seed = static_cast<uint64_t>(seedSpinBox->value());
+
+    return true;
+}
+
+bool ScenarioModel::interventionResultDialog(const InterventionOptimizer &optimizer)
+{
+    const InterventionResult &result = optimizer.getResult();
+
+    // Start and level of each intervention
+
+    QGridLayout *scheduleGridLayout = new QGridLayout;
+
+    scheduleGridLayout->addWidget(new QLabel("Start"), 0, 1);
+    scheduleGridLayout->addWidget(new QLabel("Level"), 0, 2);
+
+    for (size_t s = 0; s < result.levels.size(); s++)
+    {
+        int row = static_cast<int>(s) + 1;
+
+        scheduleGridLayout->addWidget(new QLabel(QString("Scenario %1").arg(s + 2)), row, 0);
+        scheduleGridLayout->addWidget(new QLabel(QString::number(result.switchTimes[s], 'g', 6)), row, 1);
+        scheduleGridLayout->addWidget(new QLabel(QString::number(result.levels[s], 'g', 6)), row, 2);
+    }
+
+    QLabel *summaryLabel = new QLabel(QString("Objective %1 (metric %2, cost %3), from %4 (metric %5, cost %6), %7 evaluations in %8 generations")
+        .arg(result.objective, 0, 'g', 6)
+        .arg(result.metric, 0, 'g', 6)
+        .arg(result.cost, 0, 'g', 6)
+        .arg(result.initialObjective, 0, 'g', 6)
+        .arg(result.initialMetric, 0, 'g', 6)
+        .arg(result.initialCost, 0, 'g', 6)
+        .arg(result.evaluations)
+        .arg(result.generations));
+    summaryLabel->setWordWrap(true);
+
+    // Best objective along the generations
+
+    QCustomPlot *plot = new QCustomPlot;
+    plot->setMinimumSize(400, 200);
+    plot->xAxis->setLabel("Generation");
+    plot->yAxis->setLabel("Best objective");
+
+    const std::vector<double> &history = optimizer.getHistory();
+
+    QVector<double> keys(static_cast<int>(history.size()));
+    std::iota(keys.begin(), keys.end(), 1.0);
+
+    QCPGraph *historyGraph = plot->addGraph();
+    historyGraph->setData(keys, QVector<double>(history.begin(), history.end()), true);
+    historyGraph->setPen(QPen(QColor(31, 119, 180), 2));
+
+    plot->rescaleAxes();
+
+    QPushButton *applyButton = new QPushButton("Apply");
+    QPushButton *discardButton = new QPushButton("Discard");
+
+    QHBoxLayout *buttonsHBoxLayout = new QHBoxLayout;
+    buttonsHBoxLayout->addWidget(applyButton);
+    buttonsHBoxLayout->addWidget(discardButton);
+
+    QVBoxLayout *dialogVBoxLayout = new QVBoxLayout;
+    dialogVBoxLayout->addLayout(scheduleGridLayout);
+    dialogVBoxLayout->addWidget(summaryLabel);
+    dialogVBoxLayout->addWidget(plot);
+    dialogVBoxLayout->addLayout(buttonsHBoxLayout);
+
+    QDialog dialog(this);
+    dialog.setWindowTitle(tr("Optimize interventions"));
+    dialog.setLayout(dialogVBoxLayout);
+
+    connect(applyButton, &QPushButton::clicked, &dialog, &QDialog::accept);
+    connect(discardButton, &QPushButton::clicked, &dialog, &QDialog::reject);
+
+    return dialog.exec() == QDialog::Accepted;
+}
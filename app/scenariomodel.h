@@ -0,0 +1,192 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef SCENARIOMODEL_H
+#define SCENARIOMODEL_H
+
+#include "basemodel.h"
+#include "scenario.h"
+#include "analyticmetrics.h"
+#include "seriesslots.h"
+#include "animationexporter.h"
+#include "exportjob.h"
+#include "computejob.h"
+#include "computepool.h"
+#include "jobprogressdialog.h"
+#include "parametersweep.h"
+#include "parameterfit.h"
+#include "profilelikelihood.h"
+#include "posteriorsampler.h"
+#include "montecarloensemble.h"
+#include "globalsensitivity.h"
+#include "interventionoptimizer.h"
+#include "observeddata.h"
+#include "qcustomplot.h"
+#include <list>
+#include <vector>
+#include <QString>
+#include <QLabel>
+#include <QGridLayout>
+#include <QWidget>
+#include <QPen>
+#include <QPoint>
+#include <QMenu>
+#include <QSpinBox>
+#include <QPushButton>
+#include <QDialog>
+#include <QFileDialog>
+#include <QFile>
+#include <QTextStream>
+#include <QApplication>
+#include <QMessageBox>
+#include <QProgressDialog>
+#include <QFileInfo>
+#include <QComboBox>
+#include <QLineEdit>
+#include <QDoubleValidator>
+#include <QCheckBox>
+
+class ScenarioModel: virtual public QWidget, public BaseModel
+{
+    Q_OBJECT
+
+public:
+    std::vector<double> parameterInit;
+
+    std::vector<double> initialConditions;
+
+    std::vector<QCustomPlot*> plots;
+    QCustomPlot *allVariablesPlot;
+    QWidget *plotsGridWidget;
+
+    std::vector<SeriesSlots> plotSlots;
+    std::vector<SeriesSlots> allVariablesSlots;
+
+    std::vector<Scenario> scenarios;
+
+    // Observed data, in model units, overlaid on the plots of its matching variables
+
+    ObservedData observedData;
+    std::vector<int> observedColumns;
+    std::vector<QCPGraph*> observedGraphs;
+
+    // Posterior predictive bands of the last calibration, lower, upper and median graphs per plot
+
+    PosteriorBands posteriorBands;
+    std::vector<QCPGraph*> posteriorGraphs;
+
+    // Quantile bands of the last Monte Carlo ensemble, outer and inner band edges and median per plot
+
+    EnsembleBands ensembleBands;
+    std::vector<QCPGraph*> ensembleGraphs;
+
+    int currentScenarioIndex;
+    int currentSnapshotIndex;
+
+    ScenarioModel(
+        int index,
+        QString modelName,
+        std::list<QString> variableShortNamesList,
+        std::list<QString> variableLongNamesList,
+        std::list<QString> parameterNamesList,
+        std::list<double> parameterMinList,
+        std::list<double> parameterMaxList,
+        std::list<double> parameterInitList,
+        std::list<double> initialConditionsList,
+        QWidget *parent = nullptr);
+
+    ScenarioModel(const ScenarioModel &model, QWidget *parent = nullptr);
+
+    ~ScenarioModel();
+
+    void connectPlots();
+
+    void setPlotsData();
+    void setGraphsOnAddScenario(int scenarioIndex);
+    void setGraphsOnRemoveScenario(int scenarioIndex);
+
+    void onTimeStartChanged(int scenarioIndex);
+    void onTimeEndChanged(int scenarioIndex);
+
+    void shiftTimeRanges(int scenarioIndex, double delta);
+
+    void updateTimeRangeMinMax();
+
+    void deleteScenarios();
+    void addScenario();
+    void removeScenario(int scenarioIndex);
+    void restoreScenarios(const std::vector<Scenario> &restoredScenarios, int scenarioIndex);
+
+    ExportSource getExportSource(const std::vector<Scenario> &exportedScenarios) const;
+    void exportData(const std::vector<Scenario> &exportedScenarios);
+    void exportAnimation();
+    void parameterSweep();
+
+    void importObservedData();
+    void setObservedPlotsData();
+    std::vector<double> modelTimes() const;
+
+    void fitObservedData();
+    void calibrateObservedData();
+    void setPosteriorPlotsData();
+
+    void runEnsemble();
+    void setEnsemblePlotsData();
+
+    void globalSensitivity();
+
+    void optimizeInterventions();
+
+signals:
+    void scenariosFitted();
+    void scenariosOptimized();
+
+private:
+    int imgWidth;
+    int imgHeight;
+
+    int animationFrames;
+    int animationFps;
+
+    double observedTimeOffset;
+    double observedTimeScale;
+    double observedPopulation;
+
+    bool observedDataDialog(const ObservedData &data);
+    bool sweepDialog(SweepSettings &settings);
+    bool fitDialog(FitSettings &settings);
+    bool fitResultDialog(const FitSettings &settings, const FitResult &result);
+    bool chainChangedSince(const std::vector<Scenario> &startScenarios) const;
+    bool samplerDialog(SamplerSettings &settings);
+    bool ensembleDialog(EnsembleSettings &settings);
+    bool globalSensitivityDialog(GlobalSensitivitySettings &settings);
+    void globalSensitivityResultDialog(const GlobalSensitivity &analysis);
+    bool interventionDialog(InterventionSettings &settings);
+    bool interventionResultDialog(const InterventionOptimizer &optimizer);
+
+    void constructPlots();
+    void constructGraphs();
+    void resizeSlots(int numScenarios);
+
+    void contextMenuRequest(int plotIndex, QPoint pos);
+    void savePlot(int plotIndex, int format, QPoint pos);
+
+    virtual void constructAdditionalPlots() = 0;
+    virtual void setAdditionalPlotsData() = 0;
+};
+
+#endif // SCENARIOMODEL_H
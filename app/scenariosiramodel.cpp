@@ -86,19 +86,16 @@ void ScenarioSIRAModel::setAdditionalPlotsData()
         fractions.push_back(f);
     }
 
-    int numGraphs = plots.back()->graphCount();
+    SeriesSlots &fractionSlots = plotSlots.back();
 
-    k = 0;
-
-    for (int j = 0; j < numGraphs - 2; j += 2)
+    for (k = 0; k < static_cast<int>(scenarios.size()) - 1; k++)
     {
-        plots.back()->graph(j)->setData(scenarios[k].abscissaLeft, fractionsLeft[k], true);
-        plots.back()->graph(j + 1)->setData(scenarios[k].abscissaRight, fractionsRight[k], true);
-
-        k++;
+        fractionSlots.solid(k)->setData(scenarios[k].abscissaLeft, fractionsLeft[k], true);
+        fractionSlots.dashed(k)->setData(scenarios[k].abscissaRight, fractionsRight[k], true);
     }
 
-    plots.back()->graph(numGraphs - 1)->setData(scenarios[k].abscissa, fractions, true);
+    fractionSlots.solid(k)->setData(scenarios[k].abscissa, fractions, true);
+    fractionSlots.dashed(k)->data()->clear();
 
     plots.back()->xAxis->rescale();
     plots.back()->replot();
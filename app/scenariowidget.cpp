@@ -17,25 +17,39 @@
 
 #include "scenariowidget.h"
 
-ScenarioWidget::ScenarioWidget(QWidget *parent): QWidget(parent)
+ScenarioWidget::ScenarioWidget(const SessionState *session, QWidget *parent): QWidget(parent)
 {
     // Models
 
-    models.push_back(new ScenarioGenericModel(0, "SIR", {"S", "I", "R"}, {"Susceptible", "Infected", "Recovered"}, {"P0"}, {0.0}, {20.0}, {2.5}, {1.0 - 1.0e-7, 1.0e-7, 0.0}));
-    models.push_back(new ScenarioGenericModel(1, "SIRS", {"S", "I", "R"}, {"Susceptible", "Infected", "Recovered"}, {"P0", "P1"}, {0.0, 0.0}, {20.0, 5.0}, {2.5, 0.1}, {1.0 - 1.0e-7, 1.0e-7, 0.0}));
-    models.push_back(new ScenarioGenericModel(2, "SEIR", {"S", "E", "I", "R"}, {"Susceptible", "Exposed", "Infected", "Recovered"}, {"P0", "P1"}, {0.0, 0.0}, {20.0, 5.0}, {2.5, 0.1}, {1.0 - 1.0e-7, 0.0, 1.0e-7, 0.0}));
-    models.push_back(new ScenarioGenericModel(3, "SEIRS", {"S", "E", "I", "R"}, {"Susceptible", "Exposed", "Infected", "Recovered"}, {"P0", "P1", "P2"}, {0.0, 0.0, 0.0}, {20.0, 5.0, 5.0}, {2.5, 0.1, 0.1}, {1.0 - 1.0e-7, 0.0, 1.0e-7, 0.0}));
-    models.push_back(new ScenarioSIRAModel(4, "SIRA", {"S", "I", "R", "A"}, {"Susceptible", "Infected", "Recovered", "Asymptomatic"}, {"P0", "P1", "P2"}, {0.0, 0.0, 0.0}, {20.0, 5.0, 5.0}, {2.5, 0.1, 0.1}, {1.0 - 2.0e-7, 1.0e-7, 0.0, 1.0e-7}));
-    models.push_back(new ScenarioGenericModel(5, "SIR + Vital dynamics", {"S", "I", "R"}, {"Susceptible", "Infected", "Recovered"}, {"P0", "P1"}, {0.0, 0.0}, {20.0, 5.0}, {2.5, 0.1}, {1.0 - 1.0e-7, 1.0e-7, 0.0}));
-    models.push_back(new ScenarioGenericModel(6, "SIRS + Vital dynamics", {"S", "I", "R"}, {"Susceptible", "Infected", "Recovered"}, {"P0", "P1", "P2"}, {0.0, 0.0, 0.0}, {20.0, 5.0, 5.0}, {2.5, 0.1, 0.1}, {1.0 - 1.0e-7, 1.0e-7, 0.0}));
-    models.push_back(new ScenarioGenericModel(7, "SEIR + Vital dynamics", {"S", "E", "I", "R"}, {"Susceptible", "Exposed", "Infected", "Recovered"}, {"P0", "P1", "P2"}, {0.0, 0.0, 0.0}, {20.0, 5.0, 5.0}, {2.5, 0.1, 0.1}, {1.0 - 1.0e-7, 0.0, 1.0e-7, 0.0}));
-    models.push_back(new ScenarioGenericModel(8, "SEIRS + Vital dynamics", {"S", "E", "I", "R"}, {"Susceptible", "Exposed", "Infected", "Recovered"}, {"P0", "P1", "P2", "P3"}, {0.0, 0.0, 0.0, 0.0}, {20.0, 5.0, 5.0, 5.0}, {2.5, 0.1, 0.1, 0.1}, {1.0 - 1.0e-7, 0.0, 1.0e-7, 0.0}));
+    for (const ModelDefinition &d : scenarioModelDefinitions())
+    {
+        if (d.index == 4) // SIRA model
+            models.push_back(new ScenarioSIRAModel(d.index, d.name, d.variableShortNames, d.variableLongNames, d.parameterNames, d.parameterMin, d.parameterMax, d.parameterInit, d.initialConditions));
+        else
+            models.push_back(new ScenarioGenericModel(d.index, d.name, d.variableShortNames, d.variableLongNames, d.parameterNames, d.parameterMin, d.parameterMax, d.parameterInit, d.initialConditions));
+    }
 
     currentModel = models[0];
 
     // Export scenarios data controls
 
     QPushButton* exportButton = new QPushButton("Export data");
+    QPushButton* exportAnimationButton = new QPushButton("Export animation");
+    QPushButton* importObservedButton = new QPushButton("Import observed data");
+    QPushButton* parameterSweepButton = new QPushButton("Parameter sweep");
+    QPushButton* fitObservedButton = new QPushButton("Fit to observed data");
+    QPushButton* calibrateButton = new QPushButton("Bayesian calibration");
+    QPushButton* ensembleButton = new QPushButton("Monte Carlo ensemble");
+    QPushButton* globalSensitivityButton = new QPushButton("Global sensitivity");
+    QPushButton* optimizeInterventionsButton = new QPushButton("Optimize interventions");
+
+    // Live feed of solved scenarios through shared memory, off by default
+
+    feedPublisher = new TrajectoryFeedPublisher;
+
+    liveFeedCheckBox = new QCheckBox("Publish live feed");
+    liveFeedCheckBox->setChecked(false);
+    liveFeedCheckBox->setToolTip(QString("Publish solved scenarios to shared memory \"%1\"").arg(feedPublisher->getKey()));
 
     // Model selection controls
 
@@ -59,6 +73,8 @@ ScenarioWidget::ScenarioWidget(QWidget *parent): QWidget(parent)
         snapshots.push_back(snapshotList);
     }
 
+    snapshotCache = new SnapshotCache;
+
     // Snapshot management controls
 
     QLabel *snapshotLabel = new QLabel("Snapshots");
@@ -73,6 +89,16 @@ ScenarioWidget::ScenarioWidget(QWidget *parent): QWidget(parent)
 
     snapshotComboBox = new QComboBox;
 
+    QLabel *snapshotBudgetLabel = new QLabel("Snapshots memory (MB)");
+
+    snapshotBudgetSpinBox = new QSpinBox;
+    snapshotBudgetSpinBox->setRange(1, 65536);
+    snapshotBudgetSpinBox->setValue(static_cast<int>(snapshotCache->getMemoryBudget() / (1024 * 1024)));
+
+    QHBoxLayout *snapshotBudgetHBoxLayout = new QHBoxLayout;
+    snapshotBudgetHBoxLayout->addWidget(snapshotBudgetLabel);
+    snapshotBudgetHBoxLayout->addWidget(snapshotBudgetSpinBox);
+
     // Scenario management controls
 
     QLabel *scenarioLabel = new QLabel("Scenarios");
@@ -130,11 +156,21 @@ ScenarioWidget::ScenarioWidget(QWidget *parent): QWidget(parent)
 
     QVBoxLayout *mainControlsVBoxLayout = new QVBoxLayout;
     mainControlsVBoxLayout->addWidget(exportButton);
+    mainControlsVBoxLayout->addWidget(exportAnimationButton);
+    mainControlsVBoxLayout->addWidget(importObservedButton);
+    mainControlsVBoxLayout->addWidget(parameterSweepButton);
+    mainControlsVBoxLayout->addWidget(fitObservedButton);
+    mainControlsVBoxLayout->addWidget(calibrateButton);
+    mainControlsVBoxLayout->addWidget(ensembleButton);
+    mainControlsVBoxLayout->addWidget(globalSensitivityButton);
+    mainControlsVBoxLayout->addWidget(optimizeInterventionsButton);
+    mainControlsVBoxLayout->addWidget(liveFeedCheckBox);
     mainControlsVBoxLayout->addWidget(modelLabel);
     mainControlsVBoxLayout->addWidget(modelComboBox);
     mainControlsVBoxLayout->addWidget(snapshotLabel);
     mainControlsVBoxLayout->addLayout(takeRemovePushButtonsHBoxLayout);
     mainControlsVBoxLayout->addWidget(snapshotComboBox);
+    mainControlsVBoxLayout->addLayout(snapshotBudgetHBoxLayout);
     mainControlsVBoxLayout->addWidget(scenarioLabel);
     mainControlsVBoxLayout->addLayout(addRemovePushButtonsHBoxLayout);
     mainControlsVBoxLayout->addWidget(scenarioComboBox);
@@ -154,6 +190,9 @@ ScenarioWidget::ScenarioWidget(QWidget *parent): QWidget(parent)
     plotsTabWidget = new QTabWidget;
     plotsTabWidget->setTabPosition(QTabWidget::North);
 
+    heatmapWidget = new HeatmapWidget;
+    sensitivityWidget = new SensitivityWidget;
+
     // Main grid layout
 
     QGridLayout *mainGridLayout = new QGridLayout;
@@ -164,7 +203,24 @@ ScenarioWidget::ScenarioWidget(QWidget *parent): QWidget(parent)
 
     // Signals + Slots
 
-    connect(exportButton, &QPushButton::clicked, [=](){ currentModel->exportData(); });
+    connect(exportButton, &QPushButton::clicked, this, &ScenarioWidget::exportData);
+    connect(exportAnimationButton, &QPushButton::clicked, [=](){ currentModel->exportAnimation(); });
+    connect(importObservedButton, &QPushButton::clicked, [=](){ currentModel->importObservedData(); });
+    connect(parameterSweepButton, &QPushButton::clicked, [=](){ currentModel->parameterSweep(); });
+    connect(fitObservedButton, &QPushButton::clicked, [=](){ currentModel->fitObservedData(); });
+    connect(calibrateButton, &QPushButton::clicked, [=](){ currentModel->calibrateObservedData(); });
+    connect(ensembleButton, &QPushButton::clicked, [=](){ currentModel->runEnsemble(); });
+    connect(globalSensitivityButton, &QPushButton::clicked, [=](){ currentModel->globalSensitivity(); });
+    connect(optimizeInterventionsButton, &QPushButton::clicked, [=](){ currentModel->optimizeInterventions(); });
+
+    for (size_t i = 0; i < models.size(); i++)
+    {
+        ScenarioModel *model = models[i];
+        connect(model, &ScenarioModel::scenariosFitted, [=](){ onScenariosReplaced(model); });
+        connect(model, &ScenarioModel::scenariosOptimized, [=](){ onScenariosReplaced(model); });
+    }
+
+    connect(liveFeedCheckBox, &QCheckBox::toggled, this, &ScenarioWidget::setLiveFeed);
     connect(modelComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged), [=](int modelIndex){ currentModel = models[modelIndex]; });
     connect(modelComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged), [=](int modelIndex){ Q_UNUSED(modelIndex) constructInitialConditionsControls(); });
     connect(modelComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged), [=](int modelIndex){ Q_UNUSED(modelIndex) constructParameterControls(); });
@@ -172,9 +228,16 @@ ScenarioWidget::ScenarioWidget(QWidget *parent): QWidget(parent)
     connect(modelComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged), [=](int modelIndex){ Q_UNUSED(modelIndex) updateScenarioComboBox(); });
     connect(modelComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged), [=](int modelIndex){ Q_UNUSED(modelIndex) updateScenarioControls(); updateInitialConditionsControls(); });
     connect(modelComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged), [=](int modelIndex){ updateSnapshotWidgets(modelIndex); });
+    connect(modelComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged), [=](int modelIndex){ Q_UNUSED(modelIndex) publishFeed(); });
+    connect(modelComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged), [=](int modelIndex){ Q_UNUSED(modelIndex) heatmapWidget->setModel(currentModel); });
+    connect(modelComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged), [=](int modelIndex){ Q_UNUSED(modelIndex) sensitivityWidget->setModel(currentModel); });
     connect(takeSnapshotPushButton, &QPushButton::clicked, this, &ScenarioWidget::takeSnapshot);
     connect(removeSnapshotPushButton, &QPushButton::clicked, this, &ScenarioWidget::removeSnapshot);
     connect(snapshotComboBox, QOverload<int>::of(&QComboBox::activated), [=](int snapshotIndex){ selectSnapshot(snapshotIndex);});
+    connect(snapshotBudgetSpinBox, QOverload<int>::of(&QSpinBox::valueChanged), [=](int megabytes){
+        snapshotCache->setMemoryBudget(static_cast<size_t>(megabytes) * 1024 * 1024);
+        snapshotCache->enforceBudget(snapshots);
+    });
     connect(scenarioComboBox, QOverload<int>::of(&QComboBox::activated), [=](int scenarioIndex){ selectScenario(scenarioIndex); });
     connect(addScenarioPushButton, &QPushButton::clicked, this, &ScenarioWidget::addScenario);
     connect(removeScenarioPushButton, &QPushButton::clicked, this, &ScenarioWidget::removeScenario);
@@ -188,12 +251,40 @@ ScenarioWidget::ScenarioWidget(QWidget *parent): QWidget(parent)
 
     constructInitialConditionsControls();
     constructParameterControls();
-    addInitialScenarios();
+
+    bool restored = session != nullptr && sessionMatches(*session);
+
+    if (restored)
+    {
+        restoreSession(*session);
+    }
+    else
+    {
+        addInitialScenarios();
+    }
 
     // Set plot tabs
 
     setPlotTabs();
 
+    heatmapWidget->setModel(currentModel);
+    sensitivityWidget->setModel(currentModel);
+
+    if (restored)
+    {
+        if (session->scenarioModelIndex > 0)
+        {
+            modelComboBox->setCurrentIndex(session->scenarioModelIndex);
+        }
+        else
+        {
+            updateScenarioComboBox();
+            updateScenarioControls();
+            updateInitialConditionsControls();
+            updateSnapshotWidgets(0);
+        }
+    }
+
     // Set main layout
 
     setLayout(mainGridLayout);
@@ -201,6 +292,22 @@ ScenarioWidget::ScenarioWidget(QWidget *parent): QWidget(parent)
 
 ScenarioWidget::~ScenarioWidget()
 {
+    for (size_t i = 0; i < snapshots.size(); i++)
+    {
+        for (Snapshot *snapshot : snapshots[i])
+        {
+            delete snapshot;
+        }
+
+        snapshots[i].clear();
+    }
+
+    delete snapshotCache;
+    snapshotCache = nullptr;
+
+    delete feedPublisher;
+    feedPublisher = nullptr;
+
     for (size_t i = 0; i < models.size(); i++)
     {
         delete models[i];
@@ -210,6 +317,59 @@ ScenarioWidget::~ScenarioWidget()
     models.clear();
 }
 
+QStringList ScenarioWidget::addPlotsToExporter(BatchExporter &exporter)
+{
+    QStringList failedSnapshots;
+
+    for (size_t modelIndex = 0; modelIndex < models.size(); modelIndex++)
+    {
+        ScenarioModel *model = models[modelIndex];
+
+        // Plots shown in the grid are the same as the ones shown in separate tabs
+
+        for (size_t i = model->dimension; i < model->plots.size(); i++)
+        {
+            exporter.addPlot(model->plots[i], model->name + " " + model->plotNames[i - model->dimension]);
+        }
+
+        exporter.addPlot(model->allVariablesPlot, model->name + " All");
+
+        // Snapshots are exported one at a time, hidden ones are released right after being
+        // recorded so that the snapshot cache budget holds
+
+        int snapshotIndex = 0;
+
+        for (Snapshot *snapshot : snapshots[modelIndex])
+        {
+            QString snapshotName = model->name + QString(" Snapshot %1").arg(snapshotIndex + 1);
+
+            bool shown = snapshot->hasPlots() && plotsTabWidget->indexOf(snapshot->getPlotsGridWidget()) != -1;
+
+            std::vector<QCustomPlot*> snapshotPlots = snapshot->getPlots();
+
+            if (snapshotPlots.empty())
+            {
+                failedSnapshots.append(snapshotName);
+            }
+
+            for (size_t i = 0; i < snapshotPlots.size(); i++)
+            {
+                exporter.addPlot(snapshotPlots[i], snapshotName + " " + model->plotNames[i]);
+            }
+
+            if (!shown)
+            {
+                snapshot->releasePlots();
+                snapshotCache->enforceBudget(snapshots);
+            }
+
+            snapshotIndex++;
+        }
+    }
+
+    return failedSnapshots;
+}
+
 void ScenarioWidget::deleteParameterControls()
 {
     for (size_t i = 0; i < parameterLineEdit.size(); i++)
@@ -368,6 +528,9 @@ void ScenarioWidget::setPlotTabs()
     {
         plotsTabWidget->addTab(currentModel->plots[i], currentModel->plotNames[i - currentModel->dimension]);
     }
+
+    plotsTabWidget->addTab(sensitivityWidget, "Sensitivity");
+    plotsTabWidget->addTab(heatmapWidget, "Heatmap");
 }
 
 void ScenarioWidget::updateScenarioComboBox()
@@ -404,6 +567,111 @@ void ScenarioWidget::addInitialScenarios()
     }
 }
 
+bool ScenarioWidget::sessionMatches(const SessionState &state) const
+{
+    if (state.scenarioModels.size() != models.size() || state.scenarioModelIndex < 0 || state.scenarioModelIndex >= static_cast<int>(models.size()))
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < models.size(); i++)
+    {
+        const ScenarioModelState &modelState = state.scenarioModels[i];
+        const ScenarioModel *model = models[i];
+
+        if (modelState.modelIndex != model->modelIndex || modelState.scenarios.empty())
+        {
+            return false;
+        }
+
+        if (modelState.currentScenarioIndex < 0 || modelState.currentScenarioIndex >= static_cast<int>(modelState.scenarios.size()))
+        {
+            return false;
+        }
+
+        if (modelState.currentSnapshotIndex >= static_cast<int>(modelState.snapshotScenarios.size()))
+        {
+            return false;
+        }
+
+        if (!modelState.snapshotScenarios.empty() && modelState.currentSnapshotIndex < 0)
+        {
+            return false;
+        }
+
+        for (const Scenario &scenario : modelState.scenarios)
+        {
+            if (static_cast<int>(scenario.x0.size()) != model->dimension || static_cast<int>(scenario.parameters.size()) != model->numParameters)
+            {
+                return false;
+            }
+
+            if (!scenario.trajectory || scenario.trajectory->steps.empty() || static_cast<int>(scenario.trajectory->steps[0].size()) != model->dimension)
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+void ScenarioWidget::restoreSession(const SessionState &state)
+{
+    // Solved trajectories come from the session, nothing is integrated
+
+    for (size_t i = 0; i < models.size(); i++)
+    {
+        const ScenarioModelState &modelState = state.scenarioModels[i];
+        ScenarioModel *model = models[i];
+
+        model->restoreScenarios(modelState.scenarios, modelState.currentScenarioIndex);
+        model->currentSnapshotIndex = modelState.currentSnapshotIndex;
+
+        for (size_t j = 0; j < modelState.snapshotScenarios.size(); j++)
+        {
+            snapshots[i].push_back(new Snapshot(model, modelState.snapshotScenarios[j], modelState.snapshotTrajectories[j]));
+        }
+    }
+
+    currentModel = models[0];
+}
+
+void ScenarioWidget::getSessionState(SessionState &state) const
+{
+    state.scenarioModelIndex = modelComboBox->currentIndex();
+    state.scenarioModels.clear();
+
+    for (size_t i = 0; i < models.size(); i++)
+    {
+        ScenarioModelState modelState;
+        modelState.modelIndex = models[i]->modelIndex;
+        modelState.currentScenarioIndex = models[i]->currentScenarioIndex;
+        modelState.currentSnapshotIndex = models[i]->currentSnapshotIndex;
+        modelState.scenarios = models[i]->scenarios;
+
+        for (size_t j = 0; j < modelState.scenarios.size(); j++)
+        {
+            modelState.scenarios[j].clearAbscissaOrdinate();
+        }
+
+        // Snapshots whose trajectories cannot be read back are left out
+
+        for (const Snapshot *snapshot : snapshots[i])
+        {
+            std::vector<unsigned char> encoded;
+
+            if (snapshot->getEncodedTrajectories(encoded))
+            {
+                modelState.snapshotScenarios.push_back(snapshot->getScenarioSettings());
+                modelState.snapshotTrajectories.push_back(encoded);
+            }
+        }
+
+        state.scenarioModels.push_back(modelState);
+    }
+}
+
 void ScenarioWidget::selectScenario(int scenarioIndex)
 {
     if (scenarioIndex == 0)
@@ -706,6 +974,31 @@ void ScenarioWidget::updateSumInitialConditionsLabel()
     sumInitialConditionsLabel->repaint();
 }
 
+void ScenarioWidget::exportData()
+{
+    // Export the snapshot if its tab is shown, otherwise the current scenarios
+
+    int modelIndex = modelComboBox->currentIndex();
+    int snapshotIndex = currentModel->currentSnapshotIndex;
+
+    if (plotsTabWidget->tabText(plotsTabWidget->currentIndex()) == "Snapshot" && snapshotIndex >= 0 && snapshotIndex < static_cast<int>(snapshots[modelIndex].size()))
+    {
+        auto it = std::next(snapshots[modelIndex].begin(), snapshotIndex);
+
+        if (!(*it)->decompress())
+        {
+            QMessageBox::warning(this, "Export", "The trajectories of this snapshot could not be read back.");
+            return;
+        }
+
+        currentModel->exportData((*it)->getScenarios());
+    }
+    else
+    {
+        currentModel->exportData(currentModel->scenarios);
+    }
+}
+
 void ScenarioWidget::takeSnapshot()
 {
     int modelIndex = modelComboBox->currentIndex();
@@ -728,9 +1021,7 @@ void ScenarioWidget::selectSnapshot(int snapshotIndex)
 {
     updateSnapshotTab(snapshotIndex);
 
-    int snapshotTabIndex = plotsTabWidget->count() - 1;
-
-    plotsTabWidget->setCurrentIndex(snapshotTabIndex);
+    plotsTabWidget->setCurrentIndex(snapshotTabIndex());
 
     currentModel->currentSnapshotIndex = snapshotIndex;
 }
@@ -738,31 +1029,54 @@ void ScenarioWidget::selectSnapshot(int snapshotIndex)
 void ScenarioWidget::updateSnapshotTab(int snapshotIndex)
 {
     int modelIndex = modelComboBox->currentIndex();
-    int snapshotTabIndex = plotsTabWidget->count() - 1;
+    int tabIndex = snapshotTabIndex();
     int plotsTabWidgetIndex = plotsTabWidget->currentIndex();
 
-    if (snapshots[modelIndex].size() > 1)
+    // Replace the snapshot tab, if shown
+
+    if (tabIndex >= 0)
     {
-        plotsTabWidget->removeTab(snapshotTabIndex);
+        plotsTabWidget->removeTab(tabIndex);
     }
 
     auto it = std::next(snapshots[modelIndex].begin(), snapshotIndex);
-    plotsTabWidget->addTab((*it)->plotsGridWidget, "Snapshot");
+    plotsTabWidget->addTab((*it)->getPlotsGridWidget(), "Snapshot");
 
     plotsTabWidget->setCurrentIndex(plotsTabWidgetIndex);
+
+    releaseHiddenSnapshots();
+}
+
+int ScenarioWidget::snapshotTabIndex() const
+{
+    // The tabs before the snapshot tab depend on the model, so it is found by its text
+
+    for (int i = 0; i < plotsTabWidget->count(); i++)
+    {
+        if (plotsTabWidget->tabText(i) == "Snapshot")
+        {
+            return i;
+        }
+    }
+
+    return -1;
 }
 
 void ScenarioWidget::removeSnapshot()
 {
     int modelIndex = modelComboBox->currentIndex();
-    int snapshotTabIndex = plotsTabWidget->count() - 1;
+    int tabIndex = snapshotTabIndex();
     int plotsTabWidgetIndex = plotsTabWidget->currentIndex();
     int snapshotIndex = snapshotComboBox->currentIndex();
 
-    plotsTabWidget->removeTab(snapshotTabIndex);
+    if (tabIndex >= 0)
+    {
+        plotsTabWidget->removeTab(tabIndex);
+    }
 
     std::list<Snapshot*>::iterator it = snapshots[modelIndex].begin();
     std::advance(it, snapshotIndex);
+    delete *it;
     snapshots[modelIndex].erase(it);
 
     snapshotComboBox->removeItem(snapshotIndex);
@@ -775,7 +1089,7 @@ void ScenarioWidget::removeSnapshot()
     if (snapshots[modelIndex].size() > 0)
     {
         auto it = std::next(snapshots[modelIndex].begin(), snapshotComboBox->currentIndex());
-        plotsTabWidget->addTab((*it)->plotsGridWidget, "Snapshot");
+        plotsTabWidget->addTab((*it)->getPlotsGridWidget(), "Snapshot");
 
         plotsTabWidget->setCurrentIndex(plotsTabWidgetIndex);
     }
@@ -783,7 +1097,7 @@ void ScenarioWidget::removeSnapshot()
     {
         removeSnapshotPushButton->setEnabled(false);
 
-        if (plotsTabWidgetIndex == snapshotTabIndex)
+        if (plotsTabWidgetIndex == tabIndex)
         {
             plotsTabWidget->setCurrentIndex(0);
         }
@@ -817,95 +1131,117 @@ void ScenarioWidget::updateSnapshotWidgets(int modelIndex)
     }
     else
     {
-        int snapshotTabIndex = 2 + currentModel->plots.size() - models[modelIndex]->dimension;
-
-        QWidget *widget = plotsTabWidget->widget(snapshotTabIndex);
+        int tabIndex = snapshotTabIndex();
 
-        if (widget != nullptr)
+        if (tabIndex >= 0)
         {
-            plotsTabWidget->removeTab(snapshotTabIndex);
+            plotsTabWidget->removeTab(tabIndex);
         }
 
         removeSnapshotPushButton->setEnabled(false);
     }
+
+    releaseHiddenSnapshots();
 }
 
-void ScenarioWidget::integrate(ScenarioModel *model, bool interpolation)
+void ScenarioWidget::releaseHiddenSnapshots()
 {
-    using namespace boost::numeric::odeint;
+    // Free the plots of snapshots not shown in any tab
 
-    typedef runge_kutta_dopri5<state_type> error_stepper_type;
+    for (size_t i = 0; i < snapshots.size(); i++)
+    {
+        for (Snapshot *snapshot : snapshots[i])
+        {
+            if (snapshot->hasPlots() && plotsTabWidget->indexOf(snapshot->getPlotsGridWidget()) == -1)
+            {
+                snapshot->releasePlots();
+            }
+        }
+    }
 
+    snapshotCache->enforceBudget(snapshots);
+}
+
+void ScenarioWidget::integrate(ScenarioModel *model, bool interpolation, bool wholeChain)
+{
     int scenarioIndex = scenarioComboBox->currentIndex();
 
-    if (shiftTimeRangesCheckbox->isChecked())
+    if (shiftTimeRangesCheckbox->isChecked() || wholeChain)
     {
         scenarioIndex = 0;
     }
 
-    for (size_t i = scenarioIndex; i < model->scenarios.size(); i++)
+    integrateScenarios(model->modelIndex, model->scenarios, scenarioIndex, interpolation);
+
+    updateInitialConditionsControls();
+
+    model->setPlotsData();
+
+    if (model == currentModel)
     {
-        Scenario *scenario = &model->scenarios[i];
+        publishFeed();
+        heatmapWidget->setModel(model);
+        sensitivityWidget->setModel(model);
+    }
 
-        if (interpolation && i > 0)
-        {
-            scenario->interpolateX0(model->scenarios[i - 1]);
-        }
+    // Snapshots may now be the only owners of the previous trajectories
 
-        interpolation = true;
+    snapshotCache->enforceBudget(snapshots);
+}
 
-        scenario->x = scenario->x0;
-        scenario->steps.clear();
-        scenario->times.clear();
+void ScenarioWidget::onScenariosReplaced(ScenarioModel *model)
+{
+    // Fitted or optimized values are shown without passing through the sliders, which would round them
 
-        if (model->modelIndex == 0) // SIR model
-        {
-            SIR sir(scenario->parameters);
-            integrate_adaptive(make_controlled<error_stepper_type>(1.0e-10, 1.0e-6), sir, scenario->x, scenario->timeStart, scenario->timeEnd, 0.01, push_back_state_and_time(scenario->steps, scenario->times));
-        }
-        else if (model->modelIndex == 1) // SIRS model
-        {
-            SIRS sirs(scenario->parameters);
-            integrate_adaptive(make_controlled<error_stepper_type>(1.0e-10, 1.0e-6), sirs, scenario->x, scenario->timeStart, scenario->timeEnd, 0.01, push_back_state_and_time(scenario->steps, scenario->times));
-        }
-        else if (model->modelIndex == 2) // SEIR model
-        {
-            SEIR seir(scenario->parameters);
-            integrate_adaptive(make_controlled<error_stepper_type>(1.0e-10, 1.0e-6), seir, scenario->x, scenario->timeStart, scenario->timeEnd, 0.01, push_back_state_and_time(scenario->steps, scenario->times));
-        }
-        else if (model->modelIndex == 3) // SEIRS model
-        {
-            SEIRS seirs(scenario->parameters);
-            integrate_adaptive(make_controlled<error_stepper_type>(1.0e-10, 1.0e-6), seirs, scenario->x, scenario->timeStart, scenario->timeEnd, 0.01, push_back_state_and_time(scenario->steps, scenario->times));
-        }
-        else if (model->modelIndex == 4) // SIRA model
-        {
-            SIRA sira(scenario->parameters);
-            integrate_adaptive(make_controlled<error_stepper_type>(1.0e-10, 1.0e-6), sira, scenario->x, scenario->timeStart, scenario->timeEnd, 0.01, push_back_state_and_time(scenario->steps, scenario->times));
-        }
-        else if (model->modelIndex == 5) // SIR + Vital dynamics model
-        {
-            SIRVitalDynamics sirVitalDynamics(scenario->parameters);
-            integrate_adaptive(make_controlled<error_stepper_type>(1.0e-10, 1.0e-6), sirVitalDynamics, scenario->x, scenario->timeStart, scenario->timeEnd, 0.01, push_back_state_and_time(scenario->steps, scenario->times));
-        }
-        else if (model->modelIndex == 6) // SIRS + Vital dynamics model
-        {
-            SIRSVitalDynamics sirsVitalDynamics(scenario->parameters);
-            integrate_adaptive(make_controlled<error_stepper_type>(1.0e-10, 1.0e-6), sirsVitalDynamics, scenario->x, scenario->timeStart, scenario->timeEnd, 0.01, push_back_state_and_time(scenario->steps, scenario->times));
-        }
-        else if (model->modelIndex == 7) // SEIR + Vital dynamics model
-        {
-            SEIRVitalDynamics seirVitalDynamics(scenario->parameters);
-            integrate_adaptive(make_controlled<error_stepper_type>(1.0e-10, 1.0e-6), seirVitalDynamics, scenario->x, scenario->timeStart, scenario->timeEnd, 0.01, push_back_state_and_time(scenario->steps, scenario->times));
-        }
-        else if (model->modelIndex == 8) // SEIRS + Vital dynamics model
-        {
-            SEIRSVitalDynamics seirsVitalDynamics(scenario->parameters);
-            integrate_adaptive(make_controlled<error_stepper_type>(1.0e-10, 1.0e-6), seirsVitalDynamics, scenario->x, scenario->timeStart, scenario->timeEnd, 0.01, push_back_state_and_time(scenario->steps, scenario->times));
-        }
+    if (model == currentModel)
+    {
+        for (size_t i = 0; i < parameterSlider.size(); i++)
+            parameterSlider[i]->blockSignals(true);
+
+        updateTimeStartControls();
+        updateTimeEndControls();
+        updateValidators();
+        updateParameterControls();
+
+        for (size_t i = 0; i < parameterSlider.size(); i++)
+            parameterSlider[i]->blockSignals(false);
     }
 
-    updateInitialConditionsControls();
+    // Every scenario may have changed
 
-    model->setPlotsData();
+    integrate(model, false, true);
+}
+
+void ScenarioWidget::setLiveFeed(bool enabled)
+{
+    if (!enabled)
+    {
+        feedPublisher->stop();
+        return;
+    }
+
+    if (!feedPublisher->start())
+    {
+        QMessageBox::warning(this, "Live feed", QString("Could not create shared memory \"%1\": %2").arg(feedPublisher->getKey(), feedPublisher->errorString()));
+
+        QSignalBlocker blocker(liveFeedCheckBox);
+        liveFeedCheckBox->setChecked(false);
+
+        return;
+    }
+
+    publishFeed();
+}
+
+void ScenarioWidget::publishFeed()
+{
+    if (!feedPublisher->isActive())
+        return;
+
+    if (!feedPublisher->publish(currentModel->getExportSource(currentModel->scenarios)))
+    {
+        // Keep the feed running, later chains may fit again
+
+        qWarning("Live feed: %s", qPrintable(feedPublisher->errorString()));
+    }
 }
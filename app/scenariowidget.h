@@ -18,18 +18,23 @@
 #ifndef SCENARIOWIDGET_H
 #define SCENARIOWIDGET_H
 
-#include "models.h"
+#include "modelcatalog.h"
+#include "scenariointegrator.h"
 #include "scenariogenericmodel.h"
 #include "scenariosiramodel.h"
 #include "snapshot.h"
+#include "snapshotcache.h"
+#include "batchexporter.h"
 #include "customvalidator.h"
+#include "session.h"
+#include "trajectoryfeed.h"
+#include "heatmapwidget.h"
+#include "sensitivitywidget.h"
 #include <vector>
 #include <list>
 #include <iterator>
-#ifndef Q_MOC_RUN
-#include <boost/numeric/odeint.hpp>
-#endif
 #include <QWidget>
+#include <QStringList>
 #include <QLabel>
 #include <QComboBox>
 #include <QPushButton>
@@ -41,30 +46,39 @@
 #include <QSlider>
 #include <QGridLayout>
 #include <QCheckBox>
+#include <QSpinBox>
 
 class ScenarioWidget: public QWidget
 {
     Q_OBJECT
 
 public:
-    explicit ScenarioWidget(QWidget *parent = nullptr);
+    explicit ScenarioWidget(const SessionState *session = nullptr, QWidget *parent = nullptr);
     ~ScenarioWidget();
 
+    QStringList addPlotsToExporter(BatchExporter &exporter);
+    void getSessionState(SessionState &state) const;
+
 private:
     ScenarioModel *currentModel;
     std::vector<ScenarioModel*> models;
     std::vector<std::list<Snapshot*>> snapshots;
+    SnapshotCache *snapshotCache;
+    TrajectoryFeedPublisher *feedPublisher;
 
     QComboBox *modelComboBox;
 
     QPushButton *takeSnapshotPushButton;
     QPushButton *removeSnapshotPushButton;
     QComboBox *snapshotComboBox;
+    QSpinBox *snapshotBudgetSpinBox;
 
     QPushButton *addScenarioPushButton;
     QPushButton *removeScenarioPushButton;
     QComboBox *scenarioComboBox;
 
+    QCheckBox *liveFeedCheckBox;
+
     QCheckBox *shiftTimeRangesCheckbox;
     //CustomValidator *timeStartDoubleValidator;
     //CustomValidator *timeEndDoubleValidator;
@@ -84,6 +98,8 @@ private:
     std::vector<QSlider*> parameterSlider;
 
     QTabWidget *plotsTabWidget;
+    HeatmapWidget *heatmapWidget;
+    SensitivityWidget *sensitivityWidget;
 
     void onTimeStartLineEditReturnPressed();
     void onTimeEndLineEditReturnPressed();
@@ -116,17 +132,26 @@ private:
     void updateTimeRangeMinMax(bool shift);
 
     void addInitialScenarios();
+    bool sessionMatches(const SessionState &state) const;
+    void restoreSession(const SessionState &state);
     void selectScenario(int index);
     void addScenario();
     void removeScenario();
 
+    void exportData();
+
     void takeSnapshot();
     void selectSnapshot(int snapshotIndex);
     void updateSnapshotTab(int snapshotIndex);
+    int snapshotTabIndex() const;
     void removeSnapshot();
     void updateSnapshotWidgets(int modelIndex);
+    void releaseHiddenSnapshots();
 
-    void integrate(ScenarioModel *model, bool interpolation);
+    void integrate(ScenarioModel *model, bool interpolation, bool wholeChain = false);
+    void onScenariosReplaced(ScenarioModel *model);
+    void setLiveFeed(bool enabled);
+    void publishFeed();
 };
 
 #endif // SCENARIOWIDGET_H
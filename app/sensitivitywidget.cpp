@@ -0,0 +1,188 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "sensitivitywidget.h"
+#include "modelcatalog.h"
+
+SensitivityWidget::SensitivityWidget(QWidget *parent): QWidget(parent)
+{
+    modelIndex = -1;
+    pending = false;
+
+    // Controls
+
+    variableComboBox = new QComboBox;
+
+    peakLabel = new QLabel;
+
+    QHBoxLayout *controlsHBoxLayout = new QHBoxLayout;
+    controlsHBoxLayout->addWidget(new QLabel("Variable"));
+    controlsHBoxLayout->addWidget(variableComboBox);
+    controlsHBoxLayout->addStretch();
+    controlsHBoxLayout->addWidget(peakLabel);
+
+    // Plot
+
+    plot = new QCustomPlot;
+
+    plot->setInteractions(QCP::iRangeZoom | QCP::iRangeDrag);
+    plot->axisRect()->setupFullAxesBox(true);
+    plot->xAxis->setLabel("Time");
+    plot->legend->setVisible(true);
+
+    QVBoxLayout *mainVBoxLayout = new QVBoxLayout;
+    mainVBoxLayout->addLayout(controlsHBoxLayout);
+    mainVBoxLayout->addWidget(plot);
+
+    setLayout(mainVBoxLayout);
+
+    // Signals + Slots
+
+    connect(variableComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged), [=](int){ setPlotData(); });
+}
+
+void SensitivityWidget::setModel(const ScenarioModel *model)
+{
+    if (model->modelIndex != modelIndex)
+    {
+        modelIndex = model->modelIndex;
+
+        parameterNames.clear();
+
+        for (int i = 0; i < model->numParameters; i++)
+            parameterNames.push_back(model->parameterNames[i]->text());
+
+        variableComboBox->blockSignals(true);
+        variableComboBox->clear();
+
+        for (int i = 0; i < model->dimension; i++)
+            variableComboBox->addItem(model->variableLongNames[i]->text());
+
+        variableComboBox->setCurrentIndex(0);
+        variableComboBox->blockSignals(false);
+    }
+
+    scenarios = model->scenarios;
+    trajectory.reset();
+
+    // Only computed while shown
+
+    if (!isVisible())
+    {
+        pending = true;
+        return;
+    }
+
+    compute();
+}
+
+void SensitivityWidget::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+
+    if (pending)
+        compute();
+}
+
+void SensitivityWidget::compute()
+{
+    pending = false;
+
+    if (scenarios.empty())
+        return;
+
+    trajectory = integrateSensitivities(modelIndex, scenarios);
+
+    setPlotData();
+    setPeakLabel();
+}
+
+void SensitivityWidget::setPlotData()
+{
+    plot->clearGraphs();
+
+    int variable = variableComboBox->currentIndex();
+
+    if (!trajectory || variable < 0)
+    {
+        plot->replot();
+        return;
+    }
+
+    int dimension = trajectory->dimension;
+    int numSteps = static_cast<int>(trajectory->times.size());
+
+    QVector<double> times(numSteps);
+
+    for (int n = 0; n < numSteps; n++)
+        times[n] = trajectory->times[n];
+
+    // One graph per parameter
+
+    for (int k = 0; k < trajectory->numParameters; k++)
+    {
+        QVector<double> values(numSteps);
+
+        for (int n = 0; n < numSteps; n++)
+            values[n] = trajectory->steps[n][dimension * (k + 1) + variable];
+
+        QCPGraph *graph = plot->addGraph();
+        graph->setData(times, values, true);
+        graph->setName(parameterNames[k]);
+        graph->setPen(QPen(QColor::fromHsv(k * 360 / trajectory->numParameters, 255, 200), 2));
+    }
+
+    plot->yAxis->setLabel(QString("d%1 / dP").arg(variableComboBox->currentText()));
+    plot->rescaleAxes();
+    plot->replot();
+}
+
+void SensitivityWidget::setPeakLabel()
+{
+    // Infected compartment, with the asymptomatic one in the SIRA model
+
+    const ModelDefinition &definition = scenarioModelDefinitions()[modelIndex];
+
+    int infectedIndex = definition.infectedIndex;
+    int asymptomaticIndex = definition.asymptomaticIndex;
+
+    int dimension = trajectory->dimension;
+
+    auto infected = [&](const state_type &z, int block){
+        double value = z[dimension * block + infectedIndex];
+        if (asymptomaticIndex >= 0) value += z[dimension * block + asymptomaticIndex];
+        return value;
+    };
+
+    size_t peak = 0;
+
+    for (size_t n = 1; n < trajectory->steps.size(); n++)
+    {
+        if (infected(trajectory->steps[n], 0) > infected(trajectory->steps[peak], 0))
+            peak = n;
+    }
+
+    // The infected curve is flat at its peak, so the derivative of the peak value is that of the curve there
+
+    QStringList derivatives;
+
+    for (int k = 0; k < trajectory->numParameters; k++)
+        derivatives.append(QString("%1: %2").arg(parameterNames[k]).arg(infected(trajectory->steps[peak], k + 1), 0, 'g', 4));
+
+    peakLabel->setText("Peak infected derivatives  " + derivatives.join("  "));
+}
@@ -0,0 +1,65 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#ifndef SENSITIVITYWIDGET_H
+#define SENSITIVITYWIDGET_H
+
+#include "scenariomodel.h"
+#include "sensitivity.h"
+#include "qcustomplot.h"
+#include <memory>
+#include <vector>
+#include <QWidget>
+#include <QComboBox>
+#include <QLabel>
+
+// Derivatives of a variable of the current scenario model with respect to each parameter
+// over the whole scenario chain, together with those of the infected peak
+// Computed with one augmented solve, only while shown
+
+class SensitivityWidget: public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit SensitivityWidget(QWidget *parent = nullptr);
+
+    void setModel(const ScenarioModel *model);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+
+private:
+    QComboBox *variableComboBox;
+    QLabel *peakLabel;
+
+    QCustomPlot *plot;
+
+    int modelIndex;
+    std::vector<Scenario> scenarios;
+    std::vector<QString> parameterNames;
+
+    std::shared_ptr<SensitivityTrajectory> trajectory;
+    bool pending;
+
+    void compute();
+    void setPlotData();
+    void setPeakLabel();
+};
+
+#endif // SENSITIVITYWIDGET_H
@@ -0,0 +1,122 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "seriesslots.h"
+
+static const Qt::GlobalColor colors[14] = {
+    Qt::black,
+    Qt::red,
+    Qt::green,
+    Qt::blue,
+    Qt::darkRed,
+    Qt::darkGreen,
+    Qt::darkBlue,
+    Qt::magenta,
+    Qt::yellow,
+    Qt::cyan,
+    Qt::darkMagenta,
+    Qt::darkYellow,
+    Qt::darkCyan,
+    Qt::darkGray
+};
+
+SeriesSlots::SeriesSlots(QCustomPlot *plot, bool continuation): plot(plot), continuation(continuation){}
+
+void SeriesSlots::resize(int numScenarios)
+{
+    // Release slots of removed scenarios, from last to first
+
+    while (size() > numScenarios)
+    {
+        releaseGraph(solidGraphs.back());
+        solidGraphs.pop_back();
+
+        if (continuation)
+        {
+            releaseGraph(dashedGraphs.back());
+            dashedGraphs.pop_back();
+        }
+    }
+
+    // Acquire slots of added scenarios
+
+    while (size() < numScenarios)
+    {
+        int scenarioIndex = size();
+
+        QPen pen = QPen(color(scenarioIndex));
+        pen.setStyle(Qt::SolidLine);
+        pen.setWidth(3);
+
+        solidGraphs.push_back(acquireGraph(pen));
+
+        if (continuation)
+        {
+            pen.setStyle(Qt::DashLine);
+            pen.setWidth(1);
+
+            dashedGraphs.push_back(acquireGraph(pen));
+        }
+    }
+}
+
+int SeriesSlots::size() const
+{
+    return static_cast<int>(solidGraphs.size());
+}
+
+QCPGraph *SeriesSlots::solid(int scenarioIndex) const
+{
+    return solidGraphs[scenarioIndex];
+}
+
+QCPGraph *SeriesSlots::dashed(int scenarioIndex) const
+{
+    return continuation ? dashedGraphs[scenarioIndex] : nullptr;
+}
+
+QColor SeriesSlots::color(int scenarioIndex)
+{
+    return QColor(colors[scenarioIndex % 14]);
+}
+
+QCPGraph *SeriesSlots::acquireGraph(const QPen &pen)
+{
+    QCPGraph *graph;
+
+    if (pool.empty())
+    {
+        graph = plot->addGraph();
+    }
+    else
+    {
+        graph = pool.back();
+        pool.pop_back();
+        graph->setVisible(true);
+    }
+
+    graph->setPen(pen);
+
+    return graph;
+}
+
+void SeriesSlots::releaseGraph(QCPGraph *graph)
+{
+    graph->data()->clear();
+    graph->setVisible(false);
+    pool.push_back(graph);
+}
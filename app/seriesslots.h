@@ -0,0 +1,54 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef SERIESSLOTS_H
+#define SERIESSLOTS_H
+
+#include "qcustomplot.h"
+#include <vector>
+#include <QPen>
+
+// Graphs of a plot arranged in one slot per scenario
+// Each slot holds a solid graph and, optionally, a dashed continuation graph
+// Graphs of removed slots are hidden and kept in a pool to be reused
+
+class SeriesSlots
+{
+public:
+    SeriesSlots(QCustomPlot *plot, bool continuation);
+
+    void resize(int numScenarios);
+    int size() const;
+
+    QCPGraph *solid(int scenarioIndex) const;
+    QCPGraph *dashed(int scenarioIndex) const;
+
+    static QColor color(int scenarioIndex);
+
+private:
+    QCustomPlot *plot;
+    bool continuation;
+
+    std::vector<QCPGraph*> solidGraphs;
+    std::vector<QCPGraph*> dashedGraphs;
+    std::vector<QCPGraph*> pool;
+
+    QCPGraph *acquireGraph(const QPen &pen);
+    void releaseGraph(QCPGraph *graph);
+};
+
+#endif // SERIESSLOTS_H
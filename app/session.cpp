@@ -0,0 +1,437 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "session.h"
+#include "trajectorycodec.h"
+#include "modelcatalog.h"
+#include <cstring>
+#include <QDataStream>
+#include <QFile>
+#include <QSaveFile>
+#include <QDir>
+#include <QStandardPaths>
+
+static const quint32 sessionMagic = 0x53495253; // SIRS
+static const quint32 sessionVersion = 1;
+
+// Phase space models are all three dimensional
+
+static const size_t phaseSpaceDimension = 3;
+
+QString defaultSessionFileName()
+{
+    QString directory = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+
+    QDir().mkpath(directory);
+
+    return directory + "/session.sirs";
+}
+
+// Vectors
+
+static void writeVector(QDataStream &out, const std::vector<double> &vector)
+{
+    out << static_cast<quint32>(vector.size());
+
+    for (double value : vector)
+        out << value;
+}
+
+static std::vector<double> readVector(QDataStream &in)
+{
+    quint32 size;
+    in >> size;
+
+    std::vector<double> vector;
+
+    for (quint32 i = 0; i < size && in.status() == QDataStream::Ok; i++)
+    {
+        double value;
+        in >> value;
+        vector.push_back(value);
+    }
+
+    return vector;
+}
+
+// Encoded data blocks, stored raw so that they can be used from a memory map
+
+static void writeBlock(QDataStream &out, const std::vector<unsigned char> &block)
+{
+    out << static_cast<quint64>(block.size());
+    out.writeRawData(reinterpret_cast<const char*>(block.data()), static_cast<int>(block.size()));
+}
+
+static const unsigned char *readBlock(QDataStream &in, const unsigned char *map, qint64 mapSize, quint64 &size)
+{
+    in >> size;
+
+    qint64 position = in.device()->pos();
+
+    if (in.status() != QDataStream::Ok || size > static_cast<quint64>(mapSize - position))
+    {
+        in.setStatus(QDataStream::ReadCorruptData);
+        return nullptr;
+    }
+
+    in.skipRawData(static_cast<int>(size));
+
+    return map + position;
+}
+
+// Scenarios, without their trajectories
+
+static void writeScenario(QDataStream &out, const Scenario &scenario)
+{
+    writeVector(out, scenario.x0);
+    writeVector(out, scenario.parameters);
+    writeVector(out, scenario.parametersMin);
+    writeVector(out, scenario.parametersMax);
+
+    out << scenario.timeStart << scenario.timeStartMin << scenario.timeStartMax;
+    out << scenario.timeEnd << scenario.timeEndMin << scenario.timeEndMax;
+}
+
+static Scenario readScenario(QDataStream &in)
+{
+    std::vector<double> x0 = readVector(in);
+    std::vector<double> p = readVector(in);
+    std::vector<double> pMin = readVector(in);
+    std::vector<double> pMax = readVector(in);
+
+    double t0, t0Min, t0Max, t1, t1Min, t1Max;
+    in >> t0 >> t0Min >> t0Max >> t1 >> t1Min >> t1Max;
+
+    return Scenario(x0, p, pMin, pMax, t0, t0Min, t0Max, t1, t1Min, t1Max);
+}
+
+// Checks of restored data against the model it belongs to
+
+static bool scenarioMatches(const Scenario &scenario, const ModelDefinition &definition)
+{
+    return scenario.x0.size() == definition.variableShortNames.size() &&
+        scenario.parameters.size() == definition.parameterNames.size() &&
+        scenario.parametersMin.size() == definition.parameterNames.size() &&
+        scenario.parametersMax.size() == definition.parameterNames.size();
+}
+
+static bool trajectoryMatches(const Trajectory &trajectory, size_t dimension)
+{
+    if (trajectory.steps.empty() || trajectory.times.size() != trajectory.steps.size())
+    {
+        return false;
+    }
+
+    for (const state_type &step : trajectory.steps)
+    {
+        if (step.size() != dimension)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Encoded trajectories are checked from their header before decoding, so that a corrupt
+// number of points is rejected instead of allocated
+
+static bool encodedTrajectoryMatches(const unsigned char *data, size_t size, size_t dimension)
+{
+    size_t numPoints, blockDimension;
+
+    return encodedTrajectoryShape(data, size, numPoints, blockDimension) && numPoints > 0 && blockDimension == dimension;
+}
+
+// Snapshot trajectories are a sequence of size-prefixed encoded trajectories, one per scenario
+
+static bool snapshotTrajectoriesMatch(const unsigned char *data, size_t size, size_t numScenarios, size_t dimension)
+{
+    size_t position = 0;
+
+    for (size_t j = 0; j < numScenarios; j++)
+    {
+        quint64 blockSize;
+
+        if (size - position < sizeof(blockSize))
+        {
+            return false;
+        }
+
+        std::memcpy(&blockSize, data + position, sizeof(blockSize));
+        position += sizeof(blockSize);
+
+        if (blockSize > size - position || !encodedTrajectoryMatches(data + position, blockSize, dimension))
+        {
+            return false;
+        }
+
+        position += blockSize;
+    }
+
+    return position == size;
+}
+
+bool saveSession(QString fileName, const SessionState &state)
+{
+    QSaveFile file(fileName);
+
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_0);
+
+    out << sessionMagic << sessionVersion;
+    out << static_cast<qint32>(state.scenarioModelIndex) << static_cast<qint32>(state.phaseSpaceModelIndex);
+
+    // Scenario models
+
+    out << static_cast<quint32>(state.scenarioModels.size());
+
+    for (const ScenarioModelState &model : state.scenarioModels)
+    {
+        out << static_cast<qint32>(model.modelIndex) << static_cast<qint32>(model.currentScenarioIndex) << static_cast<qint32>(model.currentSnapshotIndex);
+
+        out << static_cast<quint32>(model.scenarios.size());
+
+        for (const Scenario &scenario : model.scenarios)
+        {
+            writeScenario(out, scenario);
+            writeBlock(out, encodeTrajectory(*scenario.trajectory));
+        }
+
+        out << static_cast<quint32>(model.snapshotScenarios.size());
+
+        for (size_t i = 0; i < model.snapshotScenarios.size(); i++)
+        {
+            out << static_cast<quint32>(model.snapshotScenarios[i].size());
+
+            for (const Scenario &scenario : model.snapshotScenarios[i])
+            {
+                writeScenario(out, scenario);
+            }
+
+            writeBlock(out, model.snapshotTrajectories[i]);
+        }
+    }
+
+    // Phase space models
+
+    out << static_cast<quint32>(state.phaseSpaceModels.size());
+
+    for (const PhaseSpaceModelState &model : state.phaseSpaceModels)
+    {
+        out << static_cast<qint32>(model.modelIndex);
+
+        writeVector(out, model.parameter);
+
+        out << static_cast<qint32>(model.icGridDimension) << static_cast<qint32>(model.xAxis) << static_cast<qint32>(model.yAxis) << model.timeEnd;
+
+        out << static_cast<quint32>(model.trajectories.size());
+
+        for (const std::shared_ptr<const Trajectory> &trajectory : model.trajectories)
+        {
+            writeBlock(out, encodeTrajectory(*trajectory));
+        }
+    }
+
+    if (out.status() != QDataStream::Ok)
+    {
+        file.cancelWriting();
+        return false;
+    }
+
+    return file.commit();
+}
+
+bool loadSession(QString fileName, SessionState &state)
+{
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    qint64 mapSize = file.size();
+    const unsigned char *map = file.map(0, mapSize);
+
+    if (map == nullptr)
+    {
+        return false;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magic, version;
+    in >> magic >> version;
+
+    if (magic != sessionMagic || version != sessionVersion)
+    {
+        return false;
+    }
+
+    qint32 scenarioModelIndex, phaseSpaceModelIndex;
+    in >> scenarioModelIndex >> phaseSpaceModelIndex;
+
+    state.scenarioModelIndex = scenarioModelIndex;
+    state.phaseSpaceModelIndex = phaseSpaceModelIndex;
+
+    // Scenario models, checked against the model catalog
+
+    const std::vector<ModelDefinition> &definitions = scenarioModelDefinitions();
+
+    quint32 numScenarioModels;
+    in >> numScenarioModels;
+
+    for (quint32 m = 0; m < numScenarioModels && in.status() == QDataStream::Ok; m++)
+    {
+        ScenarioModelState model;
+
+        qint32 modelIndex, currentScenarioIndex, currentSnapshotIndex;
+        in >> modelIndex >> currentScenarioIndex >> currentSnapshotIndex;
+
+        model.modelIndex = modelIndex;
+        model.currentScenarioIndex = currentScenarioIndex;
+        model.currentSnapshotIndex = currentSnapshotIndex;
+
+        if (in.status() != QDataStream::Ok || modelIndex < 0 || modelIndex >= static_cast<qint32>(definitions.size()))
+        {
+            return false;
+        }
+
+        const ModelDefinition &definition = definitions[modelIndex];
+        size_t dimension = definition.variableShortNames.size();
+
+        quint32 numScenarios;
+        in >> numScenarios;
+
+        for (quint32 j = 0; j < numScenarios && in.status() == QDataStream::Ok; j++)
+        {
+            Scenario scenario = readScenario(in);
+
+            quint64 size;
+            const unsigned char *block = readBlock(in, map, mapSize, size);
+
+            if (block == nullptr || !scenarioMatches(scenario, definition) || !encodedTrajectoryMatches(block, size, dimension))
+            {
+                return false;
+            }
+
+            scenario.trajectory = decodeTrajectory(block, size);
+
+            if (!trajectoryMatches(*scenario.trajectory, dimension))
+            {
+                return false;
+            }
+
+            model.scenarios.push_back(scenario);
+        }
+
+        quint32 numSnapshots;
+        in >> numSnapshots;
+
+        for (quint32 i = 0; i < numSnapshots && in.status() == QDataStream::Ok; i++)
+        {
+            quint32 numSnapshotScenarios;
+            in >> numSnapshotScenarios;
+
+            std::vector<Scenario> snapshotScenarios;
+
+            for (quint32 j = 0; j < numSnapshotScenarios && in.status() == QDataStream::Ok; j++)
+            {
+                Scenario scenario = readScenario(in);
+
+                if (!scenarioMatches(scenario, definition))
+                {
+                    return false;
+                }
+
+                scenario.trajectory.reset();
+                snapshotScenarios.push_back(scenario);
+            }
+
+            // Snapshots stay encoded until shown, only their headers are checked
+
+            quint64 size;
+            const unsigned char *block = readBlock(in, map, mapSize, size);
+
+            if (block == nullptr || snapshotScenarios.empty() || !snapshotTrajectoriesMatch(block, size, snapshotScenarios.size(), dimension))
+            {
+                return false;
+            }
+
+            model.snapshotScenarios.push_back(snapshotScenarios);
+            model.snapshotTrajectories.push_back(std::vector<unsigned char>(block, block + size));
+        }
+
+        state.scenarioModels.push_back(model);
+    }
+
+    // Phase space models
+
+    quint32 numPhaseSpaceModels;
+    in >> numPhaseSpaceModels;
+
+    for (quint32 m = 0; m < numPhaseSpaceModels && in.status() == QDataStream::Ok; m++)
+    {
+        PhaseSpaceModelState model;
+
+        qint32 modelIndex, icGridDimension, xAxis, yAxis;
+        in >> modelIndex;
+
+        model.modelIndex = modelIndex;
+        model.parameter = readVector(in);
+
+        in >> icGridDimension >> xAxis >> yAxis >> model.timeEnd;
+
+        model.icGridDimension = icGridDimension;
+        model.xAxis = xAxis;
+        model.yAxis = yAxis;
+
+        quint32 numTrajectories;
+        in >> numTrajectories;
+
+        for (quint32 i = 0; i < numTrajectories && in.status() == QDataStream::Ok; i++)
+        {
+            quint64 size;
+            const unsigned char *block = readBlock(in, map, mapSize, size);
+
+            if (block == nullptr || !encodedTrajectoryMatches(block, size, phaseSpaceDimension))
+            {
+                return false;
+            }
+
+            std::shared_ptr<Trajectory> trajectory = decodeTrajectory(block, size);
+
+            if (!trajectoryMatches(*trajectory, phaseSpaceDimension))
+            {
+                return false;
+            }
+
+            model.trajectories.push_back(trajectory);
+        }
+
+        state.phaseSpaceModels.push_back(model);
+    }
+
+    return in.status() == QDataStream::Ok;
+}
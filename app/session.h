@@ -0,0 +1,69 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef SESSION_H
+#define SESSION_H
+
+#include "scenario.h"
+#include <vector>
+#include <memory>
+#include <QString>
+
+// Saved state of the application: scenario chains, snapshots and phase space settings,
+// together with their solved trajectories, so that a session is restored without integrating
+
+struct ScenarioModelState
+{
+    int modelIndex;
+    int currentScenarioIndex;
+    int currentSnapshotIndex;
+    std::vector<Scenario> scenarios;
+    std::vector<std::vector<Scenario>> snapshotScenarios;
+    std::vector<std::vector<unsigned char>> snapshotTrajectories;
+};
+
+struct PhaseSpaceModelState
+{
+    int modelIndex;
+    std::vector<double> parameter;
+    int icGridDimension;
+    int xAxis;
+    int yAxis;
+    double timeEnd;
+    std::vector<std::shared_ptr<const Trajectory>> trajectories;
+};
+
+struct SessionState
+{
+    int scenarioModelIndex;
+    int phaseSpaceModelIndex;
+    std::vector<ScenarioModelState> scenarioModels;
+    std::vector<PhaseSpaceModelState> phaseSpaceModels;
+};
+
+// Session files are written with QDataStream, trajectories being stored with the compact trajectory encoding
+// Snapshot trajectories are kept encoded, model trajectories are decoded straight from a memory map of the file
+
+QString defaultSessionFileName();
+
+bool saveSession(QString fileName, const SessionState &state);
+
+// Every block is checked against its model: a session with any mismatched or unreadable block is not loaded
+
+bool loadSession(QString fileName, SessionState &state);
+
+#endif // SESSION_H
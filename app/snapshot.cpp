@@ -0,0 +1,462 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "snapshot.h"
+
+unsigned long long Snapshot::useCounter = 0;
+
+Snapshot::Snapshot(ScenarioModel *model): Snapshot(model, model->scenarios, std::vector<unsigned char>()){}
+
+Snapshot::Snapshot(ScenarioModel *model, const std::vector<Scenario> &snapshotScenarios, std::vector<unsigned char> encoded)
+{
+    lastUsed = ++useCounter;
+
+    dimension = model->dimension;
+
+    for (int i = 0; i < dimension; i++)
+    {
+        variableLongNames.push_back(model->variableLongNames[i]->text());
+    }
+
+    // Trajectories are shared with the model, plot data is computed when shown
+
+    scenarios = snapshotScenarios;
+
+    for (size_t j = 0; j < scenarios.size(); j++)
+    {
+        scenarios[j].clearAbscissaOrdinate();
+    }
+
+    plotsGridWidget = nullptr;
+
+    // Restored snapshots start compressed
+
+    compressed = !encoded.empty();
+    encodedTrajectories = std::move(encoded);
+
+    cacheFile = nullptr;
+    cacheOffset = 0;
+    cacheSize = 0;
+}
+
+Snapshot::~Snapshot()
+{
+    releasePlots();
+}
+
+QWidget *Snapshot::getPlotsGridWidget()
+{
+    lastUsed = ++useCounter;
+
+    if (plotsGridWidget == nullptr && !decompress())
+    {
+        // Shown as a notice instead of plots
+
+        QVBoxLayout *noticeVBoxLayout = new QVBoxLayout;
+        noticeVBoxLayout->addWidget(new QLabel("The trajectories of this snapshot could not be read back."));
+
+        plotsGridWidget = new QWidget;
+        plotsGridWidget->setLayout(noticeVBoxLayout);
+    }
+
+    if (plotsGridWidget == nullptr)
+    {
+        constructPlots();
+        constructGraphs();
+        setPlotsData();
+    }
+
+    return plotsGridWidget;
+}
+
+std::vector<QCustomPlot*> Snapshot::getPlots()
+{
+    getPlotsGridWidget();
+
+    return plots;
+}
+
+// Trajectories are null if they cannot be read back, see decompress()
+
+const std::vector<Scenario> &Snapshot::getScenarios()
+{
+    lastUsed = ++useCounter;
+
+    decompress();
+
+    return scenarios;
+}
+
+bool Snapshot::hasPlots() const
+{
+    return plotsGridWidget != nullptr;
+}
+
+void Snapshot::releasePlots()
+{
+    // Plots are children of the grid widget
+
+    delete plotsGridWidget;
+    plotsGridWidget = nullptr;
+
+    plots.clear();
+    plotSlots.clear();
+}
+
+size_t Snapshot::memoryUsage() const
+{
+    if (compressed)
+    {
+        return encodedTrajectories.capacity();
+    }
+
+    // Trajectories still shared with the model or other snapshots are not owned by this snapshot
+
+    size_t bytes = 0;
+
+    for (size_t j = 0; j < scenarios.size(); j++)
+    {
+        const std::shared_ptr<const Trajectory> &trajectory = scenarios[j].trajectory;
+
+        if (trajectory.use_count() == 1)
+        {
+            bytes += trajectory->times.capacity() * sizeof(double);
+            bytes += trajectory->steps.capacity() * (sizeof(state_type) + dimension * sizeof(double));
+        }
+    }
+
+    return bytes;
+}
+
+bool Snapshot::isCompressed() const
+{
+    return compressed;
+}
+
+bool Snapshot::isSpilled() const
+{
+    return compressed && encodedTrajectories.empty();
+}
+
+bool Snapshot::hasSharedTrajectories() const
+{
+    if (compressed)
+    {
+        return false;
+    }
+
+    for (size_t j = 0; j < scenarios.size(); j++)
+    {
+        if (scenarios[j].trajectory.use_count() > 1)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void Snapshot::compress()
+{
+    if (compressed || hasPlots())
+    {
+        return;
+    }
+
+    encodedTrajectories = encodeScenarios(scenarios);
+    encodedTrajectories.shrink_to_fit();
+
+    for (size_t j = 0; j < scenarios.size(); j++)
+    {
+        scenarios[j].trajectory.reset();
+    }
+
+    compressed = true;
+}
+
+std::vector<unsigned char> Snapshot::encodeScenarios(const std::vector<Scenario> &scenarios)
+{
+    // One block per scenario, preceded by its size
+
+    std::vector<unsigned char> encoded;
+
+    for (size_t j = 0; j < scenarios.size(); j++)
+    {
+        std::vector<unsigned char> block = encodeTrajectory(*scenarios[j].trajectory);
+
+        quint64 blockSize = block.size();
+        const unsigned char *sizeBytes = reinterpret_cast<const unsigned char*>(&blockSize);
+
+        encoded.insert(encoded.end(), sizeBytes, sizeBytes + sizeof(blockSize));
+        encoded.insert(encoded.end(), block.begin(), block.end());
+    }
+
+    return encoded;
+}
+
+std::vector<Scenario> Snapshot::getScenarioSettings() const
+{
+    std::vector<Scenario> settings = scenarios;
+
+    for (size_t j = 0; j < settings.size(); j++)
+    {
+        settings[j].trajectory.reset();
+    }
+
+    return settings;
+}
+
+bool Snapshot::getEncodedTrajectories(std::vector<unsigned char> &encoded) const
+{
+    if (!compressed)
+    {
+        encoded = encodeScenarios(scenarios);
+        return true;
+    }
+
+    if (!encodedTrajectories.empty())
+    {
+        encoded = encodedTrajectories;
+        return true;
+    }
+
+    return readSpill(encoded);
+}
+
+bool Snapshot::readSpill(std::vector<unsigned char> &encoded) const
+{
+    if (cacheFile == nullptr)
+    {
+        return false;
+    }
+
+    encoded.resize(cacheSize);
+
+    if (!cacheFile->seek(cacheOffset) || cacheFile->read(reinterpret_cast<char*>(encoded.data()), cacheSize) != cacheSize)
+    {
+        encoded.clear();
+        return false;
+    }
+
+    return true;
+}
+
+qint64 Snapshot::spilledSize() const
+{
+    return isSpilled() ? cacheSize : 0;
+}
+
+bool Snapshot::copySpill(QFile *file, qint64 &offset) const
+{
+    std::vector<unsigned char> encoded;
+
+    if (!readSpill(encoded) || !file->seek(file->size()))
+    {
+        return false;
+    }
+
+    offset = file->pos();
+
+    return file->write(reinterpret_cast<const char*>(encoded.data()), cacheSize) == cacheSize;
+}
+
+void Snapshot::moveSpill(QFile *file, qint64 offset)
+{
+    if (isSpilled())
+    {
+        cacheFile = file;
+        cacheOffset = offset;
+    }
+    else
+    {
+        cacheFile = nullptr;
+        cacheOffset = 0;
+        cacheSize = 0;
+    }
+}
+
+void Snapshot::spill(QFile *file)
+{
+    if (!compressed || encodedTrajectories.empty())
+    {
+        return;
+    }
+
+    // Encoded data never changes, so a previous spill can be reused
+
+    if (cacheFile == nullptr)
+    {
+        if (!file->seek(file->size()))
+        {
+            return;
+        }
+
+        cacheOffset = file->pos();
+        cacheSize = static_cast<qint64>(encodedTrajectories.size());
+
+        if (file->write(reinterpret_cast<const char*>(encodedTrajectories.data()), cacheSize) != cacheSize)
+        {
+            return;
+        }
+
+        cacheFile = file;
+    }
+
+    encodedTrajectories.clear();
+    encodedTrajectories.shrink_to_fit();
+}
+
+bool Snapshot::decompress()
+{
+    if (!compressed)
+    {
+        return true;
+    }
+
+    std::vector<unsigned char> encoded;
+
+    if (!getEncodedTrajectories(encoded))
+    {
+        return false;
+    }
+
+    // Blocks must fit in the encoded data and decode to trajectories of the model dimension
+
+    std::vector<std::shared_ptr<const Trajectory>> trajectories;
+    size_t position = 0;
+
+    for (size_t j = 0; j < scenarios.size(); j++)
+    {
+        quint64 blockSize;
+
+        if (encoded.size() - position < sizeof(blockSize))
+        {
+            return false;
+        }
+
+        std::memcpy(&blockSize, encoded.data() + position, sizeof(blockSize));
+        position += sizeof(blockSize);
+
+        if (blockSize > encoded.size() - position)
+        {
+            return false;
+        }
+
+        std::shared_ptr<Trajectory> trajectory = decodeTrajectory(encoded.data() + position, blockSize);
+        position += blockSize;
+
+        if (trajectory->steps.empty() || trajectory->steps.front().size() != static_cast<size_t>(dimension))
+        {
+            return false;
+        }
+
+        trajectories.push_back(trajectory);
+    }
+
+    for (size_t j = 0; j < scenarios.size(); j++)
+    {
+        scenarios[j].trajectory = trajectories[j];
+    }
+
+    encodedTrajectories.clear();
+    encodedTrajectories.shrink_to_fit();
+
+    compressed = false;
+
+    return true;
+}
+
+void Snapshot::constructPlots()
+{
+    for (int i = 0; i < dimension; i++)
+    {
+        plots.push_back(new QCustomPlot);
+
+        plots[i]->xAxis->setLabel("t/Tr");
+        plots[i]->yAxis->setLabel(variableLongNames[i] + " fraction");
+
+        plots[i]->yAxis->setRange(0.0, 1.0);
+
+        plots[i]->setInteractions(QCP::iRangeZoom | QCP::iRangeDrag);
+
+        plots[i]->axisRect()->setupFullAxesBox(true);
+        plots[i]->axisRect()->setRangeZoom(Qt::Vertical | Qt::Horizontal);
+        plots[i]->axisRect()->setRangeDrag(Qt::Vertical | Qt::Horizontal);
+    }
+
+
+    QGridLayout *plotsGridLayout = new QGridLayout;
+
+    if (dimension == 3)
+    {
+        plotsGridLayout->addWidget(plots[0], 0, 0);
+        plotsGridLayout->addWidget(plots[2], 0, 1);
+        plotsGridLayout->addWidget(plots[1], 1, 0, -1, -1);
+    }
+    else if (dimension == 4)
+    {
+        plotsGridLayout->addWidget(plots[0], 0, 0);
+        plotsGridLayout->addWidget(plots[1], 0, 1);
+        plotsGridLayout->addWidget(plots[2], 1, 0);
+        plotsGridLayout->addWidget(plots[3], 1, 1);
+    }
+
+    plotsGridWidget = new QWidget;
+    plotsGridWidget->setLayout(plotsGridLayout);
+}
+
+void Snapshot::constructGraphs()
+{
+    for (size_t i = 0; i < plots.size(); i++)
+    {
+        plotSlots.push_back(SeriesSlots(plots[i], true));
+        plotSlots[i].resize(scenarios.size());
+    }
+}
+
+void Snapshot::setPlotsData()
+{
+    int jmax = scenarios.size() - 1;
+
+    for (int j = 0; j < jmax; j++)
+    {
+        scenarios[j].setAbscissaOrdinate(scenarios[j + 1].timeStart);
+    }
+
+    scenarios[jmax].setAbscissaOrdinate();
+
+    for (size_t i = 0; i < plots.size(); i++)
+    {
+        for (int j = 0; j < jmax; j++)
+        {
+            plotSlots[i].solid(j)->setData(scenarios[j].abscissaLeft, scenarios[j].ordinateLeft[i], true);
+            plotSlots[i].dashed(j)->setData(scenarios[j].abscissaRight, scenarios[j].ordinateRight[i], true);
+        }
+
+        plotSlots[i].solid(jmax)->setData(scenarios[jmax].abscissa, scenarios[jmax].ordinate[i], true);
+
+        plots[i]->xAxis->rescale();
+        plots[i]->replot();
+    }
+
+    // Graphs hold their own copy of the data
+
+    for (size_t j = 0; j < scenarios.size(); j++)
+    {
+        scenarios[j].clearAbscissaOrdinate();
+    }
+}
@@ -0,0 +1,103 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "scenariomodel.h"
+#include "scenario.h"
+#include "seriesslots.h"
+#include "trajectorycodec.h"
+#include "qcustomplot.h"
+#include <vector>
+#include <cstring>
+#include <QString>
+#include <QFile>
+#include <QWidget>
+#include <QGridLayout>
+
+// Copy of the scenarios of a model, sharing their solved trajectories
+// Plots are only constructed while the snapshot is shown
+// Trajectories can be compressed in memory or spilled to a cache file,
+// and are decoded back when the snapshot is shown again
+// Snapshots restored from a session start compressed
+
+class Snapshot
+{
+public:
+    unsigned long long lastUsed;
+
+    Snapshot(ScenarioModel *model);
+    Snapshot(ScenarioModel *model, const std::vector<Scenario> &snapshotScenarios, std::vector<unsigned char> encoded);
+    ~Snapshot();
+
+    QWidget *getPlotsGridWidget();
+    std::vector<QCustomPlot*> getPlots();
+    const std::vector<Scenario> &getScenarios();
+    bool hasPlots() const;
+    void releasePlots();
+
+    size_t memoryUsage() const;
+    bool isCompressed() const;
+    bool isSpilled() const;
+    bool hasSharedTrajectories() const;
+
+    void compress();
+    void spill(QFile *file);
+
+    // Decodes the trajectories, false if they cannot be read back, which leaves them encoded
+
+    bool decompress();
+
+    // Cache file compaction: the spilled data is copied to the end of another file, then the
+    // snapshot is moved to it, or detached from the old file if it is not spilled
+
+    qint64 spilledSize() const;
+    bool copySpill(QFile *file, qint64 &offset) const;
+    void moveSpill(QFile *file, qint64 offset);
+
+    std::vector<Scenario> getScenarioSettings() const;
+    bool getEncodedTrajectories(std::vector<unsigned char> &encoded) const;
+
+private:
+    static unsigned long long useCounter;
+
+    int dimension;
+    std::vector<QString> variableLongNames;
+    std::vector<Scenario> scenarios;
+
+    bool compressed;
+    std::vector<unsigned char> encodedTrajectories;
+
+    QFile *cacheFile;
+    qint64 cacheOffset;
+    qint64 cacheSize;
+
+    bool readSpill(std::vector<unsigned char> &encoded) const;
+
+    static std::vector<unsigned char> encodeScenarios(const std::vector<Scenario> &scenarios);
+
+    QWidget *plotsGridWidget;
+    std::vector<QCustomPlot*> plots;
+    std::vector<SeriesSlots> plotSlots;
+
+    void constructPlots();
+    void constructGraphs();
+    void setPlotsData();
+};
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,172 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "snapshotcache.h"
+#include <algorithm>
+
+SnapshotCache::SnapshotCache()
+{
+    memoryBudget = 256 * 1024 * 1024;
+    cacheFile = nullptr;
+}
+
+SnapshotCache::~SnapshotCache()
+{
+    delete cacheFile;
+    cacheFile = nullptr;
+}
+
+void SnapshotCache::setMemoryBudget(size_t bytes)
+{
+    memoryBudget = bytes;
+}
+
+size_t SnapshotCache::getMemoryBudget() const
+{
+    return memoryBudget;
+}
+
+void SnapshotCache::enforceBudget(const std::vector<std::list<Snapshot*>> &snapshots)
+{
+    std::vector<Snapshot*> candidates;
+    size_t usage = 0;
+
+    for (size_t i = 0; i < snapshots.size(); i++)
+    {
+        for (Snapshot *snapshot : snapshots[i])
+        {
+            usage += snapshot->memoryUsage();
+
+            // Shown snapshots stay decoded, and compressing trajectories still shared would free nothing
+
+            if (!snapshot->hasPlots() && !snapshot->hasSharedTrajectories())
+            {
+                candidates.push_back(snapshot);
+            }
+        }
+    }
+
+    compact(snapshots);
+
+    if (usage <= memoryBudget)
+    {
+        return;
+    }
+
+    // Least recently used first
+
+    std::sort(candidates.begin(), candidates.end(), [](Snapshot *a, Snapshot *b){ return a->lastUsed < b->lastUsed; });
+
+    // Compress
+
+    for (size_t i = 0; i < candidates.size() && usage > memoryBudget; i++)
+    {
+        if (!candidates[i]->isCompressed())
+        {
+            usage -= candidates[i]->memoryUsage();
+            candidates[i]->compress();
+            usage += candidates[i]->memoryUsage();
+        }
+    }
+
+    // Spill
+
+    for (size_t i = 0; i < candidates.size() && usage > memoryBudget; i++)
+    {
+        if (candidates[i]->isCompressed() && !candidates[i]->isSpilled())
+        {
+            if (cacheFile == nullptr)
+            {
+                cacheFile = new QTemporaryFile;
+
+                if (!cacheFile->open())
+                {
+                    delete cacheFile;
+                    cacheFile = nullptr;
+                    return;
+                }
+            }
+
+            usage -= candidates[i]->memoryUsage();
+            candidates[i]->spill(cacheFile);
+            usage += candidates[i]->memoryUsage();
+        }
+    }
+}
+
+void SnapshotCache::compact(const std::vector<std::list<Snapshot*>> &snapshots)
+{
+    if (cacheFile == nullptr)
+    {
+        return;
+    }
+
+    // Data of removed or decoded snapshots is dropped once it is most of the file
+
+    qint64 spilled = 0;
+
+    for (size_t i = 0; i < snapshots.size(); i++)
+    {
+        for (Snapshot *snapshot : snapshots[i])
+        {
+            spilled += snapshot->spilledSize();
+        }
+    }
+
+    qint64 fileSize = cacheFile->size();
+
+    if (fileSize < minCompactionSize || fileSize < 2 * spilled)
+    {
+        return;
+    }
+
+    // Copy everything first, so that a failure leaves every snapshot in the old file
+
+    QTemporaryFile *compactedFile = new QTemporaryFile;
+
+    if (!compactedFile->open())
+    {
+        delete compactedFile;
+        return;
+    }
+
+    std::vector<std::pair<Snapshot*, qint64>> offsets;
+
+    for (size_t i = 0; i < snapshots.size(); i++)
+    {
+        for (Snapshot *snapshot : snapshots[i])
+        {
+            qint64 offset = 0;
+
+            if (snapshot->isSpilled() && !snapshot->copySpill(compactedFile, offset))
+            {
+                delete compactedFile;
+                return;
+            }
+
+            offsets.push_back(std::make_pair(snapshot, offset));
+        }
+    }
+
+    for (const std::pair<Snapshot*, qint64> &offset : offsets)
+    {
+        offset.first->moveSpill(compactedFile, offset.second);
+    }
+
+    delete cacheFile;
+    cacheFile = compactedFile;
+}
@@ -0,0 +1,50 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef SNAPSHOTCACHE_H
+#define SNAPSHOTCACHE_H
+
+#include "snapshot.h"
+#include <vector>
+#include <list>
+#include <QTemporaryFile>
+
+// Keeps the memory used by snapshots within a budget
+// Least recently used snapshots are compressed first, then spilled to a cache file
+// The cache file is rewritten with only the spilled data once that is less than half of it
+
+class SnapshotCache
+{
+public:
+    SnapshotCache();
+    ~SnapshotCache();
+
+    void setMemoryBudget(size_t bytes);
+    size_t getMemoryBudget() const;
+
+    void enforceBudget(const std::vector<std::list<Snapshot*>> &snapshots);
+
+private:
+    static const qint64 minCompactionSize = 16 * 1024 * 1024;
+
+    size_t memoryBudget;
+    QTemporaryFile *cacheFile;
+
+    void compact(const std::vector<std::list<Snapshot*>> &snapshots);
+};
+
+#endif // SNAPSHOTCACHE_H
@@ -0,0 +1,35 @@
+TARGET = sirviewclient
+
+# Loopback client and load generator of the local solve service
+
+QT = core network
+
+CONFIG += console c++17
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+INCLUDEPATH += C:/Development/boost_1_76_0
+
+# Numerical core library
+
+INCLUDEPATH += $$PWD/../core
+DEPENDPATH += $$PWD/../core
+
+win32:CONFIG(release, debug|release): CORE_LIB_DIR = $$OUT_PWD/../core/release
+else:win32:CONFIG(debug, debug|release): CORE_LIB_DIR = $$OUT_PWD/../core/debug
+else: CORE_LIB_DIR = $$OUT_PWD/../core
+
+LIBS += -L$$CORE_LIB_DIR -lsirviewcore
+
+win32-msvc*: PRE_TARGETDEPS += $$CORE_LIB_DIR/sirviewcore.lib
+else: PRE_TARGETDEPS += $$CORE_LIB_DIR/libsirviewcore.a
+
+SOURCES += \
+    main.cpp \
+    solveclient.cpp
+
+HEADERS += \
+    solveclient.h
+
+QMAKE_CXXFLAGS_RELEASE += /MT
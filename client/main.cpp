@@ -0,0 +1,246 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+
+// Load generator of the local solve service, e.g.
+//
+//     sirviewclient [--server name] [--connections 4] [--requests 1000] [--batch 16]
+//                   [--model 0] [--times 101] [--distinct 0] [--verify]
+//
+// Each connection sends its requests back to back from its own thread, with problems
+// drawn around the default parameters of the model. With --distinct n the problems are
+// taken from n fixed ones, exercising the solution cache of the service. With --verify
+// the first response of each connection is compared with a local solve
+
+#include "solveclient.h"
+#include "modelcatalog.h"
+#include "scenariointegrator.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+#include <QCoreApplication>
+#include <QString>
+
+struct ConnectionResult
+{
+    bool success = true;
+    QString error;
+    double maxDeviation = 0.0;
+    std::vector<double> latencies;
+};
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication application(argc, argv);
+
+    // Arguments
+
+    QString serverName = "sirview-solver";
+    int numConnections = 4;
+    int numRequests = 1000;
+    int batchSize = 16;
+    int modelIndex = 0;
+    int numTimes = 101;
+    int numDistinct = 0;
+    bool verify = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        QString argument = QString::fromLocal8Bit(argv[i]);
+        QString value = i + 1 < argc ? QString::fromLocal8Bit(argv[i + 1]) : QString();
+
+        if (argument == "--verify")
+        {
+            verify = true;
+            continue;
+        }
+
+        if (value.isEmpty())
+        {
+            std::fprintf(stderr, "sirviewclient: missing value for %s\n", argv[i]);
+            return 1;
+        }
+
+        i++;
+
+        if (argument == "--server") serverName = value;
+        else if (argument == "--connections") numConnections = std::max(1, value.toInt());
+        else if (argument == "--requests") numRequests = std::max(1, value.toInt());
+        else if (argument == "--batch") batchSize = std::max(1, value.toInt());
+        else if (argument == "--model") modelIndex = findScenarioModel(value);
+        else if (argument == "--times") numTimes = std::max(2, value.toInt());
+        else if (argument == "--distinct") numDistinct = std::max(0, value.toInt());
+        else
+        {
+            std::fprintf(stderr, "sirviewclient: unknown option %s\n", argv[i - 1]);
+            return 1;
+        }
+    }
+
+    if (modelIndex < 0)
+    {
+        std::fprintf(stderr, "sirviewclient: unknown model\n");
+        return 1;
+    }
+
+    const ModelDefinition &definition = scenarioModelDefinitions()[modelIndex];
+
+    std::vector<double> parameterInit(definition.parameterInit.begin(), definition.parameterInit.end());
+    std::vector<double> initialConditions(definition.initialConditions.begin(), definition.initialConditions.end());
+
+    size_t problemSize = parameterInit.size() + initialConditions.size();
+    size_t solutionSize = numTimes * initialConditions.size();
+
+    std::vector<double> times(numTimes);
+
+    for (int i = 0; i < numTimes; i++)
+        times[i] = 100.0 * i / (numTimes - 1);
+
+    // Fixed problems, if any, shared by all connections
+
+    auto randomProblem = [&](std::mt19937_64 &generator, double *problem)
+    {
+        std::uniform_real_distribution<double> scale(0.5, 1.5);
+
+        for (size_t k = 0; k < parameterInit.size(); k++)
+            problem[k] = parameterInit[k] * scale(generator);
+
+        std::copy(initialConditions.begin(), initialConditions.end(), problem + parameterInit.size());
+    };
+
+    std::vector<double> distinctProblems(numDistinct * problemSize);
+    std::mt19937_64 distinctGenerator(1);
+
+    for (int d = 0; d < numDistinct; d++)
+        randomProblem(distinctGenerator, distinctProblems.data() + d * problemSize);
+
+    // Connections
+
+    std::vector<ConnectionResult> results(numConnections);
+    std::vector<std::thread> threads;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (int c = 0; c < numConnections; c++)
+    {
+        threads.emplace_back([&, c](){
+            ConnectionResult &result = results[c];
+
+            SolveClient client;
+
+            if (!client.connectToServer(serverName))
+            {
+                result.success = false;
+                result.error = "cannot connect to " + serverName;
+                return;
+            }
+
+            std::mt19937_64 generator(c + 2);
+            std::uniform_int_distribution<int> pick(0, std::max(0, numDistinct - 1));
+
+            std::vector<double> problems(batchSize * problemSize);
+            std::vector<double> solutions;
+
+            result.latencies.reserve(numRequests);
+
+            for (int r = 0; r < numRequests; r++)
+            {
+                for (int p = 0; p < batchSize; p++)
+                {
+                    if (numDistinct > 0)
+                        std::copy_n(distinctProblems.data() + pick(generator) * problemSize, problemSize, problems.data() + p * problemSize);
+                    else
+                        randomProblem(generator, problems.data() + p * problemSize);
+                }
+
+                auto requestStart = std::chrono::steady_clock::now();
+
+                if (!client.solve(modelIndex, times, problems, batchSize, solutions, result.error))
+                {
+                    result.success = false;
+                    return;
+                }
+
+                result.latencies.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - requestStart).count());
+
+                if (verify && r == 0)
+                {
+                    std::vector<double> local(solutionSize);
+
+                    for (int p = 0; p < batchSize; p++)
+                    {
+                        const double *problem = problems.data() + p * problemSize;
+
+                        std::vector<double> parameters(problem, problem + parameterInit.size());
+                        state_type x0(problem + parameterInit.size(), problem + problemSize);
+
+                        integrateOnGrid(modelIndex, parameters, x0, times, local.data());
+
+                        for (size_t k = 0; k < solutionSize; k++)
+                            result.maxDeviation = std::max(result.maxDeviation, std::fabs(local[k] - solutions[p * solutionSize + k]));
+                    }
+                }
+            }
+
+            client.disconnectFromServer();
+        });
+    }
+
+    for (std::thread &thread : threads)
+        thread.join();
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Report
+
+    std::vector<double> latencies;
+    double maxDeviation = 0.0;
+
+    for (const ConnectionResult &result : results)
+    {
+        if (!result.success)
+        {
+            std::fprintf(stderr, "sirviewclient: %s\n", result.error.toLocal8Bit().constData());
+            return 1;
+        }
+
+        latencies.insert(latencies.end(), result.latencies.begin(), result.latencies.end());
+        maxDeviation = std::max(maxDeviation, result.maxDeviation);
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+
+    auto percentile = [&latencies](double q)
+    {
+        return latencies[std::min(latencies.size() - 1, static_cast<size_t>(q * latencies.size()))];
+    };
+
+    std::printf("Model:       %s\n", definition.name.toLocal8Bit().constData());
+    std::printf("Requests:    %zu in %.3f s, %.1f requests/s\n", latencies.size(), elapsed, latencies.size() / elapsed);
+    std::printf("Solves:      %zu, %.1f solves/s\n", latencies.size() * batchSize, latencies.size() * batchSize / elapsed);
+    std::printf("Latency:     p50 %.3f ms, p99 %.3f ms, max %.3f ms\n", percentile(0.5), percentile(0.99), latencies.back());
+
+    if (verify)
+        std::printf("Verify:      max deviation from local solve %g\n", maxDeviation);
+
+    return 0;
+}
@@ -0,0 +1,150 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "solveclient.h"
+#include <algorithm>
+#include <cstring>
+
+SolveClient::SolveClient()
+{
+    nextRequestId = 0;
+}
+
+bool SolveClient::connectToServer(QString name, int timeout)
+{
+    socket.connectToServer(name);
+
+    return socket.waitForConnected(timeout);
+}
+
+void SolveClient::disconnectFromServer()
+{
+    socket.disconnectFromServer();
+}
+
+bool SolveClient::write(const char *data, qint64 size)
+{
+    while (size > 0)
+    {
+        qint64 written = socket.write(data, size);
+
+        if (written < 0)
+            return false;
+
+        data += written;
+        size -= written;
+    }
+
+    while (socket.bytesToWrite() > 0)
+    {
+        if (!socket.waitForBytesWritten(-1))
+            return false;
+    }
+
+    return true;
+}
+
+bool SolveClient::read(char *data, qint64 size)
+{
+    while (size > 0)
+    {
+        if (socket.bytesAvailable() == 0 && !socket.waitForReadyRead(-1))
+            return false;
+
+        qint64 count = socket.read(data, size);
+
+        if (count < 0)
+            return false;
+
+        data += count;
+        size -= count;
+    }
+
+    return true;
+}
+
+bool SolveClient::solve(int modelIndex, const std::vector<double> &times, const std::vector<double> &problems, uint32_t numProblems, std::vector<double> &solutions, QString &error)
+{
+    // Request
+
+    SolveRequestHeader request;
+    request.magic = solveRequestMagic;
+    request.version = solveProtocolVersion;
+    request.requestId = nextRequestId++;
+    request.modelIndex = static_cast<uint32_t>(modelIndex);
+    request.numProblems = numProblems;
+    request.numTimes = static_cast<uint32_t>(times.size());
+
+    uint32_t payloadSize = static_cast<uint32_t>(sizeof(request) + (times.size() + problems.size()) * sizeof(double));
+
+    std::vector<char> frame(sizeof(payloadSize) + payloadSize);
+
+    char *out = frame.data();
+    std::memcpy(out, &payloadSize, sizeof(payloadSize));
+    out += sizeof(payloadSize);
+    std::memcpy(out, &request, sizeof(request));
+    out += sizeof(request);
+    std::memcpy(out, times.data(), times.size() * sizeof(double));
+    out += times.size() * sizeof(double);
+    std::memcpy(out, problems.data(), problems.size() * sizeof(double));
+
+    if (!write(frame.data(), static_cast<qint64>(frame.size())))
+    {
+        error = socket.errorString();
+        return false;
+    }
+
+    // Response
+
+    uint32_t responseSize;
+    SolveResponseHeader response;
+
+    if (!read(reinterpret_cast<char*>(&responseSize), sizeof(responseSize)) || responseSize < sizeof(response) ||
+        !read(reinterpret_cast<char*>(&response), sizeof(response)))
+    {
+        error = "Connection lost";
+        return false;
+    }
+
+    std::vector<char> body(responseSize - sizeof(response));
+
+    if (!read(body.data(), static_cast<qint64>(body.size())))
+    {
+        error = "Connection lost";
+        return false;
+    }
+
+    if (response.magic != solveResponseMagic || response.requestId != request.requestId)
+    {
+        error = "Unexpected response";
+        return false;
+    }
+
+    if (response.status != SolveOk)
+    {
+        error = QString::fromUtf8(body.data(), static_cast<int>(std::min<size_t>(response.messageSize, body.size())));
+        return false;
+    }
+
+    size_t offset = response.messageSize + solvePadding(response.messageSize);
+
+    solutions.resize((body.size() - offset) / sizeof(double));
+    std::memcpy(solutions.data(), body.data() + offset, solutions.size() * sizeof(double));
+
+    return true;
+}
@@ -0,0 +1,51 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#ifndef SOLVECLIENT_H
+#define SOLVECLIENT_H
+
+#include "solveprotocol.h"
+#include <cstdint>
+#include <vector>
+#include <QLocalSocket>
+#include <QString>
+
+// Blocking client of the local solve service, see solveprotocol.h
+
+class SolveClient
+{
+public:
+    SolveClient();
+
+    bool connectToServer(QString name, int timeout = 5000);
+    void disconnectFromServer();
+
+    // Solves problems, each one given by its parameters followed by its initial conditions,
+    // on the time grid. Solutions get, for each problem, the state at every grid time
+
+    bool solve(int modelIndex, const std::vector<double> &times, const std::vector<double> &problems, uint32_t numProblems, std::vector<double> &solutions, QString &error);
+
+private:
+    QLocalSocket socket;
+    uint32_t nextRequestId;
+
+    bool read(char *data, qint64 size);
+    bool write(const char *data, qint64 size);
+};
+
+#endif // SOLVECLIENT_H
@@ -0,0 +1,85 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "analyticmetrics.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <boost/math/special_functions/lambert_w.hpp>
+
+bool hasAnalyticPeak(int modelIndex)
+{
+    return modelIndex == 0;
+}
+
+bool hasAnalyticFinalSize(int modelIndex)
+{
+    return modelIndex == 0 || modelIndex == 2;
+}
+
+AnalyticMetrics analyticMetrics(int modelIndex, const std::vector<double> &parameters, const state_type &initialConditions)
+{
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+
+    AnalyticMetrics metrics = {nan, nan, nan, nan, nan};
+
+    const std::vector<double> &P = parameters;
+
+    double r0 = nan;
+
+    withModel(modelIndex, [&](auto type){ r0 = decltype(type)::template type<double>::reproductionNumber(P); });
+
+    metrics.reproductionNumber = r0;
+    metrics.herdImmunityThreshold = r0 > 1.0 ? 1.0 - 1.0 / r0 : 0.0;
+
+    if (std::isnan(r0))
+        metrics.herdImmunityThreshold = nan;
+
+    const state_type &x0 = initialConditions;
+
+    // SIR model
+
+    if (modelIndex == 0)
+    {
+        double s0 = x0[0], i0 = x0[1];
+
+        metrics.peakInfected = (r0 * s0 > 1.0) ? i0 + s0 - (1.0 + std::log(r0 * s0)) / r0 : i0;
+    }
+
+    // SIR and SEIR models, whose exposed end up infected as well
+
+    if (hasAnalyticFinalSize(modelIndex))
+    {
+        double s0 = x0[0];
+        double infectious = (modelIndex == 0) ? x0[1] : x0[1] + x0[2];
+
+        if (r0 > 0.0 && s0 > 0.0)
+        {
+            double argument = std::max(-r0 * s0 * std::exp(-r0 * (s0 + infectious)), -std::exp(-1.0));
+            metrics.finalSusceptible = -boost::math::lambert_w0(argument) / r0;
+        }
+        else
+        {
+            metrics.finalSusceptible = s0;
+        }
+
+        metrics.attackRate = s0 - metrics.finalSusceptible;
+    }
+
+    return metrics;
+}
@@ -0,0 +1,48 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#ifndef ANALYTICMETRICS_H
+#define ANALYTICMETRICS_H
+
+#include "models.h"
+#include <vector>
+
+// Closed-form metrics of the scenario models that admit them, without integrating
+// Values are asymptotic (time to infinity) and NaN where the model has no closed form
+//
+// Basic reproduction number and herd-immunity threshold 1 - 1/R0, the immune fraction
+// above which infections decline: every model but SIRA
+// Peak infected, from the invariant I + S - log(S) / R0 at S = 1 / R0: SIR
+// Final susceptibles, S = -W0(-R0 S0 exp(-R0 (S0 + E0 + I0))) / R0 with the principal
+// branch of the Lambert W function: SIR and SEIR
+
+struct AnalyticMetrics
+{
+    double reproductionNumber;
+    double herdImmunityThreshold;
+    double peakInfected;
+    double finalSusceptible;
+    double attackRate;
+};
+
+AnalyticMetrics analyticMetrics(int modelIndex, const std::vector<double> &parameters, const state_type &initialConditions);
+
+bool hasAnalyticPeak(int modelIndex);
+bool hasAnalyticFinalSize(int modelIndex);
+
+#endif // ANALYTICMETRICS_H
@@ -0,0 +1,69 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef COLUMNARFORMAT_H
+#define COLUMNARFORMAT_H
+
+#include <cstdint>
+
+// Binary columnar format of exported scenarios
+// Fields are stored in little-endian byte order and every block is 8-byte aligned,
+// so that columns can be used in place from a memory map
+//
+// ColumnarHeader
+// Strings: model name, variable short names, variable long names and parameter names,
+//          each one as a uint32 byte count followed by UTF-8 bytes, padded to 8 bytes
+// Scenario table: for each scenario a ColumnarScenario followed by its parameters (doubles)
+// Scenario data, at dataOffset: times column, one column per variable (doubles),
+//                               and switch flags column (uint8), padded to 8 bytes
+
+const char columnarMagic[8] = {'S', 'I', 'R', 'V', 'I', 'E', 'W', 'C'};
+const uint32_t columnarVersion = 1;
+
+struct ColumnarHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t modelIndex;
+    uint32_t dimension;
+    uint32_t numParameters;
+    uint32_t numScenarios;
+    uint32_t stringsSize;
+};
+
+struct ColumnarScenario
+{
+    uint64_t numSteps;
+    uint64_t dataOffset;
+    double timeStart;
+    double timeEnd;
+};
+
+static_assert(sizeof(ColumnarHeader) == 32, "Unexpected columnar header size");
+static_assert(sizeof(ColumnarScenario) == 32, "Unexpected columnar scenario entry size");
+
+inline uint64_t columnarPadding(uint64_t size)
+{
+    return (8 - size % 8) % 8;
+}
+
+inline uint64_t columnarDataSize(uint64_t numSteps, uint32_t dimension)
+{
+    return (dimension + 1) * numSteps * sizeof(double) + numSteps + columnarPadding(numSteps);
+}
+
+#endif // COLUMNARFORMAT_H
@@ -0,0 +1,274 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "columnarreader.h"
+#include <cstring>
+
+ColumnarReader::ColumnarReader()
+{
+    data = nullptr;
+    size = 0;
+
+    header = nullptr;
+}
+
+ColumnarReader::~ColumnarReader()
+{
+    close();
+}
+
+bool ColumnarReader::open(const std::string &fileName)
+{
+    close();
+
+    if (!file.open(fileName))
+    {
+        return false;
+    }
+
+    data = file.data();
+    size = file.size();
+
+    if (!parse())
+    {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+bool ColumnarReader::open(const void *image, size_t imageSize)
+{
+    close();
+
+    data = reinterpret_cast<const unsigned char*>(image);
+    size = imageSize;
+
+    if (!parse())
+    {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void ColumnarReader::close()
+{
+    file.close();
+
+    data = nullptr;
+    size = 0;
+
+    header = nullptr;
+    scenarioEntries.clear();
+
+    modelName.clear();
+    variableShortNames.clear();
+    variableLongNames.clear();
+    parameterNames.clear();
+}
+
+bool ColumnarReader::isOpen() const
+{
+    return header != nullptr;
+}
+
+bool ColumnarReader::parse()
+{
+    if (size < sizeof(ColumnarHeader))
+    {
+        return false;
+    }
+
+    header = reinterpret_cast<const ColumnarHeader*>(data);
+
+    if (std::memcmp(header->magic, columnarMagic, sizeof(columnarMagic)) != 0 || header->version != columnarVersion)
+    {
+        return false;
+    }
+
+    // Strings
+
+    size_t offset = sizeof(ColumnarHeader);
+    size_t stringsEnd = offset + header->stringsSize;
+
+    if (stringsEnd > size || !readString(offset, stringsEnd, modelName))
+    {
+        return false;
+    }
+
+    std::vector<std::string> *names[3] = {&variableShortNames, &variableLongNames, &parameterNames};
+    uint32_t counts[3] = {header->dimension, header->dimension, header->numParameters};
+
+    // Every name takes at least its byte count, which bounds the counts before allocating
+
+    uint64_t numNames = 2 * static_cast<uint64_t>(header->dimension) + header->numParameters;
+
+    if (numNames * sizeof(uint32_t) > stringsEnd - offset)
+    {
+        return false;
+    }
+
+    for (int n = 0; n < 3; n++)
+    {
+        names[n]->resize(counts[n]);
+
+        for (uint32_t i = 0; i < counts[n]; i++)
+        {
+            if (!readString(offset, stringsEnd, (*names[n])[i]))
+            {
+                return false;
+            }
+        }
+    }
+
+    offset = stringsEnd + columnarPadding(stringsEnd);
+
+    // Scenario table
+
+    size_t entrySize = sizeof(ColumnarScenario) + header->numParameters * sizeof(double);
+
+    if (offset > size || header->numScenarios > (size - offset) / entrySize)
+    {
+        return false;
+    }
+
+    scenarioEntries.reserve(header->numScenarios);
+
+    for (uint32_t s = 0; s < header->numScenarios; s++)
+    {
+        if (offset + entrySize > size)
+        {
+            return false;
+        }
+
+        const ColumnarScenario *entry = reinterpret_cast<const ColumnarScenario*>(data + offset);
+
+        // Each step takes at least its time and variables, which keeps the data size from overflowing
+
+        if (entry->dataOffset % 8 != 0 || entry->dataOffset > size || entry->numSteps > (size - entry->dataOffset) / ((header->dimension + 1ull) * sizeof(double)) || columnarDataSize(entry->numSteps, header->dimension) > size - entry->dataOffset)
+        {
+            return false;
+        }
+
+        scenarioEntries.push_back(entry);
+
+        offset += entrySize;
+    }
+
+    return true;
+}
+
+bool ColumnarReader::readString(size_t &offset, size_t end, std::string &string)
+{
+    uint32_t length;
+
+    if (offset + sizeof(length) > end)
+    {
+        return false;
+    }
+
+    std::memcpy(&length, data + offset, sizeof(length));
+    offset += sizeof(length);
+
+    if (offset + length > end)
+    {
+        return false;
+    }
+
+    string.assign(reinterpret_cast<const char*>(data + offset), length);
+    offset += length;
+
+    return true;
+}
+
+int ColumnarReader::getModelIndex() const
+{
+    return static_cast<int>(header->modelIndex);
+}
+
+int ColumnarReader::getDimension() const
+{
+    return static_cast<int>(header->dimension);
+}
+
+int ColumnarReader::getNumParameters() const
+{
+    return static_cast<int>(header->numParameters);
+}
+
+int ColumnarReader::getNumScenarios() const
+{
+    return static_cast<int>(header->numScenarios);
+}
+
+const std::string &ColumnarReader::getModelName() const
+{
+    return modelName;
+}
+
+const std::vector<std::string> &ColumnarReader::getVariableShortNames() const
+{
+    return variableShortNames;
+}
+
+const std::vector<std::string> &ColumnarReader::getVariableLongNames() const
+{
+    return variableLongNames;
+}
+
+const std::vector<std::string> &ColumnarReader::getParameterNames() const
+{
+    return parameterNames;
+}
+
+size_t ColumnarReader::getNumSteps(int scenarioIndex) const
+{
+    return static_cast<size_t>(scenarioEntries[scenarioIndex]->numSteps);
+}
+
+double ColumnarReader::getTimeStart(int scenarioIndex) const
+{
+    return scenarioEntries[scenarioIndex]->timeStart;
+}
+
+double ColumnarReader::getTimeEnd(int scenarioIndex) const
+{
+    return scenarioEntries[scenarioIndex]->timeEnd;
+}
+
+const double *ColumnarReader::getParameters(int scenarioIndex) const
+{
+    return reinterpret_cast<const double*>(scenarioEntries[scenarioIndex] + 1);
+}
+
+const double *ColumnarReader::getTimes(int scenarioIndex) const
+{
+    return reinterpret_cast<const double*>(data + scenarioEntries[scenarioIndex]->dataOffset);
+}
+
+const double *ColumnarReader::getVariable(int scenarioIndex, int variableIndex) const
+{
+    return getTimes(scenarioIndex) + (variableIndex + 1) * getNumSteps(scenarioIndex);
+}
+
+const unsigned char *ColumnarReader::getSwitchFlags(int scenarioIndex) const
+{
+    return reinterpret_cast<const unsigned char*>(getTimes(scenarioIndex) + (header->dimension + 1) * getNumSteps(scenarioIndex));
+}
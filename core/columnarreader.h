@@ -0,0 +1,84 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef COLUMNARREADER_H
+#define COLUMNARREADER_H
+
+#include "columnarformat.h"
+#include "mappedfile.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Reader of binary columnar files
+// The file is memory-mapped and columns point straight into the map,
+// so they are valid until the reader is closed or destroyed
+// Images already in memory (e.g. live feed slots) are read in place as well
+
+class ColumnarReader
+{
+public:
+    ColumnarReader();
+    ~ColumnarReader();
+
+    ColumnarReader(const ColumnarReader&) = delete;
+    ColumnarReader &operator=(const ColumnarReader&) = delete;
+
+    bool open(const std::string &fileName);
+    bool open(const void *image, size_t imageSize);
+    void close();
+
+    bool isOpen() const;
+
+    int getModelIndex() const;
+    int getDimension() const;
+    int getNumParameters() const;
+    int getNumScenarios() const;
+
+    const std::string &getModelName() const;
+    const std::vector<std::string> &getVariableShortNames() const;
+    const std::vector<std::string> &getVariableLongNames() const;
+    const std::vector<std::string> &getParameterNames() const;
+
+    size_t getNumSteps(int scenarioIndex) const;
+    double getTimeStart(int scenarioIndex) const;
+    double getTimeEnd(int scenarioIndex) const;
+
+    const double *getParameters(int scenarioIndex) const;
+    const double *getTimes(int scenarioIndex) const;
+    const double *getVariable(int scenarioIndex, int variableIndex) const;
+    const unsigned char *getSwitchFlags(int scenarioIndex) const;
+
+private:
+    MappedFile file;
+
+    const unsigned char *data;
+    size_t size;
+
+    const ColumnarHeader *header;
+    std::vector<const ColumnarScenario*> scenarioEntries;
+
+    std::string modelName;
+    std::vector<std::string> variableShortNames;
+    std::vector<std::string> variableLongNames;
+    std::vector<std::string> parameterNames;
+
+    bool parse();
+    bool readString(size_t &offset, size_t end, std::string &string);
+};
+
+#endif // COLUMNARREADER_H
@@ -0,0 +1,132 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "columnarwriter.h"
+#include <cstring>
+
+ColumnarWriter::ColumnarWriter(const ExportSource &exportSource): source(exportSource)
+{
+    const std::vector<Scenario> &scenarios = source.scenarios;
+
+    int dimension = source.dimension;
+    int numParameters = static_cast<int>(source.parameterNames.size());
+
+    // Strings
+
+    auto appendString = [this](QString string)
+    {
+        QByteArray utf8 = string.toUtf8();
+        quint32 length = static_cast<quint32>(utf8.size());
+        strings.append(reinterpret_cast<const char*>(&length), sizeof(length));
+        strings.append(utf8);
+    };
+
+    appendString(source.modelName);
+
+    for (int i = 0; i < dimension; i++)
+        appendString(source.variableShortNames[i]);
+
+    for (int i = 0; i < dimension; i++)
+        appendString(source.variableLongNames[i]);
+
+    for (int i = 0; i < numParameters; i++)
+        appendString(source.parameterNames[i]);
+
+    // Header
+
+    std::memcpy(header.magic, columnarMagic, sizeof(columnarMagic));
+    header.version = columnarVersion;
+    header.modelIndex = static_cast<uint32_t>(source.modelIndex);
+    header.dimension = static_cast<uint32_t>(dimension);
+    header.numParameters = static_cast<uint32_t>(numParameters);
+    header.numScenarios = static_cast<uint32_t>(scenarios.size());
+    header.stringsSize = static_cast<uint32_t>(strings.size());
+
+    strings.append(QByteArray(static_cast<int>(columnarPadding(sizeof(header) + strings.size())), '\0'));
+
+    // Scenario table
+
+    uint64_t offset = sizeof(header) + strings.size() + scenarios.size() * (sizeof(ColumnarScenario) + numParameters * sizeof(double));
+
+    for (size_t s = 0; s < scenarios.size(); s++)
+    {
+        ColumnarScenario entry;
+        entry.numSteps = scenarios[s].trajectory->times.size();
+        entry.dataOffset = offset;
+        entry.timeStart = scenarios[s].timeStart;
+        entry.timeEnd = scenarios[s].timeEnd;
+
+        table.append(reinterpret_cast<const char*>(&entry), sizeof(entry));
+        table.append(reinterpret_cast<const char*>(scenarios[s].parameters.data()), numParameters * sizeof(double));
+
+        offset += columnarDataSize(entry.numSteps, header.dimension);
+    }
+
+    size = offset;
+}
+
+uint64_t ColumnarWriter::getSize() const
+{
+    return size;
+}
+
+bool ColumnarWriter::write(const Sink &sink) const
+{
+    const std::vector<Scenario> &scenarios = source.scenarios;
+
+    if (!sink(&header, sizeof(header))) return false;
+    if (!sink(strings.constData(), strings.size())) return false;
+    if (!sink(table.constData(), table.size())) return false;
+
+    // Columns
+
+    std::vector<double> column;
+    std::vector<unsigned char> flags;
+
+    for (size_t s = 0; s < scenarios.size(); s++)
+    {
+        const std::vector<state_type> &steps = scenarios[s].trajectory->steps;
+        const std::vector<double> &times = scenarios[s].trajectory->times;
+
+        size_t n = times.size();
+
+        if (!sink(times.data(), n * sizeof(double))) return false;
+
+        column.resize(n);
+
+        for (int k = 0; k < source.dimension; k++)
+        {
+            for (size_t i = 0; i < n; i++)
+                column[i] = steps[i][k];
+
+            if (!sink(column.data(), n * sizeof(double))) return false;
+        }
+
+        size_t j = switchStepIndex(scenarios, s);
+        bool last = s + 1 == scenarios.size();
+
+        flags.assign(n + columnarPadding(n), 0);
+
+        for (size_t i = 0; i < n; i++)
+            flags[i] = (!last && i >= j) ? 1 : 0;
+
+        if (!sink(flags.data(), flags.size())) return false;
+    }
+
+    return true;
+}
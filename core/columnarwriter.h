@@ -0,0 +1,54 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#ifndef COLUMNARWRITER_H
+#define COLUMNARWRITER_H
+
+#include "columnarformat.h"
+#include "exportjob.h"
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include <QByteArray>
+
+// Writer of binary columnar images, see columnarformat.h
+// Header, strings and scenario table are laid out on construction, so that the total
+// size is known before writing. Blocks are then passed in order to a sink, which can
+// be a file or a buffer in memory, and returns false to stop
+
+class ColumnarWriter
+{
+public:
+    typedef std::function<bool(const void *block, uint64_t size)> Sink;
+
+    explicit ColumnarWriter(const ExportSource &exportSource);
+
+    uint64_t getSize() const;
+
+    bool write(const Sink &sink) const;
+
+private:
+    const ExportSource &source;
+
+    ColumnarHeader header;
+    QByteArray strings;
+    QByteArray table;
+    uint64_t size;
+};
+
+#endif // COLUMNARWRITER_H
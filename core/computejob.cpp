@@ -0,0 +1,51 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "computejob.h"
+
+ComputeJob::ComputeJob(const Work &jobWork): work(jobWork)
+{
+    canceled = false;
+    lastPercent = -1;
+
+    // Deleted by the receiver of finished()
+
+    setAutoDelete(false);
+}
+
+void ComputeJob::run()
+{
+    bool success = work(canceled, [this](double fraction){ reportProgress(fraction); });
+
+    emit finished(success, canceled);
+}
+
+void ComputeJob::cancel()
+{
+    canceled = true;
+}
+
+void ComputeJob::reportProgress(double fraction)
+{
+    int percent = static_cast<int>(100.0 * fraction);
+
+    if (percent != lastPercent)
+    {
+        lastPercent = percent;
+        emit progressChanged(percent);
+    }
+}
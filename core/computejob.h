@@ -0,0 +1,56 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef COMPUTEJOB_H
+#define COMPUTEJOB_H
+
+#include <atomic>
+#include <functional>
+#include <QObject>
+#include <QRunnable>
+
+// CPU bound work (fits, sweeps, ensembles...) running on the compute thread pool, see computepool.h
+// The work is given the cancel flag and a progress callback taking a fraction, as the run() of
+// the analysis engines, and returns whether it succeeded
+// Reports progress as a percentage and can be canceled at any time
+
+class ComputeJob: public QObject, public QRunnable
+{
+    Q_OBJECT
+
+public:
+    typedef std::function<bool(const std::atomic<bool> &canceled, const std::function<void(double)> &progress)> Work;
+
+    explicit ComputeJob(const Work &jobWork);
+
+    void run() override;
+    void cancel();
+
+signals:
+    void progressChanged(int percent);
+    void finished(bool success, bool canceled);
+
+private:
+    Work work;
+
+    std::atomic<bool> canceled;
+    int lastPercent;
+
+    void reportProgress(double fraction);
+};
+
+#endif // COMPUTEJOB_H
@@ -15,14 +15,20 @@
 // You should have received a copy of the GNU General Public License
 // along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
 
-#include "mainwidget.h"
+#include "computepool.h"
+#include <QThread>
 
-#include <QApplication>
-
-int main(int argc, char *argv[])
+QThreadPool *computeThreadPool()
 {
-    QApplication a(argc, argv);
-    MainWidget w;
-    w.show();
-    return a.exec();
+    // One thread per core, jobs spread their own work over the cores left free by the others (see parallelfor.h)
+
+    static QThreadPool *pool = nullptr;
+
+    if (pool == nullptr)
+    {
+        pool = new QThreadPool(QCoreApplication::instance());
+        pool->setMaxThreadCount(QThread::idealThreadCount());
+    }
+
+    return pool;
 }
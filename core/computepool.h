@@ -0,0 +1,41 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef COMPUTEPOOL_H
+#define COMPUTEPOOL_H
+
+#include <QCoreApplication>
+#include <QObject>
+#include <QThreadPool>
+
+// Thread pool of CPU bound background jobs (sweeps, fits, ensembles, phase space exports),
+// kept apart from the few threads of the disk bound export pool so that neither starves the other
+// The pool is owned by the application, whose destruction waits for the running jobs
+
+QThreadPool *computeThreadPool();
+
+// Starts a job with a cancel() slot on the compute pool, canceling it when the application quits
+
+template <class Job>
+void startComputeJob(Job *job)
+{
+    QObject::connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, job, &Job::cancel, Qt::DirectConnection);
+
+    computeThreadPool()->start(job);
+}
+
+#endif // COMPUTEPOOL_H
@@ -0,0 +1,78 @@
+TARGET = sirviewcore
+TEMPLATE = lib
+
+# Solver, model definitions and file formats, usable without a GUI
+
+QT = core
+
+CONFIG += staticlib c++17
+
+# The following define makes your compiler emit warnings if you use
+# any Qt feature that has been marked deprecated (the exact warnings
+# depend on your compiler). Please consult the documentation of the
+# deprecated API in order to know how to port your code away from it.
+DEFINES += QT_DEPRECATED_WARNINGS
+
+INCLUDEPATH += C:/Development/boost_1_76_0
+
+SOURCES += \
+    analyticmetrics.cpp \
+    columnarreader.cpp \
+    columnarwriter.cpp \
+    computejob.cpp \
+    computepool.cpp \
+    exportjob.cpp \
+    globalsensitivity.cpp \
+    interventionoptimizer.cpp \
+    mappedfile.cpp \
+    modelcatalog.cpp \
+    montecarloensemble.cpp \
+    observeddata.cpp \
+    parallelfor.cpp \
+    parameterfit.cpp \
+    parametersweep.cpp \
+    phasespaceexportjob.cpp \
+    posteriorsampler.cpp \
+    profilelikelihood.cpp \
+    scenario.cpp \
+    scenariointegrator.cpp \
+    sensitivity.cpp \
+    solveservice.cpp \
+    trajectorycodec.cpp \
+    trajectoryfeed.cpp
+
+HEADERS += \
+    analyticmetrics.h \
+    columnarformat.h \
+    columnarreader.h \
+    columnarwriter.h \
+    computejob.h \
+    computepool.h \
+    dual.h \
+    exportjob.h \
+    globalsensitivity.h \
+    interventionoptimizer.h \
+    mappedfile.h \
+    modelcatalog.h \
+    models.h \
+    montecarloensemble.h \
+    observeddata.h \
+    p2quantile.h \
+    parallelfor.h \
+    parameterfit.h \
+    parametersweep.h \
+    phasespaceexportjob.h \
+    phasespaceintegrator.h \
+    philox.h \
+    posteriorsampler.h \
+    profilelikelihood.h \
+    scenario.h \
+    scenariointegrator.h \
+    sensitivity.h \
+    sobolsequence.h \
+    solveprotocol.h \
+    solveservice.h \
+    trajectorycodec.h \
+    trajectoryfeed.h
+
+QMAKE_CXXFLAGS_RELEASE += /MT
@@ -0,0 +1,86 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#ifndef DUAL_H
+#define DUAL_H
+
+// Dual numbers for forward mode automatic differentiation
+// A value carries its derivatives along up to maxDualTangents directions, e.g. one per
+// model parameter, and arithmetic propagates them with the chain rule
+
+const int maxDualTangents = 4;
+
+struct Dual
+{
+    double value;
+    double d[maxDualTangents];
+
+    Dual(double v = 0.0): value(v)
+    {
+        for (int k = 0; k < maxDualTangents; k++)
+            d[k] = 0.0;
+    }
+};
+
+inline Dual operator-(const Dual &a)
+{
+    Dual r(-a.value);
+    for (int k = 0; k < maxDualTangents; k++) r.d[k] = -a.d[k];
+    return r;
+}
+
+inline Dual operator+(const Dual &a, const Dual &b)
+{
+    Dual r(a.value + b.value);
+    for (int k = 0; k < maxDualTangents; k++) r.d[k] = a.d[k] + b.d[k];
+    return r;
+}
+
+inline Dual operator-(const Dual &a, const Dual &b)
+{
+    Dual r(a.value - b.value);
+    for (int k = 0; k < maxDualTangents; k++) r.d[k] = a.d[k] - b.d[k];
+    return r;
+}
+
+inline Dual operator*(const Dual &a, const Dual &b)
+{
+    Dual r(a.value * b.value);
+    for (int k = 0; k < maxDualTangents; k++) r.d[k] = a.d[k] * b.value + a.value * b.d[k];
+    return r;
+}
+
+inline Dual operator/(const Dual &a, const Dual &b)
+{
+    Dual r(a.value / b.value);
+    for (int k = 0; k < maxDualTangents; k++) r.d[k] = (a.d[k] * b.value - a.value * b.d[k]) / (b.value * b.value);
+    return r;
+}
+
+// Mixed operations with constants, e.g. (1 - x[0]), convert them to duals without derivatives
+
+inline Dual operator+(const Dual &a, double b) { return a + Dual(b); }
+inline Dual operator+(double a, const Dual &b) { return Dual(a) + b; }
+inline Dual operator-(const Dual &a, double b) { return a - Dual(b); }
+inline Dual operator-(double a, const Dual &b) { return Dual(a) - b; }
+inline Dual operator*(const Dual &a, double b) { return a * Dual(b); }
+inline Dual operator*(double a, const Dual &b) { return Dual(a) * b; }
+inline Dual operator/(const Dual &a, double b) { return a / Dual(b); }
+inline Dual operator/(double a, const Dual &b) { return Dual(a) / b; }
+
+#endif // DUAL_H
@@ -0,0 +1,281 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "exportjob.h"
+#include "columnarwriter.h"
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <future>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+ExportJob::ExportJob(const ExportSource &exportSource, QString exportFileName, Format exportFormat)
+{
+    source = exportSource;
+    fileName = exportFileName;
+    format = exportFormat;
+
+    canceled = false;
+
+    bytesWritten = 0;
+    bytesTotal = 0;
+    progressBase = 0.0;
+    progressSpan = 1.0;
+    lastPercent = -1;
+
+    // Deleted by the receiver of finished()
+
+    setAutoDelete(false);
+}
+
+void ExportJob::run()
+{
+    bool success = execute();
+
+    emit finished(success, canceled);
+}
+
+void ExportJob::cancel()
+{
+    canceled = true;
+}
+
+QString ExportJob::getFileName() const
+{
+    return fileName;
+}
+
+QThreadPool *ExportJob::threadPool()
+{
+    // Few threads, since jobs are bound by disk I/O
+
+    static QThreadPool *pool = nullptr;
+
+    if (pool == nullptr)
+    {
+        pool = new QThreadPool(QCoreApplication::instance());
+        pool->setMaxThreadCount(2);
+    }
+
+    return pool;
+}
+
+bool ExportJob::execute()
+{
+    reportProgress(0.0);
+
+    // "-" writes to the standard output, as used by the headless solver
+
+    bool standardOutput = fileName == "-";
+
+    // The C runtime must not translate line endings of the standard output on Windows:
+    // it would corrupt binary output, and text output is already translated by QFile
+
+#ifdef _WIN32
+    if (standardOutput)
+    {
+        std::fflush(stdout);
+        _setmode(_fileno(stdout), _O_BINARY);
+    }
+#endif
+
+    QFile file(standardOutput ? QString() : fileName);
+
+    QIODevice::OpenMode mode = QIODevice::WriteOnly;
+
+    if (format != Columnar)
+        mode |= QIODevice::Text;
+
+    bool opened = standardOutput ? file.open(stdout, mode) : file.open(mode);
+
+    bool success = false;
+
+    if (opened)
+    {
+        if (format == Columnar)
+            success = exportColumnar(file);
+        else
+            success = exportText(file, format == FullPrecisionText);
+    }
+
+    file.close();
+
+    if (canceled && !standardOutput)
+    {
+        file.remove();
+        return false;
+    }
+
+    return success;
+}
+
+bool ExportJob::writeBlock(QFile &file, const void *block, qint64 size)
+{
+    // Large blocks are written in pieces to report progress and respond to cancellation
+
+    const qint64 pieceSize = 4 << 20;
+
+    const char *data = reinterpret_cast<const char*>(block);
+
+    for (qint64 position = 0; position < size; position += pieceSize)
+    {
+        if (canceled)
+            return false;
+
+        qint64 length = std::min(pieceSize, size - position);
+
+        if (file.write(data + position, length) != length)
+            return false;
+
+        bytesWritten += length;
+
+        if (bytesTotal > 0)
+            reportProgress(progressBase + progressSpan * bytesWritten / bytesTotal);
+    }
+
+    return true;
+}
+
+void ExportJob::reportProgress(double fraction)
+{
+    int percent = static_cast<int>(100.0 * fraction);
+
+    if (percent != lastPercent)
+    {
+        lastPercent = percent;
+        emit progressChanged(percent);
+    }
+}
+
+// Appends a double formatted as QTextStream does by default (6 significant digits),
+// or in its shortest form that round-trips exactly
+
+static char *appendDouble(char *out, double value, bool fullPrecision)
+{
+    std::to_chars_result result;
+
+    if (fullPrecision)
+        result = std::to_chars(out, out + 32, value);
+    else
+        result = std::to_chars(out, out + 32, value, std::chars_format::general, 6);
+
+    return result.ptr;
+}
+
+std::string ExportJob::formatScenarioText(size_t scenarioIndex, bool fullPrecision) const
+{
+    const Scenario &scenario = source.scenarios[scenarioIndex];
+
+    const std::vector<state_type> &steps = scenario.trajectory->steps;
+    const std::vector<double> &times = scenario.trajectory->times;
+
+    size_t j = switchStepIndex(source.scenarios, scenarioIndex);
+    bool last = scenarioIndex + 1 == source.scenarios.size();
+
+    // Each value takes at most 32 characters including its separator
+
+    size_t lineSize = 32 * (1 + source.dimension + scenario.parameters.size()) + 2;
+
+    std::string text(lineSize * times.size() + 1, '\0');
+
+    char *out = &text[0];
+
+    for (size_t i = 0; i < times.size(); i++)
+    {
+        if (i % 65536 == 0 && canceled)
+            return std::string();
+
+        out = appendDouble(out, times[i], fullPrecision);
+        *out++ = '\t';
+
+        for (auto var : steps[i])
+        {
+            out = appendDouble(out, var, fullPrecision);
+            *out++ = '\t';
+        }
+
+        for (auto param : scenario.parameters)
+        {
+            out = appendDouble(out, param, fullPrecision);
+            *out++ = '\t';
+        }
+
+        *out++ = (!last && i >= j) ? '1' : '0';
+        *out++ = '\n';
+    }
+
+    *out++ = '\n';
+
+    text.resize(out - text.data());
+
+    return text;
+}
+
+bool ExportJob::exportText(QFile &file, bool fullPrecision)
+{
+    // One chunk per scenario, formatted concurrently, then written in order
+    // Formatting accounts for the first half of the progress
+
+    std::vector<std::future<std::string>> futures;
+
+    for (size_t s = 0; s < source.scenarios.size(); s++)
+    {
+        futures.push_back(std::async(std::launch::async, &ExportJob::formatScenarioText, this, s, fullPrecision));
+    }
+
+    std::vector<std::string> chunks;
+
+    for (size_t s = 0; s < futures.size(); s++)
+    {
+        chunks.push_back(futures[s].get());
+        bytesTotal += static_cast<qint64>(chunks.back().size());
+
+        reportProgress(0.5 * (s + 1) / futures.size());
+    }
+
+    if (canceled)
+        return false;
+
+    progressBase = 0.5;
+    progressSpan = 0.5;
+
+    for (size_t s = 0; s < chunks.size(); s++)
+    {
+        if (!writeBlock(file, chunks[s].data(), static_cast<qint64>(chunks[s].size())))
+            return false;
+
+        std::string().swap(chunks[s]);
+    }
+
+    return true;
+}
+
+bool ExportJob::exportColumnar(QFile &file)
+{
+    ColumnarWriter writer(source);
+
+    bytesTotal = static_cast<qint64>(writer.getSize());
+
+    return writer.write([&](const void *block, uint64_t size){
+        return writeBlock(file, block, static_cast<qint64>(size));
+    });
+}
@@ -0,0 +1,100 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef EXPORTJOB_H
+#define EXPORTJOB_H
+
+#include "scenario.h"
+#include "columnarformat.h"
+#include <atomic>
+#include <string>
+#include <vector>
+#include <QObject>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QCoreApplication>
+#include <QString>
+#include <QFile>
+
+// Model metadata and scenarios to export
+// Scenarios share their solved trajectories, which are never modified once solved,
+// so the model can keep changing while the export runs
+
+struct ExportSource
+{
+    QString modelName;
+    int modelIndex;
+    int dimension;
+    std::vector<QString> variableShortNames;
+    std::vector<QString> variableLongNames;
+    std::vector<QString> parameterNames;
+    std::vector<Scenario> scenarios;
+};
+
+// Export of scenarios data running on a background I/O thread pool
+// Reports progress as a percentage and can be canceled at any time,
+// in which case the partially written file is removed
+
+class ExportJob: public QObject, public QRunnable
+{
+    Q_OBJECT
+
+public:
+    enum Format
+    {
+        Text,
+        FullPrecisionText,
+        Columnar
+    };
+
+    ExportJob(const ExportSource &exportSource, QString exportFileName, Format exportFormat);
+
+    void run() override;
+    void cancel();
+
+    QString getFileName() const;
+
+    static QThreadPool *threadPool();
+
+signals:
+    void progressChanged(int percent);
+    void finished(bool success, bool canceled);
+
+private:
+    ExportSource source;
+    QString fileName;
+    Format format;
+
+    std::atomic<bool> canceled;
+
+    qint64 bytesWritten;
+    qint64 bytesTotal;
+    double progressBase;
+    double progressSpan;
+    int lastPercent;
+
+    bool execute();
+    bool exportText(QFile &file, bool fullPrecision);
+    bool exportColumnar(QFile &file);
+
+    bool writeBlock(QFile &file, const void *block, qint64 size);
+    void reportProgress(double fraction);
+
+    std::string formatScenarioText(size_t scenarioIndex, bool fullPrecision) const;
+};
+
+#endif // EXPORTJOB_H
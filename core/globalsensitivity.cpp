@@ -0,0 +1,344 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "globalsensitivity.h"
+#include "scenariointegrator.h"
+#include "montecarloensemble.h"
+#include "sobolsequence.h"
+#include "modelcatalog.h"
+#include "parallelfor.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+
+GlobalSensitivity::GlobalSensitivity(const GlobalSensitivitySettings &sensitivitySettings): settings(sensitivitySettings)
+{
+    // Infected compartment, with the asymptomatic one in the SIRA model, unknown models fail validation
+
+    infectedIndex = asymptomaticIndex = -1;
+
+    if (isScenarioModel(settings.modelIndex))
+    {
+        infectedIndex = scenarioModelDefinitions()[settings.modelIndex].infectedIndex;
+        asymptomaticIndex = scenarioModelDefinitions()[settings.modelIndex].asymptomaticIndex;
+    }
+
+    if (!settings.scenarios.empty())
+        times = MonteCarloEnsemble::chainGrid(settings.scenarios, settings.numTimes);
+}
+
+bool GlobalSensitivity::validate(std::string &error) const
+{
+    if (!isScenarioModel(settings.modelIndex) || settings.scenarios.empty())
+    {
+        error = "Unknown model";
+        return false;
+    }
+
+    size_t numParameters = settings.scenarios.front().parameters.size();
+
+    if (2 * numParameters > static_cast<size_t>(SobolSequence::maxDimension))
+    {
+        error = "Too many parameters";
+        return false;
+    }
+
+    if (settings.parameterMin.size() != numParameters || settings.parameterMax.size() != numParameters)
+    {
+        error = "Missing parameter ranges";
+        return false;
+    }
+
+    for (size_t k = 0; k < numParameters; k++)
+    {
+        if (!(settings.parameterMin[k] <= settings.parameterMax[k]))
+        {
+            error = "Parameter minimum greater than maximum";
+            return false;
+        }
+    }
+
+    if (settings.numSamples < 2 || settings.numSamples > maxSamples)
+    {
+        error = "Number of samples must be between 2 and " + std::to_string(maxSamples);
+        return false;
+    }
+
+    if (settings.numTimes < 2)
+    {
+        error = "At least two grid times are needed";
+        return false;
+    }
+
+    return true;
+}
+
+int GlobalSensitivity::getNumEvaluations() const
+{
+    return settings.numSamples * (static_cast<int>(settings.scenarios.front().parameters.size()) + 2);
+}
+
+const std::vector<SobolIndices> &GlobalSensitivity::getMetricIndices() const
+{
+    return metricIndices;
+}
+
+const std::vector<double> &GlobalSensitivity::getTimes() const
+{
+    return times;
+}
+
+const std::vector<SobolIndices> &GlobalSensitivity::getTimeIndices() const
+{
+    return timeIndices;
+}
+
+const char *GlobalSensitivity::metricName(int metric)
+{
+    static const char *names[NumMetrics] = {"PeakInfected", "PeakTime", "FinalSize"};
+    return names[metric];
+}
+
+// Outputs of one evaluation: the metrics followed by the infected fraction at every grid time
+
+void GlobalSensitivity::evaluate(const std::vector<double> &parameters, std::vector<double> &buffer, double *outputs) const
+{
+    std::vector<Scenario> scenarios = settings.scenarios;
+
+    const std::vector<double> &firstParameters = settings.scenarios.front().parameters;
+
+    for (Scenario &scenario : scenarios)
+    {
+        for (size_t k = 0; k < firstParameters.size(); k++)
+        {
+            double value = scenario.parameters[k] + parameters[k] - firstParameters[k];
+            scenario.parameters[k] = std::min(std::max(value, scenario.parametersMin[k]), scenario.parametersMax[k]);
+        }
+    }
+
+    size_t dimension = scenarios.front().x0.size();
+
+    buffer.resize(times.size() * dimension);
+
+    integrateChainOnGrid(settings.modelIndex, scenarios, times, buffer.data());
+
+    double peakInfected = -1.0;
+    double peakTime = times.front();
+
+    for (size_t n = 0; n < times.size(); n++)
+    {
+        double infected = buffer[n * dimension + infectedIndex] + (asymptomaticIndex >= 0 ? buffer[n * dimension + asymptomaticIndex] : 0.0);
+
+        if (infected > peakInfected)
+        {
+            peakInfected = infected;
+            peakTime = times[n];
+        }
+
+        outputs[NumMetrics + n] = infected;
+    }
+
+    outputs[PeakInfected] = peakInfected;
+    outputs[PeakTime] = peakTime;
+    outputs[FinalSize] = scenarios.front().x0[0] - buffer[(times.size() - 1) * dimension];
+}
+
+bool GlobalSensitivity::run(const std::atomic<bool> &canceled, const std::function<void(double)> &progress)
+{
+    int numParameters = static_cast<int>(settings.scenarios.front().parameters.size());
+    int numSamples = settings.numSamples;
+    size_t numOutputs = NumMetrics + times.size();
+
+    // Rows of A and B from the first and last halves of the coordinates of each point
+
+    std::vector<double> a(static_cast<size_t>(numSamples) * numParameters), b(a.size());
+
+    SobolSequence sequence(2 * numParameters);
+    std::vector<double> point(2 * numParameters);
+
+    for (int j = 0; j < numSamples; j++)
+    {
+        sequence.next(point.data());
+
+        for (int k = 0; k < numParameters; k++)
+        {
+            double width = settings.parameterMax[k] - settings.parameterMin[k];
+
+            a[j * numParameters + k] = settings.parameterMin[k] + width * point[k];
+            b[j * numParameters + k] = settings.parameterMin[k] + width * point[numParameters + k];
+        }
+    }
+
+    // Each batch of base samples accumulates its own sums, reduced in batch order at the end
+    // so that results do not depend on scheduling. Per output: sums of f(A), f(B), their
+    // squares, and per parameter those of f(B) (f(AB) - f(A)) and (f(A) - f(AB))^2
+
+    const int batchSize = 64;
+    int numBatches = (numSamples + batchSize - 1) / batchSize;
+
+    size_t sumsSize = numOutputs * (4 + 2 * numParameters);
+
+    std::vector<std::vector<double>> batchSums(numBatches);
+
+    std::atomic<int> doneSamples(0);
+
+    parallelFor(numBatches, canceled, [&](size_t index, int){
+        int batch = static_cast<int>(index);
+
+        std::vector<double> buffer, parameters(numParameters);
+        std::vector<double> fa(numOutputs), fb(numOutputs), fab(numOutputs);
+
+        std::vector<double> &sums = batchSums[batch];
+        sums.assign(sumsSize, 0.0);
+
+        for (int j = batch * batchSize; j < std::min(numSamples, (batch + 1) * batchSize); j++)
+        {
+            parameters.assign(&a[j * numParameters], &a[j * numParameters] + numParameters);
+            evaluate(parameters, buffer, fa.data());
+
+            parameters.assign(&b[j * numParameters], &b[j * numParameters] + numParameters);
+            evaluate(parameters, buffer, fb.data());
+
+            for (size_t o = 0; o < numOutputs; o++)
+            {
+                double *s = &sums[o * (4 + 2 * numParameters)];
+
+                s[0] += fa[o];
+                s[1] += fb[o];
+                s[2] += fa[o] * fa[o];
+                s[3] += fb[o] * fb[o];
+            }
+
+            for (int i = 0; i < numParameters; i++)
+            {
+                parameters.assign(&a[j * numParameters], &a[j * numParameters] + numParameters);
+                parameters[i] = b[j * numParameters + i];
+                evaluate(parameters, buffer, fab.data());
+
+                for (size_t o = 0; o < numOutputs; o++)
+                {
+                    double *s = &sums[o * (4 + 2 * numParameters)];
+
+                    s[4 + 2 * i] += fb[o] * (fab[o] - fa[o]);
+                    s[5 + 2 * i] += (fa[o] - fab[o]) * (fa[o] - fab[o]);
+                }
+            }
+
+            doneSamples++;
+        }
+    }, [&](){
+        if (progress)
+            progress(static_cast<double>(doneSamples) / numSamples);
+    });
+
+    if (canceled)
+        return false;
+
+    std::vector<double> sums(sumsSize, 0.0);
+
+    for (int batch = 0; batch < numBatches; batch++)
+        for (size_t i = 0; i < sumsSize; i++)
+            sums[i] += batchSums[batch][i];
+
+    // Indices, with the variance of f over A and B together
+
+    std::vector<SobolIndices> indices(numOutputs);
+
+    for (size_t o = 0; o < numOutputs; o++)
+    {
+        const double *s = &sums[o * (4 + 2 * numParameters)];
+
+        double mean = (s[0] + s[1]) / (2.0 * numSamples);
+        double variance = (s[2] + s[3]) / (2.0 * numSamples) - mean * mean;
+
+        indices[o].firstOrder.assign(numParameters, NAN);
+        indices[o].totalEffect.assign(numParameters, NAN);
+
+        // Outputs that do not vary, e.g. at the start of the chain, have no indices
+
+        if (!(variance > 1.0e-14 * std::max(1.0, mean * mean)))
+            continue;
+
+        for (int i = 0; i < numParameters; i++)
+        {
+            indices[o].firstOrder[i] = s[4 + 2 * i] / numSamples / variance;
+            indices[o].totalEffect[i] = 0.5 * s[5 + 2 * i] / numSamples / variance;
+        }
+    }
+
+    metricIndices.assign(indices.begin(), indices.begin() + NumMetrics);
+    timeIndices.assign(indices.begin() + NumMetrics, indices.end());
+
+    if (progress)
+        progress(1.0);
+
+    return true;
+}
+
+bool GlobalSensitivity::writeText(const std::string &fileName) const
+{
+    std::FILE *file = std::fopen(fileName.c_str(), "wb");
+
+    if (file == nullptr)
+        return false;
+
+    const ModelDefinition &definition = scenarioModelDefinitions()[settings.modelIndex];
+
+    std::string text = "# " + definition.name.toStdString() + " Sobol indices, " + std::to_string(settings.numSamples) + " base samples\n";
+
+    // Column names, first-order then total-effect index of each parameter
+
+    std::string header;
+
+    for (const QString &name : definition.parameterNames)
+        header += "\tS_" + name.toStdString();
+
+    for (const QString &name : definition.parameterNames)
+        header += "\tST_" + name.toStdString();
+
+    header += "\n";
+
+    char number[32];
+
+    auto appendRow = [&](const std::string &label, const SobolIndices &row){
+        text += label;
+
+        for (double value : row.firstOrder)
+            text += "\t" + std::string(number, std::to_chars(number, number + sizeof(number), value).ptr);
+
+        for (double value : row.totalEffect)
+            text += "\t" + std::string(number, std::to_chars(number, number + sizeof(number), value).ptr);
+
+        text += "\n";
+    };
+
+    text += "Metric" + header;
+
+    for (int metric = 0; metric < NumMetrics && metric < static_cast<int>(metricIndices.size()); metric++)
+        appendRow(metricName(metric), metricIndices[metric]);
+
+    text += "\nTime" + header;
+
+    for (size_t n = 0; n < timeIndices.size(); n++)
+        appendRow(std::string(number, std::to_chars(number, number + sizeof(number), times[n]).ptr), timeIndices[n]);
+
+    bool success = std::fwrite(text.data(), 1, text.size(), file) == text.size();
+
+    return std::fclose(file) == 0 && success;
+}
@@ -0,0 +1,97 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#ifndef GLOBALSENSITIVITY_H
+#define GLOBALSENSITIVITY_H
+
+#include "scenario.h"
+#include <atomic>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Variance-based global sensitivity of a scenario chain to its parameters
+// Sobol first-order and total-effect indices by Saltelli sampling on a Sobol sequence:
+// with base samples A and B, and A with the column of parameter i taken from B, the
+// indices follow from the estimators of Saltelli et al. (2010) and Jansen (1999)
+// A parameter takes its sampled value in the first scenario and shifts the others by
+// the same amount, as in the least-squares fit
+// Outputs are summary metrics and the infected fraction on a grid over the chain
+
+struct GlobalSensitivitySettings
+{
+    int modelIndex;
+    std::vector<Scenario> scenarios;
+
+    // Range of each parameter
+
+    std::vector<double> parameterMin;
+    std::vector<double> parameterMax;
+
+    int numSamples;
+    int numTimes;
+};
+
+struct SobolIndices
+{
+    std::vector<double> firstOrder;
+    std::vector<double> totalEffect;
+};
+
+class GlobalSensitivity
+{
+public:
+    enum Metric {PeakInfected, PeakTime, FinalSize, NumMetrics};
+
+    static const int maxSamples = 1 << 20;
+
+    explicit GlobalSensitivity(const GlobalSensitivitySettings &sensitivitySettings);
+
+    bool validate(std::string &error) const;
+
+    int getNumEvaluations() const;
+
+    // Indices of each metric and of the infected fraction at each grid time
+
+    const std::vector<SobolIndices> &getMetricIndices() const;
+    const std::vector<double> &getTimes() const;
+    const std::vector<SobolIndices> &getTimeIndices() const;
+
+    // Evaluations are done in parallel in batches of base samples, progress is reported
+    // from the calling thread as a fraction
+
+    bool run(const std::atomic<bool> &canceled, const std::function<void(double)> &progress);
+
+    bool writeText(const std::string &fileName) const;
+
+    static const char *metricName(int metric);
+
+private:
+    GlobalSensitivitySettings settings;
+
+    int infectedIndex;
+    int asymptomaticIndex;
+
+    std::vector<double> times;
+    std::vector<SobolIndices> metricIndices;
+    std::vector<SobolIndices> timeIndices;
+
+    void evaluate(const std::vector<double> &parameters, std::vector<double> &buffer, double *outputs) const;
+};
+
+#endif // GLOBALSENSITIVITY_H
@@ -0,0 +1,394 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "interventionoptimizer.h"
+#include "modelcatalog.h"
+#include "montecarloensemble.h"
+#include "parallelfor.h"
+#include "philox.h"
+#include "scenariointegrator.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+InterventionOptimizer::InterventionOptimizer(const InterventionSettings &interventionSettings): settings(interventionSettings)
+{
+    // Infected compartment, with the asymptomatic one in the SIRA model, unknown models fail validation
+
+    infectedIndex = asymptomaticIndex = -1;
+
+    if (isScenarioModel(settings.modelIndex))
+    {
+        infectedIndex = scenarioModelDefinitions()[settings.modelIndex].infectedIndex;
+        asymptomaticIndex = scenarioModelDefinitions()[settings.modelIndex].asymptomaticIndex;
+    }
+
+    if (!settings.scenarios.empty())
+        times = MonteCarloEnsemble::chainGrid(settings.scenarios, settings.numTimes);
+
+    result.objective = std::numeric_limits<double>::quiet_NaN();
+    result.metric = result.cost = result.objective;
+    result.initialObjective = result.initialMetric = result.initialCost = result.objective;
+    result.generations = 0;
+    result.evaluations = 0;
+}
+
+bool InterventionOptimizer::validate(std::string &error) const
+{
+    if (!isScenarioModel(settings.modelIndex) || settings.scenarios.empty())
+    {
+        error = "Unknown model";
+        return false;
+    }
+
+    if (settings.scenarios.size() < 2)
+    {
+        error = "Add at least one scenario after the first one as an intervention";
+        return false;
+    }
+
+    if (settings.parameterIndex < 0 || settings.parameterIndex >= static_cast<int>(settings.scenarios.front().parameters.size()))
+    {
+        error = "Unknown parameter";
+        return false;
+    }
+
+    if (settings.objective < 0 || settings.objective >= NumObjectives)
+    {
+        error = "Unknown objective";
+        return false;
+    }
+
+    if (!(settings.durationCost >= 0.0))
+    {
+        error = "Duration cost must not be negative";
+        return false;
+    }
+
+    if (settings.populationSize < 4 || settings.populationSize > maxPopulation)
+    {
+        error = "Population size must be between 4 and " + std::to_string(maxPopulation);
+        return false;
+    }
+
+    if (settings.numGenerations < 1)
+    {
+        error = "Number of generations must be positive";
+        return false;
+    }
+
+    if (settings.numTimes < 2)
+    {
+        error = "At least two grid times are needed";
+        return false;
+    }
+
+    if (!(settings.scenarios.back().timeEnd > settings.scenarios.front().timeStart))
+    {
+        error = "The scenarios span no time";
+        return false;
+    }
+
+    return true;
+}
+
+const InterventionResult &InterventionOptimizer::getResult() const
+{
+    return result;
+}
+
+const std::vector<double> &InterventionOptimizer::getHistory() const
+{
+    return history;
+}
+
+const char *InterventionOptimizer::objectiveName(int objective)
+{
+    static const char *names[NumObjectives] = {"Peak infected", "Final size"};
+    return names[objective];
+}
+
+int InterventionOptimizer::getNumCoordinates() const
+{
+    int numInterventions = static_cast<int>(settings.scenarios.size()) - 1;
+
+    return settings.optimizeTimes ? 2 * numInterventions : numInterventions;
+}
+
+// Levels of the interventions scaled to their slider ranges, then switch times scaled to the chain
+
+std::vector<double> InterventionOptimizer::initialCoordinates() const
+{
+    const std::vector<Scenario> &scenarios = settings.scenarios;
+    int k = settings.parameterIndex;
+
+    double timeStart = scenarios.front().timeStart;
+    double timeEnd = scenarios.back().timeEnd;
+
+    std::vector<double> coordinates;
+
+    for (size_t s = 1; s < scenarios.size(); s++)
+    {
+        double range = scenarios[s].parametersMax[k] - scenarios[s].parametersMin[k];
+        coordinates.push_back(range > 0.0 ? (scenarios[s].parameters[k] - scenarios[s].parametersMin[k]) / range : 0.5);
+    }
+
+    if (settings.optimizeTimes)
+    {
+        for (size_t s = 1; s < scenarios.size(); s++)
+            coordinates.push_back((scenarios[s].timeStart - timeStart) / (timeEnd - timeStart));
+    }
+
+    for (double &coordinate : coordinates)
+        coordinate = std::clamp(coordinate, 0.0, 1.0);
+
+    return coordinates;
+}
+
+std::vector<Scenario> InterventionOptimizer::schedule(const std::vector<double> &coordinates) const
+{
+    std::vector<Scenario> scenarios = settings.scenarios;
+    int k = settings.parameterIndex;
+    size_t numInterventions = scenarios.size() - 1;
+
+    for (size_t s = 1; s < scenarios.size(); s++)
+    {
+        Scenario &scenario = scenarios[s];
+        scenario.parameters[k] = scenario.parametersMin[k] + coordinates[s - 1] * (scenario.parametersMax[k] - scenario.parametersMin[k]);
+    }
+
+    // Switch times in increasing order, each scenario ending where the next one starts
+
+    if (settings.optimizeTimes)
+    {
+        double timeStart = scenarios.front().timeStart;
+        double timeEnd = scenarios.back().timeEnd;
+
+        std::vector<double> switchTimes(coordinates.begin() + numInterventions, coordinates.end());
+        std::sort(switchTimes.begin(), switchTimes.end());
+
+        for (size_t s = 1; s < scenarios.size(); s++)
+        {
+            double time = timeStart + switchTimes[s - 1] * (timeEnd - timeStart);
+
+            scenarios[s].timeStart = time;
+            scenarios[s - 1].timeEnd = time;
+            scenarios[s - 1].timeEndMax = std::max(scenarios[s - 1].timeEndMax, time);
+        }
+    }
+
+    return scenarios;
+}
+
+double InterventionOptimizer::evaluate(const std::vector<Scenario> &scenarios, std::vector<double> &buffer, double &metric, double &cost) const
+{
+    size_t dimension = scenarios.front().x0.size();
+    int k = settings.parameterIndex;
+
+    buffer.resize(times.size() * dimension);
+
+    integrateChainOnGrid(settings.modelIndex, scenarios, times, buffer.data());
+
+    if (settings.objective == PeakInfected)
+    {
+        metric = -1.0;
+
+        for (size_t n = 0; n < times.size(); n++)
+            metric = std::max(metric, buffer[n * dimension + infectedIndex] + (asymptomaticIndex >= 0 ? buffer[n * dimension + asymptomaticIndex] : 0.0));
+    }
+    else
+    {
+        metric = scenarios.front().x0[0] - buffer[(times.size() - 1) * dimension];
+    }
+
+    // Duration of each intervention, as integrated, times its relative reduction
+
+    double baseline = scenarios.front().parameters[k];
+
+    cost = 0.0;
+
+    for (size_t s = 1; s < scenarios.size() && baseline > 0.0; s++)
+    {
+        bool last = s + 1 == scenarios.size();
+        double timeSwitch = last ? scenarios[s].timeEnd : std::min(scenarios[s].timeEnd, std::max(scenarios[s].timeStart, scenarios[s + 1].timeStart));
+
+        cost += std::max(timeSwitch - scenarios[s].timeStart, 0.0) * std::max(baseline - scenarios[s].parameters[k], 0.0) / baseline;
+    }
+
+    double objective = metric + settings.durationCost * cost;
+
+    return std::isfinite(objective) ? objective : std::numeric_limits<double>::infinity();
+}
+
+bool InterventionOptimizer::run(const std::atomic<bool> &canceled, const std::function<void(double)> &progress)
+{
+    int d = getNumCoordinates();
+    int lambda = settings.populationSize;
+    int mu = lambda / 2;
+
+    // Recombination weights and strategy constants of the separable CMA-ES
+
+    std::vector<double> weights(mu);
+
+    for (int i = 0; i < mu; i++)
+        weights[i] = std::log(mu + 0.5) - std::log(i + 1.0);
+
+    double sumWeights = std::accumulate(weights.begin(), weights.end(), 0.0);
+
+    for (double &weight : weights)
+        weight /= sumWeights;
+
+    double sumSquaredWeights = 0.0;
+
+    for (double weight : weights)
+        sumSquaredWeights += weight * weight;
+
+    double muEff = 1.0 / sumSquaredWeights;
+
+    double cSigma = (muEff + 2.0) / (d + muEff + 5.0);
+    double dSigma = 1.0 + 2.0 * std::max(0.0, std::sqrt((muEff - 1.0) / (d + 1.0)) - 1.0) + cSigma;
+    double expectedNorm = std::sqrt(static_cast<double>(d)) * (1.0 - 1.0 / (4.0 * d) + 1.0 / (21.0 * d * d));
+    double cMu = std::min(1.0, (d + 2.0) / 3.0 * 2.0 * (muEff - 2.0 + 1.0 / muEff) / ((d + 2.0) * (d + 2.0) + muEff));
+
+    std::vector<double> mean = initialCoordinates();
+    std::vector<double> variances(d, 1.0);
+    std::vector<double> path(d, 0.0);
+    double sigma = 0.3;
+
+    // The given schedule is the first best
+
+    std::vector<double> buffer;
+    std::vector<double> bestCoordinates = mean;
+
+    result.initialObjective = evaluate(schedule(mean), buffer, result.initialMetric, result.initialCost);
+
+    double bestObjective = result.initialObjective;
+
+    std::vector<std::vector<double>> candidates(lambda, std::vector<double>(d));
+    std::vector<double> objectives(lambda);
+
+    std::vector<std::vector<double>> threadBuffers(parallelThreadCount(lambda));
+
+    history.clear();
+    result.evaluations = 1;
+    result.generations = 0;
+
+    for (int generation = 0; generation < settings.numGenerations && !canceled; generation++)
+    {
+        // Candidates depend on the generation and member only, mirrored into the unit box
+
+        for (int member = 0; member < lambda; member++)
+        {
+            Philox generator(settings.seed, static_cast<uint64_t>(generation) * maxPopulation + member);
+
+            for (int j = 0; j < d; j++)
+            {
+                double x = mean[j] + sigma * std::sqrt(variances[j]) * generator.normal();
+
+                x = std::fmod(std::fabs(x), 2.0);
+                candidates[member][j] = x > 1.0 ? 2.0 - x : x;
+            }
+        }
+
+        // Candidates are spread over threads
+
+        parallelFor(lambda, canceled, [&](size_t member, int thread){
+            double metric, cost;
+            objectives[member] = evaluate(schedule(candidates[member]), threadBuffers[thread], metric, cost);
+        });
+
+        if (canceled)
+            break;
+
+        result.evaluations += lambda;
+        result.generations = generation + 1;
+
+        // Ranking with ties broken by member, so that it is independent of scheduling
+
+        std::vector<int> order(lambda);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](int a, int b){ return objectives[a] < objectives[b]; });
+
+        if (objectives[order[0]] < bestObjective)
+        {
+            bestObjective = objectives[order[0]];
+            bestCoordinates = candidates[order[0]];
+        }
+
+        history.push_back(bestObjective);
+
+        // Mean, step-size path and diagonal covariance from the selected steps
+
+        std::vector<double> newMean(d, 0.0);
+
+        for (int i = 0; i < mu; i++)
+            for (int j = 0; j < d; j++)
+                newMean[j] += weights[i] * candidates[order[i]][j];
+
+        double pathNorm = 0.0;
+
+        for (int j = 0; j < d; j++)
+        {
+            double z = (newMean[j] - mean[j]) / (sigma * std::sqrt(variances[j]));
+
+            path[j] = (1.0 - cSigma) * path[j] + std::sqrt(cSigma * (2.0 - cSigma) * muEff) * z;
+            pathNorm += path[j] * path[j];
+        }
+
+        for (int j = 0; j < d; j++)
+        {
+            double rankMu = 0.0;
+
+            for (int i = 0; i < mu; i++)
+            {
+                double y = (candidates[order[i]][j] - mean[j]) / sigma;
+                rankMu += weights[i] * y * y;
+            }
+
+            variances[j] = (1.0 - cMu) * variances[j] + cMu * rankMu;
+        }
+
+        mean = newMean;
+        sigma *= std::exp((cSigma / dSigma) * (std::sqrt(pathNorm) / expectedNorm - 1.0));
+        sigma = std::min(sigma, 1.0);
+
+        if (progress)
+            progress(static_cast<double>(generation + 1) / settings.numGenerations);
+
+        if (sigma * std::sqrt(*std::max_element(variances.begin(), variances.end())) < 1.0e-8)
+            break;
+    }
+
+    if (canceled)
+        return false;
+
+    result.scenarios = schedule(bestCoordinates);
+    result.objective = evaluate(result.scenarios, buffer, result.metric, result.cost);
+
+    result.switchTimes.clear();
+    result.levels.clear();
+
+    for (size_t s = 1; s < result.scenarios.size(); s++)
+    {
+        result.switchTimes.push_back(result.scenarios[s].timeStart);
+        result.levels.push_back(result.scenarios[s].parameters[settings.parameterIndex]);
+    }
+
+    return true;
+}
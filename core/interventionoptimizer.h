@@ -0,0 +1,116 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#ifndef INTERVENTIONOPTIMIZER_H
+#define INTERVENTIONOPTIMIZER_H
+
+#include "scenario.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Search of an intervention schedule over a scenario chain
+// The first scenario is the baseline, and every later one is an intervention that sets
+// one parameter to a level within its slider range from its start until the next one
+// The levels and, optionally, the switch times minimize an objective, the peak infected
+// or the final size, plus a cost proportional to the duration of each intervention
+// times its relative reduction of the parameter from the baseline value
+// The search is a separable CMA evolution strategy on normalized coordinates, whose
+// candidates are solved concurrently on the chain grid
+
+struct InterventionSettings
+{
+    int modelIndex;
+    std::vector<Scenario> scenarios;
+
+    int parameterIndex;
+    int objective;
+    double durationCost;
+    bool optimizeTimes;
+
+    int populationSize;
+    int numGenerations;
+    uint64_t seed;
+    int numTimes;
+};
+
+struct InterventionResult
+{
+    // Start and level of each intervention, the scenarios but the first one
+
+    std::vector<double> switchTimes;
+    std::vector<double> levels;
+
+    std::vector<Scenario> scenarios;
+
+    double objective;
+    double metric;
+    double cost;
+
+    // Same for the schedule of the given scenarios
+
+    double initialObjective;
+    double initialMetric;
+    double initialCost;
+
+    int generations;
+    int evaluations;
+};
+
+class InterventionOptimizer
+{
+public:
+    enum Objective {PeakInfected, FinalSize, NumObjectives};
+
+    static const int maxPopulation = 1024;
+
+    explicit InterventionOptimizer(const InterventionSettings &interventionSettings);
+
+    bool validate(std::string &error) const;
+
+    const InterventionResult &getResult() const;
+
+    // Best objective at each generation
+
+    const std::vector<double> &getHistory() const;
+
+    // Progress is reported from the calling thread as a fraction
+
+    bool run(const std::atomic<bool> &canceled, const std::function<void(double)> &progress);
+
+    static const char *objectiveName(int objective);
+
+private:
+    InterventionSettings settings;
+
+    int infectedIndex;
+    int asymptomaticIndex;
+    std::vector<double> times;
+
+    InterventionResult result;
+    std::vector<double> history;
+
+    int getNumCoordinates() const;
+    std::vector<double> initialCoordinates() const;
+    std::vector<Scenario> schedule(const std::vector<double> &coordinates) const;
+    double evaluate(const std::vector<Scenario> &scenarios, std::vector<double> &buffer, double &metric, double &cost) const;
+};
+
+#endif // INTERVENTIONOPTIMIZER_H
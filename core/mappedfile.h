@@ -15,32 +15,38 @@
 // You should have received a copy of the GNU General Public License
 // along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
 
-#ifndef SNAPSHOT_H
-#define SNAPSHOT_H
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
 
-#include "scenariomodel.h"
-#include "qcustomplot.h"
-#include <QWidget>
-#include <QPen>
+#include <cstddef>
+#include <string>
 
-class Snapshot: public QWidget
-{
-    Q_OBJECT
+// Read-only memory map of a whole file
+// Uses mmap, or CreateFileMapping on Windows
 
+class MappedFile
+{
 public:
-    QWidget *plotsGridWidget;
+    MappedFile();
+    ~MappedFile();
 
-    Snapshot(ScenarioModel *model);
-    ~Snapshot();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile &operator=(const MappedFile&) = delete;
 
-private:
-    std::vector<QCustomPlot*> plots;
+    bool open(const std::string &fileName);
+    void close();
 
-    Qt::GlobalColor colors[14];
+    const unsigned char *data() const;
+    size_t size() const;
+
+private:
+    const unsigned char *mapData;
+    size_t mapSize;
 
-    void constructPlots(ScenarioModel *model);
-    void constructGraphs(ScenarioModel *model);
-    void copyPlotsData(ScenarioModel *model);
+#ifdef _WIN32
+    void *fileHandle;
+    void *mappingHandle;
+#endif
 };
 
-#endif // SNAPSHOT_H
+#endif // MAPPEDFILE_H
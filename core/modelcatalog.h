@@ -0,0 +1,55 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#ifndef MODELCATALOG_H
+#define MODELCATALOG_H
+
+#include <list>
+#include <vector>
+#include <QString>
+
+// Definition of a scenario model: names, parameter ranges and default initial conditions
+// Shared by the scenario widget and the headless solver, so both describe models identically
+// The infected and asymptomatic indices are the variables counted as infected, -1 if there is none
+
+struct ModelDefinition
+{
+    int index;
+    QString name;
+    std::list<QString> variableShortNames;
+    std::list<QString> variableLongNames;
+    std::list<QString> parameterNames;
+    std::list<double> parameterMin;
+    std::list<double> parameterMax;
+    std::list<double> parameterInit;
+    std::list<double> initialConditions;
+    int infectedIndex;
+    int asymptomaticIndex;
+};
+
+const std::vector<ModelDefinition> &scenarioModelDefinitions();
+
+// Whether there is a scenario model with the given index
+
+bool isScenarioModel(int modelIndex);
+
+// Index of the model given by name (case insensitive) or by index, -1 if not found
+
+int findScenarioModel(QString nameOrIndex);
+
+#endif // MODELCATALOG_H
@@ -0,0 +1,306 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef MODELS_H
+#define MODELS_H
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+typedef std::vector<double> state_type;
+
+// Right-hand sides are templates on the state type, so that fixed-size states
+// (std::array) can be used where the dimension is known, e.g. in parameter sweeps
+// Models are templates on the parameter type as well, so that they can be evaluated
+// with dual numbers to obtain sensitivities to their parameters (see dual.h)
+// Time is scaled by the infectious period, so the transmission rate P0 is their basic
+// reproduction number without vital dynamics; it is NaN where it is not derived
+
+template <typename Parameter = double>
+class SIR
+{
+public:
+    std::vector<Parameter> P;
+
+    SIR(std::vector<Parameter> p): P(p){}
+
+    static double reproductionNumber(const std::vector<double> &P)
+    {
+        return P[0];
+    }
+
+    template <typename State>
+    void operator()(const State &x, State &dxdt, const double)
+    {
+        dxdt[0] = -P[0] * x[0] * x[1];
+        dxdt[1] = (P[0] * x[0] - 1) * x[1];
+        dxdt[2] = x[1];
+    }
+};
+
+template <typename Parameter = double>
+class SIRVitalDynamics
+{
+public:
+    std::vector<Parameter> P;
+
+    SIRVitalDynamics(std::vector<Parameter> p): P(p){}
+
+    static double reproductionNumber(const std::vector<double> &P)
+    {
+        return P[0] / (1.0 + P[1]);
+    }
+
+    template <typename State>
+    void operator()(const State &x, State &dxdt, const double)
+    {
+        dxdt[0] = P[1] * (1 - x[0]) - P[0] * x[0] * x[1];
+        dxdt[1] = (P[0] * x[0] - 1 - P[1]) * x[1];
+        dxdt[2] = x[1] - P[1] * x[2];
+    }
+};
+
+template <typename Parameter = double>
+class SIRS
+{
+public:
+    std::vector<Parameter> P;
+
+    SIRS(std::vector<Parameter> p): P(p){}
+
+    static double reproductionNumber(const std::vector<double> &P)
+    {
+        return P[0];
+    }
+
+    template <typename State>
+    void operator()(const State &x, State &dxdt, const double)
+    {
+        dxdt[0] = P[1] * x[2] - P[0] * x[0] * x[1];
+        dxdt[1] = (P[0] * x[0] - 1) * x[1];
+        dxdt[2] = x[1] - P[1] * x[2];
+    }
+};
+
+template <typename Parameter = double>
+class SIRSVitalDynamics
+{
+public:
+    std::vector<Parameter> P;
+
+    SIRSVitalDynamics(std::vector<Parameter> p): P(p){}
+
+    static double reproductionNumber(const std::vector<double> &P)
+    {
+        return P[0] / (1.0 + P[2]);
+    }
+
+    template <typename State>
+    void operator()(const State &x, State &dxdt, const double)
+    {
+        dxdt[0] = P[1] * x[2] + P[2] * (1 - x[0]) - P[0] * x[0] * x[1];
+        dxdt[1] = (P[0] * x[0] - 1 - P[2]) * x[1];
+        dxdt[2] = x[1] - (P[1] + P[2]) * x[2];
+    }
+};
+
+template <typename Parameter = double>
+class SIRA
+{
+public:
+    std::vector<Parameter> P;
+
+    SIRA(std::vector<Parameter> p): P(p){}
+
+    static double reproductionNumber(const std::vector<double> &)
+    {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+
+    template <typename State>
+    void operator()(const State &x, State &dxdt, const double)
+    {
+        dxdt[0] = -P[0] * (x[1] + P[1] * x[3]) * x[0];
+        dxdt[1] = (P[0] * x[0] - 1) * x[1] + P[0] * P[2] * x[0] * x[3];
+        dxdt[2] = x[1] + x[3];
+        dxdt[3] = (P[0] * (P[1] - P[2]) * x[0] - 1) * x[3];
+    }
+};
+
+template <typename Parameter = double>
+class SEIR
+{
+public:
+    std::vector<Parameter> P;
+
+    SEIR(std::vector<Parameter> p): P(p){}
+
+    static double reproductionNumber(const std::vector<double> &P)
+    {
+        return P[0];
+    }
+
+    template <typename State>
+    void operator()(const State &x, State &dxdt, const double)
+    {
+        dxdt[0] = -P[0] * x[0] * x[2];
+        dxdt[1] = P[0] * x[0] * x[2] - P[1] * x[1];
+        dxdt[2] = P[1] * x[1] - x[2];
+        dxdt[3] = x[2];
+    }
+};
+
+template <typename Parameter = double>
+class SEIRVitalDynamics
+{
+public:
+    std::vector<Parameter> P;
+
+    SEIRVitalDynamics(std::vector<Parameter> p): P(p){}
+
+    static double reproductionNumber(const std::vector<double> &P)
+    {
+        return P[0] * P[1] / ((P[1] + P[2]) * (1.0 + P[2]));
+    }
+
+    template <typename State>
+    void operator()(const State &x, State &dxdt, const double)
+    {
+        dxdt[0] = P[2] * (1 - x[0]) - P[0] * x[0] * x[2];
+        dxdt[1] = P[0] * x[0] * x[2] - (P[1] + P[2]) * x[1];
+        dxdt[2] = P[1] * x[1] - (1 + P[2]) * x[2];
+        dxdt[3] = x[2] - P[2] * x[3];
+    }
+};
+
+template <typename Parameter = double>
+class SEIRS
+{
+public:
+    std::vector<Parameter> P;
+
+    SEIRS(std::vector<Parameter> p): P(p){}
+
+    static double reproductionNumber(const std::vector<double> &P)
+    {
+        return P[0];
+    }
+
+    template <typename State>
+    void operator()(const State &x, State &dxdt, const double)
+    {
+        dxdt[0] = -P[0] * x[0] * x[2] + P[2] * x[3];
+        dxdt[1] = P[0] * x[0] * x[2] - P[1] * x[1];
+        dxdt[2] = P[1] * x[1] - x[2];
+        dxdt[3] = x[2] - P[2] * x[3];
+    }
+};
+
+template <typename Parameter = double>
+class SEIRSVitalDynamics
+{
+public:
+    std::vector<Parameter> P;
+
+    SEIRSVitalDynamics(std::vector<Parameter> p): P(p){}
+
+    static double reproductionNumber(const std::vector<double> &P)
+    {
+        return P[0] * P[1] / ((P[1] + P[3]) * (1.0 + P[3]));
+    }
+
+    template <typename State>
+    void operator()(const State &x, State &dxdt, const double)
+    {
+        dxdt[0] = P[3] * (1.0 - x[0]) - P[0] * x[0] * x[2] + P[2] * x[3];
+        dxdt[1] = P[0] * x[0] * x[2] - (P[1] + P[3]) * x[1];
+        dxdt[2] = P[1] * x[1] - (1.0 + P[3]) * x[2];
+        dxdt[3] = x[2] - (P[2] + P[3]) * x[3];
+    }
+};
+
+// Model class template and state dimension of a scenario model, passed by withModel
+
+template <template <typename> class Model, size_t Dimension>
+struct ModelType
+{
+    template <typename Parameter>
+    using type = Model<Parameter>;
+
+    static const size_t dimension = Dimension;
+};
+
+// Calls f with the ModelType of the model with the given index, as ordered in the scenario models
+// This is the only place where model indices are mapped to model classes, e.g.
+// withModel(modelIndex, [&](auto type){ typename decltype(type)::template type<double> model(p); ... });
+// Returns false if there is no model with that index
+
+template <typename Function>
+bool withModel(int modelIndex, Function &&f)
+{
+    if (modelIndex == 0) // SIR model
+        f(ModelType<SIR, 3>());
+    else if (modelIndex == 1) // SIRS model
+        f(ModelType<SIRS, 3>());
+    else if (modelIndex == 2) // SEIR model
+        f(ModelType<SEIR, 4>());
+    else if (modelIndex == 3) // SEIRS model
+        f(ModelType<SEIRS, 4>());
+    else if (modelIndex == 4) // SIRA model
+        f(ModelType<SIRA, 4>());
+    else if (modelIndex == 5) // SIR + Vital dynamics model
+        f(ModelType<SIRVitalDynamics, 3>());
+    else if (modelIndex == 6) // SIRS + Vital dynamics model
+        f(ModelType<SIRSVitalDynamics, 3>());
+    else if (modelIndex == 7) // SEIR + Vital dynamics model
+        f(ModelType<SEIRVitalDynamics, 4>());
+    else if (modelIndex == 8) // SEIRS + Vital dynamics model
+        f(ModelType<SEIRSVitalDynamics, 4>());
+    else
+        return false;
+
+    return true;
+}
+
+// Right-hand side of the model with the given index
+
+inline void evaluateModel(int modelIndex, const std::vector<double> &p, const state_type &x, state_type &dxdt)
+{
+    dxdt.resize(x.size());
+
+    withModel(modelIndex, [&](auto type){
+        typename decltype(type)::template type<double> model(p);
+        model(x, dxdt, 0.0);
+    });
+}
+
+struct push_back_state_and_time
+{
+    std::vector<state_type> &states;
+    std::vector<double> &times;
+
+    push_back_state_and_time(std::vector<state_type> &xs, std::vector<double> &ts): states(xs), times(ts){}
+
+    void operator()(const state_type &x, double t)
+    {
+        states.push_back(x);
+        times.push_back(t);
+    }
+};
+
+#endif // MODELS_H
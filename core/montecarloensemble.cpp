@@ -0,0 +1,241 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "montecarloensemble.h"
+#include "scenariointegrator.h"
+#include "modelcatalog.h"
+#include "p2quantile.h"
+#include "philox.h"
+#include "parallelfor.h"
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+
+MonteCarloEnsemble::MonteCarloEnsemble(const EnsembleSettings &ensembleSettings): settings(ensembleSettings)
+{
+    numFailed = 0;
+}
+
+bool MonteCarloEnsemble::validate(std::string &error) const
+{
+    if (!isScenarioModel(settings.modelIndex) || settings.scenarios.empty())
+    {
+        error = "Unknown model";
+        return false;
+    }
+
+    if (settings.numMembers < 1 || settings.numMembers > maxMembers)
+    {
+        error = "Number of members must be between 1 and " + std::to_string(maxMembers);
+        return false;
+    }
+
+    if (settings.times.empty() || !std::is_sorted(settings.times.begin(), settings.times.end()))
+    {
+        error = "Grid times must be increasing";
+        return false;
+    }
+
+    if (settings.quantiles.empty())
+    {
+        error = "No quantiles";
+        return false;
+    }
+
+    for (double quantile : settings.quantiles)
+    {
+        if (!(quantile > 0.0 && quantile < 1.0))
+        {
+            error = "Quantiles must be between 0 and 1";
+            return false;
+        }
+    }
+
+    if (settings.distributions.size() != settings.scenarios.size())
+    {
+        error = "Missing parameter distributions";
+        return false;
+    }
+
+    for (size_t s = 0; s < settings.scenarios.size(); s++)
+    {
+        if (settings.distributions[s].size() != settings.scenarios[s].parameters.size())
+        {
+            error = "Missing parameter distributions";
+            return false;
+        }
+
+        for (const ParameterDistribution &distribution : settings.distributions[s])
+        {
+            if ((distribution.type == ParameterDistribution::Uniform && !(distribution.a <= distribution.b)) ||
+                ((distribution.type == ParameterDistribution::Normal || distribution.type == ParameterDistribution::LogNormal) && !(distribution.b >= 0.0)))
+            {
+                error = "Invalid distribution of scenario " + std::to_string(s + 1);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+const EnsembleBands &MonteCarloEnsemble::getBands() const
+{
+    return bands;
+}
+
+int MonteCarloEnsemble::getNumFailed() const
+{
+    return numFailed;
+}
+
+std::vector<double> MonteCarloEnsemble::chainGrid(const std::vector<Scenario> &scenarios, int numTimes)
+{
+    double timeStart = scenarios.front().timeStart;
+    double timeEnd = scenarios.back().timeEnd;
+
+    std::vector<double> times(std::max(numTimes, 2));
+
+    for (size_t n = 0; n < times.size(); n++)
+        times[n] = timeStart + (timeEnd - timeStart) * n / (times.size() - 1);
+
+    times.back() = timeEnd;
+
+    return times;
+}
+
+std::vector<Scenario> MonteCarloEnsemble::memberScenarios(int member) const
+{
+    std::vector<Scenario> scenarios = settings.scenarios;
+
+    // Draws depend on the member only, not on the thread solving it
+
+    Philox generator(settings.seed, static_cast<uint64_t>(member));
+
+    for (size_t s = 0; s < scenarios.size(); s++)
+    {
+        Scenario &scenario = scenarios[s];
+
+        for (size_t k = 0; k < scenario.parameters.size(); k++)
+        {
+            const ParameterDistribution &distribution = settings.distributions[s][k];
+
+            double value = scenario.parameters[k];
+
+            if (distribution.type == ParameterDistribution::Uniform)
+                value = distribution.a + (distribution.b - distribution.a) * generator.uniform();
+            else if (distribution.type == ParameterDistribution::Normal)
+                value = distribution.a + distribution.b * generator.normal();
+            else if (distribution.type == ParameterDistribution::LogNormal)
+                value = std::exp(distribution.a + distribution.b * generator.normal());
+
+            scenario.parameters[k] = std::min(std::max(value, scenario.parametersMin[k]), scenario.parametersMax[k]);
+        }
+    }
+
+    return scenarios;
+}
+
+bool MonteCarloEnsemble::run(const std::atomic<bool> &canceled, const std::function<void(double)> &progress)
+{
+    size_t numTimes = settings.times.size();
+    size_t dimension = settings.scenarios.front().x0.size();
+    size_t numQuantiles = settings.quantiles.size();
+
+    // One estimator per quantile, variable and time
+
+    std::vector<P2Quantile> estimators;
+    estimators.reserve(numQuantiles * dimension * numTimes);
+
+    for (size_t q = 0; q < numQuantiles; q++)
+        for (size_t i = 0; i < dimension * numTimes; i++)
+            estimators.push_back(P2Quantile(settings.quantiles[q]));
+
+    // Members are solved concurrently but added in order, so that estimates do not depend on scheduling
+
+    std::atomic<int> doneMembers(0);
+    std::atomic<int> failedMembers(0);
+
+    std::mutex addMutex;
+    std::condition_variable addCondition;
+    int nextAdded = 0;
+
+    std::vector<std::vector<double>> outputs(parallelThreadCount(settings.numMembers), std::vector<double>(numTimes * dimension));
+
+    // Members are taken in order and every taken member is added, even if canceled meanwhile,
+    // so that waiting for the previous ones always ends
+
+    parallelFor(settings.numMembers, canceled, [&](size_t index, int thread){
+        int member = static_cast<int>(index);
+        std::vector<double> &output = outputs[thread];
+
+        if (!canceled)
+            integrateChainOnGrid(settings.modelIndex, memberScenarios(member), settings.times, output.data());
+
+        std::unique_lock<std::mutex> lock(addMutex);
+        addCondition.wait(lock, [&](){ return nextAdded == member; });
+
+        if (!canceled)
+        {
+            bool finite = true;
+
+            for (size_t i = 0; i < output.size() && finite; i++)
+                finite = std::isfinite(output[i]);
+
+            if (finite)
+            {
+                for (size_t q = 0; q < numQuantiles; q++)
+                    for (size_t i = 0; i < output.size(); i++)
+                        estimators[q * output.size() + i].add(output[i]);
+            }
+            else
+            {
+                failedMembers++;
+            }
+        }
+
+        nextAdded++;
+        doneMembers++;
+        addCondition.notify_all();
+    }, [&](){
+        if (progress)
+            progress(static_cast<double>(doneMembers) / settings.numMembers);
+    });
+
+    if (canceled)
+        return false;
+
+    numFailed = failedMembers;
+
+    bands.times = settings.times;
+    bands.quantiles = settings.quantiles;
+    bands.values.assign(numQuantiles, std::vector<std::vector<double>>(dimension, std::vector<double>(numTimes)));
+
+    // Estimators are stored time-major, as the solver output
+
+    for (size_t q = 0; q < numQuantiles; q++)
+        for (size_t n = 0; n < numTimes; n++)
+            for (size_t i = 0; i < dimension; i++)
+                bands.values[q][i][n] = estimators[q * numTimes * dimension + n * dimension + i].value();
+
+    if (progress)
+        progress(1.0);
+
+    return true;
+}
@@ -0,0 +1,100 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#ifndef MONTECARLOENSEMBLE_H
+#define MONTECARLOENSEMBLE_H
+
+#include "scenario.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Monte Carlo ensemble of a scenario chain with random parameters
+// Each member draws every parameter of every scenario from its distribution, clamped to
+// the slider bounds, and is solved on a common time grid. Quantiles of each variable
+// at each grid time are estimated while members complete, so memory does not grow
+// with their number
+
+struct ParameterDistribution
+{
+    // Fixed keeps the scenario value, uniform takes (min, max), normal (mean, standard
+    // deviation) and log-normal (mean, standard deviation) of the logarithm
+
+    enum Type {Fixed, Uniform, Normal, LogNormal};
+
+    int type;
+    double a;
+    double b;
+};
+
+struct EnsembleSettings
+{
+    int modelIndex;
+    std::vector<Scenario> scenarios;
+
+    // One distribution per parameter of each scenario
+
+    std::vector<std::vector<ParameterDistribution>> distributions;
+
+    int numMembers;
+    uint64_t seed;
+
+    std::vector<double> times;
+    std::vector<double> quantiles;
+};
+
+// Quantile estimates, values[quantile][variable][time]
+
+struct EnsembleBands
+{
+    std::vector<double> times;
+    std::vector<double> quantiles;
+    std::vector<std::vector<std::vector<double>>> values;
+};
+
+class MonteCarloEnsemble
+{
+public:
+    static const int maxMembers = 10000000;
+
+    explicit MonteCarloEnsemble(const EnsembleSettings &ensembleSettings);
+
+    bool validate(std::string &error) const;
+
+    const EnsembleBands &getBands() const;
+    int getNumFailed() const;
+
+    // Progress is reported from the calling thread as a fraction
+
+    bool run(const std::atomic<bool> &canceled, const std::function<void(double)> &progress);
+
+    // Grid of numTimes evenly spaced times over the chain
+
+    static std::vector<double> chainGrid(const std::vector<Scenario> &scenarios, int numTimes);
+
+private:
+    EnsembleSettings settings;
+    EnsembleBands bands;
+    int numFailed;
+
+    std::vector<Scenario> memberScenarios(int member) const;
+};
+
+#endif // MONTECARLOENSEMBLE_H
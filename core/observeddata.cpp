@@ -0,0 +1,353 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "observeddata.h"
+#include "mappedfile.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <future>
+#include <limits>
+#include <thread>
+
+// Parsed rows of a chunk of text
+
+struct ObservedChunk
+{
+    std::vector<double> times;
+    std::vector<std::vector<double>> columns;
+    size_t invalidLines = 0;
+};
+
+static const char *skipSpaces(const char *position, const char *end)
+{
+    while (position < end && (*position == ' ' || *position == '\r'))
+        position++;
+
+    return position;
+}
+
+static double parseField(const char *begin, const char *end)
+{
+    begin = skipSpaces(begin, end);
+
+    // from_chars does not accept a leading plus sign
+
+    if (begin < end && *begin == '+')
+        begin++;
+
+    double value;
+    std::from_chars_result result = std::from_chars(begin, end, value);
+
+    if (result.ec != std::errc() || skipSpaces(result.ptr, end) != end)
+        return std::numeric_limits<double>::quiet_NaN();
+
+    return value;
+}
+
+static void parseChunk(const char *begin, const char *end, char delimiter, size_t numColumns, ObservedChunk &chunk)
+{
+    chunk.columns.assign(numColumns, std::vector<double>());
+
+    const char *line = begin;
+
+    while (line < end)
+    {
+        const char *lineEnd = static_cast<const char*>(std::memchr(line, '\n', end - line));
+
+        if (lineEnd == nullptr)
+            lineEnd = end;
+
+        const char *content = skipSpaces(line, lineEnd);
+
+        if (content < lineEnd && *content != '#')
+        {
+            const char *field = line;
+            const char *fieldEnd = std::find(field, lineEnd, delimiter);
+
+            double time = parseField(field, fieldEnd);
+
+            if (std::isnan(time))
+            {
+                chunk.invalidLines++;
+            }
+            else
+            {
+                chunk.times.push_back(time);
+
+                for (size_t k = 0; k < numColumns; k++)
+                {
+                    double value = std::numeric_limits<double>::quiet_NaN();
+
+                    if (fieldEnd < lineEnd)
+                    {
+                        field = fieldEnd + 1;
+                        fieldEnd = std::find(field, lineEnd, delimiter);
+                        value = parseField(field, fieldEnd);
+                    }
+
+                    chunk.columns[k].push_back(value);
+                }
+            }
+        }
+
+        line = lineEnd + 1;
+    }
+}
+
+bool parseObservedData(const char *text, size_t size, ObservedData &data, std::string &error)
+{
+    const char *end = text + size;
+
+    // Skip byte order mark and comment lines
+
+    if (size >= 3 && static_cast<unsigned char>(text[0]) == 0xEF && static_cast<unsigned char>(text[1]) == 0xBB && static_cast<unsigned char>(text[2]) == 0xBF)
+        text += 3;
+
+    const char *line = text;
+    const char *lineEnd = end;
+
+    while (line < end)
+    {
+        lineEnd = static_cast<const char*>(std::memchr(line, '\n', end - line));
+
+        if (lineEnd == nullptr)
+            lineEnd = end;
+
+        const char *content = skipSpaces(line, lineEnd);
+
+        if (content < lineEnd && *content != '#')
+            break;
+
+        line = lineEnd + 1;
+    }
+
+    if (line >= end)
+    {
+        error = "No data found";
+        return false;
+    }
+
+    // Delimiter and number of columns from the first line
+
+    char delimiter = ',';
+
+    if (std::find(line, lineEnd, '\t') != lineEnd)
+        delimiter = '\t';
+    else if (std::find(line, lineEnd, ';') != lineEnd)
+        delimiter = ';';
+
+    size_t numFields = std::count(line, lineEnd, delimiter) + 1;
+
+    if (numFields < 2)
+    {
+        error = "At least a time column and a value column are required";
+        return false;
+    }
+
+    data.columnNames.clear();
+    data.times.clear();
+    data.columns.assign(numFields - 1, std::vector<double>());
+
+    // Header line, if its first field is not a number
+
+    const char *field = line;
+    const char *fieldEnd = std::find(field, lineEnd, delimiter);
+
+    if (std::isnan(parseField(field, fieldEnd)))
+    {
+        for (size_t k = 0; k < numFields; k++)
+        {
+            const char *nameBegin = skipSpaces(field, fieldEnd);
+            const char *nameEnd = fieldEnd;
+
+            while (nameEnd > nameBegin && (nameEnd[-1] == ' ' || nameEnd[-1] == '\r'))
+                nameEnd--;
+
+            if (k > 0)
+                data.columnNames.push_back(std::string(nameBegin, nameEnd));
+
+            if (fieldEnd < lineEnd)
+            {
+                field = fieldEnd + 1;
+                fieldEnd = std::find(field, lineEnd, delimiter);
+            }
+        }
+
+        line = lineEnd + 1;
+    }
+    else
+    {
+        for (size_t k = 1; k < numFields; k++)
+            data.columnNames.push_back("Column " + std::to_string(k));
+    }
+
+    if (line >= end)
+    {
+        error = "No data found";
+        return false;
+    }
+
+    // Split the remaining text at line boundaries, about 4 MB per chunk
+
+    size_t numThreads = std::max(1u, std::thread::hardware_concurrency());
+    size_t chunkSize = std::max<size_t>(4 << 20, (end - line) / numThreads + 1);
+
+    std::vector<std::future<void>> futures;
+    std::vector<ObservedChunk> chunks((end - line) / chunkSize + 1);
+
+    const char *chunkBegin = line;
+
+    for (size_t c = 0; c < chunks.size() && chunkBegin < end; c++)
+    {
+        const char *chunkEnd = chunkBegin + std::min<size_t>(chunkSize, end - chunkBegin);
+
+        if (chunkEnd < end)
+        {
+            const char *newline = static_cast<const char*>(std::memchr(chunkEnd, '\n', end - chunkEnd));
+            chunkEnd = newline == nullptr ? end : newline + 1;
+        }
+
+        futures.push_back(std::async(std::launch::async, parseChunk, chunkBegin, chunkEnd, delimiter, numFields - 1, std::ref(chunks[c])));
+
+        chunkBegin = chunkEnd;
+    }
+
+    for (size_t c = 0; c < futures.size(); c++)
+        futures[c].get();
+
+    // Concatenate chunks in order
+
+    size_t numRows = 0;
+    size_t invalidLines = 0;
+
+    for (size_t c = 0; c < futures.size(); c++)
+    {
+        numRows += chunks[c].times.size();
+        invalidLines += chunks[c].invalidLines;
+    }
+
+    data.times.reserve(numRows);
+
+    for (size_t k = 0; k < data.columns.size(); k++)
+        data.columns[k].reserve(numRows);
+
+    for (size_t c = 0; c < futures.size(); c++)
+    {
+        data.times.insert(data.times.end(), chunks[c].times.begin(), chunks[c].times.end());
+
+        for (size_t k = 0; k < data.columns.size(); k++)
+            data.columns[k].insert(data.columns[k].end(), chunks[c].columns[k].begin(), chunks[c].columns[k].end());
+    }
+
+    if (numRows == 0)
+    {
+        error = "No valid rows found (" + std::to_string(invalidLines) + " invalid lines)";
+        return false;
+    }
+
+    return true;
+}
+
+bool loadObservedData(const std::string &fileName, ObservedData &data, std::string &error)
+{
+    MappedFile file;
+
+    if (!file.open(fileName))
+    {
+        error = "Could not open " + fileName;
+        return false;
+    }
+
+    return parseObservedData(reinterpret_cast<const char*>(file.data()), file.size(), data, error);
+}
+
+void sortObservedData(ObservedData &data)
+{
+    if (std::is_sorted(data.times.begin(), data.times.end()))
+        return;
+
+    std::vector<size_t> order(data.times.size());
+
+    for (size_t i = 0; i < order.size(); i++)
+        order[i] = i;
+
+    std::stable_sort(order.begin(), order.end(), [&data](size_t a, size_t b){ return data.times[a] < data.times[b]; });
+
+    std::vector<double> sorted(order.size());
+
+    for (size_t i = 0; i < order.size(); i++)
+        sorted[i] = data.times[order[i]];
+
+    data.times.swap(sorted);
+
+    for (size_t k = 0; k < data.columns.size(); k++)
+    {
+        for (size_t i = 0; i < order.size(); i++)
+            sorted[i] = data.columns[k][order[i]];
+
+        data.columns[k].swap(sorted);
+    }
+}
+
+void resampleObservations(const std::vector<double> &times, const std::vector<double> &values, const std::vector<double> &modelTimes, std::vector<double> &resampledTimes, std::vector<double> &resampledValues)
+{
+    resampledTimes.clear();
+    resampledValues.clear();
+
+    size_t numBins = modelTimes.size();
+
+    if (numBins == 0)
+        return;
+
+    // Both time sequences are sorted, so bins are found in a single pass
+
+    size_t bin = 0;
+    double sum = 0.0;
+    size_t count = 0;
+
+    for (size_t i = 0; i < times.size(); i++)
+    {
+        if (std::isnan(values[i]) || times[i] < modelTimes.front() || times[i] > modelTimes.back())
+            continue;
+
+        // Advance to the nearest model time
+
+        while (bin + 1 < numBins && modelTimes[bin + 1] - times[i] <= times[i] - modelTimes[bin])
+        {
+            if (count > 0)
+            {
+                resampledTimes.push_back(modelTimes[bin]);
+                resampledValues.push_back(sum / count);
+            }
+
+            bin++;
+            sum = 0.0;
+            count = 0;
+        }
+
+        sum += values[i];
+        count++;
+    }
+
+    if (count > 0)
+    {
+        resampledTimes.push_back(modelTimes[bin]);
+        resampledValues.push_back(sum / count);
+    }
+}
@@ -0,0 +1,52 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef OBSERVEDDATA_H
+#define OBSERVEDDATA_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Observed time series, e.g. surveillance case counts
+// The first column holds times, the remaining ones observed values
+// Missing or unparsable values are stored as NaN
+
+struct ObservedData
+{
+    std::vector<std::string> columnNames;
+    std::vector<double> times;
+    std::vector<std::vector<double>> columns;
+};
+
+// Parses CSV or TSV text: delimiter is detected from the first line (tab, semicolon or comma),
+// an optional header line names the columns, and lines starting with '#' are skipped
+// Large inputs are split at line boundaries and parsed concurrently
+
+bool parseObservedData(const char *text, size_t size, ObservedData &data, std::string &error);
+bool loadObservedData(const std::string &fileName, ObservedData &data, std::string &error);
+
+// Sorts rows by time, in case they are not
+
+void sortObservedData(ObservedData &data);
+
+// Averages observations into bins centered on the given model times, both sorted
+// Times without observations are left out
+
+void resampleObservations(const std::vector<double> &times, const std::vector<double> &values, const std::vector<double> &modelTimes, std::vector<double> &resampledTimes, std::vector<double> &resampledValues);
+
+#endif // OBSERVEDDATA_H
@@ -0,0 +1,143 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#ifndef P2QUANTILE_H
+#define P2QUANTILE_H
+
+#include <algorithm>
+#include <cmath>
+
+// Streaming quantile estimate with the P-square algorithm (Jain and Chlamtac, 1985)
+// Keeps five markers whatever the number of values added, whose middle one tracks the
+// quantile by piecewise-parabolic adjustment. The first five values are kept exactly
+
+class P2Quantile
+{
+public:
+    explicit P2Quantile(double probability = 0.5): p(probability), count(0){}
+
+    void add(double x)
+    {
+        if (count < 5)
+        {
+            heights[count++] = x;
+
+            if (count == 5)
+            {
+                std::sort(heights, heights + 5);
+
+                for (int i = 0; i < 5; i++)
+                    positions[i] = i + 1.0;
+
+                desired[0] = 1.0;
+                desired[1] = 1.0 + 2.0 * p;
+                desired[2] = 1.0 + 4.0 * p;
+                desired[3] = 3.0 + 2.0 * p;
+                desired[4] = 5.0;
+            }
+
+            return;
+        }
+
+        count++;
+
+        // Cell of the new value, extending the extreme markers if needed
+
+        int k;
+
+        if (x < heights[0])
+        {
+            heights[0] = x;
+            k = 0;
+        }
+        else if (x >= heights[4])
+        {
+            heights[4] = x;
+            k = 3;
+        }
+        else
+        {
+            k = 0;
+            while (x >= heights[k + 1]) k++;
+        }
+
+        for (int i = k + 1; i < 5; i++)
+            positions[i] += 1.0;
+
+        const double increments[5] = {0.0, 0.5 * p, p, 0.5 * (1.0 + p), 1.0};
+
+        for (int i = 0; i < 5; i++)
+            desired[i] += increments[i];
+
+        // Move the middle markers towards their desired positions
+
+        for (int i = 1; i < 4; i++)
+        {
+            double d = desired[i] - positions[i];
+
+            if ((d >= 1.0 && positions[i + 1] - positions[i] > 1.0) || (d <= -1.0 && positions[i - 1] - positions[i] < -1.0))
+            {
+                int s = d > 0.0 ? 1 : -1;
+
+                double parabolic = heights[i] + s / (positions[i + 1] - positions[i - 1]) *
+                    ((positions[i] - positions[i - 1] + s) * (heights[i + 1] - heights[i]) / (positions[i + 1] - positions[i]) +
+                     (positions[i + 1] - positions[i] - s) * (heights[i] - heights[i - 1]) / (positions[i] - positions[i - 1]));
+
+                if (heights[i - 1] < parabolic && parabolic < heights[i + 1])
+                    heights[i] = parabolic;
+                else
+                    heights[i] += s * (heights[i + s] - heights[i]) / (positions[i + s] - positions[i]);
+
+                positions[i] += s;
+            }
+        }
+    }
+
+    double value() const
+    {
+        if (count == 0)
+            return NAN;
+
+        if (count < 5)
+        {
+            double sorted[5];
+            std::copy(heights, heights + count, sorted);
+            std::sort(sorted, sorted + count);
+
+            int index = std::min(count - 1, static_cast<int>(p * count));
+            return sorted[index];
+        }
+
+        return heights[2];
+    }
+
+    int getCount() const
+    {
+        return count;
+    }
+
+private:
+    double p;
+    int count;
+
+    double heights[5];
+    double positions[5];
+    double desired[5];
+};
+
+#endif // P2QUANTILE_H
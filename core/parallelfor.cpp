@@ -0,0 +1,92 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "parallelfor.h"
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+
+// Threads running loop bodies in all loops, so that jobs running at the same time share the cores
+
+static std::atomic<int> busyThreads(0);
+
+static int coreCount()
+{
+    return static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+}
+
+static int reserveThreads(int wanted)
+{
+    // At least one thread, so that every loop makes progress
+
+    int busy = busyThreads.load();
+    int granted;
+
+    do
+    {
+        granted = std::max(1, std::min(wanted, coreCount() - busy));
+    }
+    while (!busyThreads.compare_exchange_weak(busy, busy + granted));
+
+    return granted;
+}
+
+int parallelThreadCount(size_t count)
+{
+    return static_cast<int>(std::min<size_t>(coreCount(), count));
+}
+
+void parallelFor(size_t count, const std::atomic<bool> &canceled, const std::function<void(size_t index, int thread)> &body, const std::function<void()> &poll)
+{
+    std::atomic<size_t> nextIndex(0);
+
+    auto worker = [&](int thread)
+    {
+        while (!canceled)
+        {
+            size_t index = nextIndex++;
+
+            if (index >= count)
+                break;
+
+            body(index, thread);
+        }
+    };
+
+    if (count == 0)
+        return;
+
+    int numThreads = reserveThreads(parallelThreadCount(count));
+
+    std::vector<std::future<void>> futures;
+
+    for (int t = 0; t < numThreads; t++)
+        futures.push_back(std::async(std::launch::async, worker, t));
+
+    for (size_t t = 0; t < futures.size(); t++)
+    {
+        while (futures[t].wait_for(std::chrono::milliseconds(100)) != std::future_status::ready)
+        {
+            if (poll)
+                poll();
+        }
+    }
+
+    busyThreads -= numThreads;
+}
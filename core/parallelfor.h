@@ -0,0 +1,38 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef PARALLELFOR_H
+#define PARALLELFOR_H
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+
+// Parallel loop of the analysis engines
+// Calls body(index, thread) for every index in [0, count) on up to one thread per core, threads taking
+// indices in order from a shared counter, so that results stored by index do not depend on scheduling
+// thread is in [0, parallelThreadCount(count)) and selects per-thread scratch data
+// Loops running at the same time share the cores, each one getting the cores left free by the others
+// but at least one thread
+// No more indices are taken once canceled is set. Meanwhile the calling thread calls poll every 100 ms,
+// e.g. to report progress
+
+int parallelThreadCount(size_t count);
+
+void parallelFor(size_t count, const std::atomic<bool> &canceled, const std::function<void(size_t index, int thread)> &body, const std::function<void()> &poll = nullptr);
+
+#endif // PARALLELFOR_H
@@ -0,0 +1,551 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "parameterfit.h"
+#include "sensitivity.h"
+#include "modelcatalog.h"
+#include "parallelfor.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <boost/math/distributions/students_t.hpp>
+
+// Solves the symmetric system a x = b in place by Gaussian elimination with partial pivoting
+// Returns false if it is singular
+
+static bool solveLinear(std::vector<double> a, std::vector<double> &b, int n)
+{
+    for (int c = 0; c < n; c++)
+    {
+        int pivot = c;
+
+        for (int r = c + 1; r < n; r++)
+        {
+            if (std::fabs(a[r * n + c]) > std::fabs(a[pivot * n + c]))
+                pivot = r;
+        }
+
+        if (std::fabs(a[pivot * n + c]) < 1.0e-300)
+            return false;
+
+        if (pivot != c)
+        {
+            for (int k = 0; k < n; k++)
+                std::swap(a[c * n + k], a[pivot * n + k]);
+
+            std::swap(b[c], b[pivot]);
+        }
+
+        for (int r = c + 1; r < n; r++)
+        {
+            double factor = a[r * n + c] / a[c * n + c];
+
+            for (int k = c; k < n; k++)
+                a[r * n + k] -= factor * a[c * n + k];
+
+            b[r] -= factor * b[c];
+        }
+    }
+
+    for (int r = n - 1; r >= 0; r--)
+    {
+        for (int k = r + 1; k < n; k++)
+            b[r] -= a[r * n + k] * b[k];
+
+        b[r] /= a[r * n + r];
+    }
+
+    return true;
+}
+
+ParameterFit::ParameterFit(const FitSettings &fitSettings): settings(fitSettings)
+{
+    numResiduals = 0;
+
+    result.sumSquares = std::numeric_limits<double>::quiet_NaN();
+    result.numResiduals = 0;
+    result.iterations = 0;
+    result.bestStart = -1;
+
+    if (settings.scenarios.empty())
+        return;
+
+    const Scenario &first = settings.scenarios.front();
+
+    // Slider bounds of the first scenario, and fractions for the initial conditions
+
+    lowerBounds = first.parametersMin;
+    upperBounds = first.parametersMax;
+
+    if (settings.fitInitialConditions)
+    {
+        for (size_t i = 1; i < first.x0.size(); i++)
+        {
+            lowerBounds.push_back(0.0);
+            upperBounds.push_back(1.0);
+        }
+    }
+
+    // Observation times within the chain with at least one fitted value
+
+    double timeStart = first.timeStart;
+    double timeEnd = settings.scenarios.back().timeEnd;
+
+    for (size_t n = 0; n < settings.observedTimes.size(); n++)
+    {
+        double time = settings.observedTimes[n];
+
+        if (time < timeStart || time > timeEnd)
+            continue;
+
+        bool observed = false;
+
+        for (size_t i = 0; i < settings.observedValues.size() && i < first.x0.size(); i++)
+        {
+            if (n < settings.observedValues[i].size() && std::isfinite(settings.observedValues[i][n]))
+            {
+                observed = true;
+                numResiduals++;
+            }
+        }
+
+        if (observed)
+            fitTimes.push_back(time);
+    }
+
+    std::sort(fitTimes.begin(), fitTimes.end());
+    fitTimes.erase(std::unique(fitTimes.begin(), fitTimes.end()), fitTimes.end());
+}
+
+bool ParameterFit::validate(std::string &error) const
+{
+    if (!isScenarioModel(settings.modelIndex) || settings.scenarios.empty())
+    {
+        error = "Unknown model";
+        return false;
+    }
+
+    if (settings.numStarts < 1 || settings.numStarts > maxStarts)
+    {
+        error = "Number of starts must be between 1 and " + std::to_string(maxStarts);
+        return false;
+    }
+
+    if (settings.maxIterations < 1)
+    {
+        error = "Number of iterations must be positive";
+        return false;
+    }
+
+    if (numResiduals == 0)
+    {
+        error = "No observations within the time range of the scenarios";
+        return false;
+    }
+
+    if (numResiduals <= getNumUnknowns())
+    {
+        error = "Fewer observations than fitted values";
+        return false;
+    }
+
+    return true;
+}
+
+int ParameterFit::getNumUnknowns() const
+{
+    return static_cast<int>(lowerBounds.size());
+}
+
+const FitResult &ParameterFit::getResult() const
+{
+    return result;
+}
+
+const std::vector<double> &ParameterFit::getLowerBounds() const
+{
+    return lowerBounds;
+}
+
+const std::vector<double> &ParameterFit::getUpperBounds() const
+{
+    return upperBounds;
+}
+
+std::vector<double> ParameterFit::startValues(int start) const
+{
+    const Scenario &first = settings.scenarios.front();
+
+    std::vector<double> values = first.parameters;
+
+    if (settings.fitInitialConditions)
+        values.insert(values.end(), first.x0.begin() + 1, first.x0.end());
+
+    // The first start is the current scenario, the others draw parameters uniformly within bounds
+    // Each start has its own seed so that results do not depend on scheduling
+
+    if (start > 0)
+    {
+        std::mt19937_64 generator(static_cast<uint64_t>(start));
+
+        for (size_t k = 0; k < first.parameters.size(); k++)
+            values[k] = std::uniform_real_distribution<double>(lowerBounds[k], upperBounds[k])(generator);
+    }
+
+    project(values);
+
+    return values;
+}
+
+void ParameterFit::project(std::vector<double> &values) const
+{
+    for (size_t k = 0; k < values.size(); k++)
+        values[k] = std::min(std::max(values[k], lowerBounds[k]), upperBounds[k]);
+
+    // Fitted initial conditions may not exceed the total, as the first one would become negative
+
+    if (settings.fitInitialConditions)
+    {
+        const state_type &x0 = settings.scenarios.front().x0;
+
+        double total = 0.0;
+        double sum = 0.0;
+
+        for (size_t i = 0; i < x0.size(); i++)
+            total += x0[i];
+
+        size_t numParameters = settings.scenarios.front().parameters.size();
+
+        for (size_t k = numParameters; k < values.size(); k++)
+            sum += values[k];
+
+        if (sum > total && sum > 0.0)
+        {
+            for (size_t k = numParameters; k < values.size(); k++)
+                values[k] *= total / sum;
+        }
+    }
+}
+
+std::vector<Scenario> ParameterFit::applyValues(const std::vector<double> &values) const
+{
+    std::vector<Scenario> scenarios = settings.scenarios;
+
+    const std::vector<double> &firstParameters = settings.scenarios.front().parameters;
+
+    for (Scenario &scenario : scenarios)
+    {
+        for (size_t k = 0; k < firstParameters.size(); k++)
+        {
+            double value = scenario.parameters[k] + values[k] - firstParameters[k];
+            scenario.parameters[k] = std::min(std::max(value, scenario.parametersMin[k]), scenario.parametersMax[k]);
+        }
+    }
+
+    if (settings.fitInitialConditions)
+    {
+        state_type &x0 = scenarios.front().x0;
+
+        for (size_t i = 1; i < x0.size(); i++)
+        {
+            x0[0] += x0[i] - values[firstParameters.size() + i - 1];
+            x0[i] = values[firstParameters.size() + i - 1];
+        }
+
+        x0[0] = std::max(x0[0], 0.0);
+    }
+
+    return scenarios;
+}
+
+bool ParameterFit::evaluate(const std::vector<double> &values, std::vector<double> &residuals, std::vector<double> *jacobian) const
+{
+    std::vector<Scenario> scenarios = applyValues(values);
+
+    int dimension = static_cast<int>(scenarios.front().x0.size());
+
+    // A fitted initial condition moves from the first variable to its own
+
+    std::vector<state_type> initialTangents;
+
+    if (settings.fitInitialConditions)
+    {
+        for (int i = 1; i < dimension; i++)
+        {
+            state_type tangent(dimension, 0.0);
+            tangent[0] = -1.0;
+            tangent[i] = 1.0;
+            initialTangents.push_back(tangent);
+        }
+    }
+
+    std::shared_ptr<SensitivityTrajectory> trajectory = integrateSensitivities(settings.modelIndex, scenarios, initialTangents, fitTimes);
+
+    int numUnknowns = getNumUnknowns();
+
+    residuals.clear();
+
+    if (jacobian)
+        jacobian->clear();
+
+    for (size_t n = 0; n < settings.observedTimes.size(); n++)
+    {
+        double time = settings.observedTimes[n];
+
+        size_t step = std::lower_bound(trajectory->times.begin(), trajectory->times.end(), time) - trajectory->times.begin();
+
+        if (step >= trajectory->times.size() || trajectory->times[step] != time)
+            continue;
+
+        const state_type &z = trajectory->steps[step];
+
+        for (int i = 0; i < dimension && i < static_cast<int>(settings.observedValues.size()); i++)
+        {
+            if (n >= settings.observedValues[i].size() || !std::isfinite(settings.observedValues[i][n]))
+                continue;
+
+            residuals.push_back(z[i] - settings.observedValues[i][n]);
+
+            if (jacobian)
+            {
+                for (int k = 0; k < numUnknowns; k++)
+                    jacobian->push_back(z[dimension * (k + 1) + i]);
+            }
+        }
+    }
+
+    for (double residual : residuals)
+    {
+        if (!std::isfinite(residual))
+            return false;
+    }
+
+    return static_cast<int>(residuals.size()) == numResiduals;
+}
+
+FitResult ParameterFit::levenbergMarquardt(const std::vector<double> &start, int fixedIndex, const std::atomic<bool> &canceled) const
+{
+    int n = getNumUnknowns();
+
+    FitResult fit;
+    fit.values = start;
+    fit.sumSquares = std::numeric_limits<double>::infinity();
+    fit.numResiduals = numResiduals;
+    fit.iterations = 0;
+    fit.bestStart = -1;
+
+    std::vector<double> residuals, jacobian;
+
+    if (!evaluate(fit.values, residuals, &jacobian))
+        return fit;
+
+    auto sumSquares = [](const std::vector<double> &r){
+        double sum = 0.0;
+        for (double value : r) sum += value * value;
+        return sum;
+    };
+
+    fit.sumSquares = sumSquares(residuals);
+
+    double lambda = 1.0e-3;
+
+    std::vector<double> a(n * n), g(n), candidate, candidateResiduals;
+
+    while (fit.iterations < settings.maxIterations && !canceled)
+    {
+        fit.iterations++;
+
+        // Normal equations, J^T J and J^T r
+
+        std::fill(a.begin(), a.end(), 0.0);
+        std::fill(g.begin(), g.end(), 0.0);
+
+        for (size_t m = 0; m < residuals.size(); m++)
+        {
+            const double *row = &jacobian[m * n];
+
+            for (int j = 0; j < n; j++)
+            {
+                g[j] += row[j] * residuals[m];
+
+                for (int k = 0; k < n; k++)
+                    a[j * n + k] += row[j] * row[k];
+            }
+        }
+
+        // Unknowns at a bound that the gradient pushes out of it stay there, as does the fixed one
+
+        std::vector<bool> active(n, false);
+
+        for (int k = 0; k < n; k++)
+            active[k] = k == fixedIndex || (fit.values[k] <= lowerBounds[k] && g[k] > 0.0) || (fit.values[k] >= upperBounds[k] && g[k] < 0.0);
+
+        bool improved = false;
+
+        while (lambda < 1.0e12)
+        {
+            std::vector<double> damped = a;
+            std::vector<double> step(n);
+
+            for (int j = 0; j < n; j++)
+            {
+                step[j] = active[j] ? 0.0 : -g[j];
+
+                for (int k = 0; k < n; k++)
+                {
+                    if (active[j] || active[k])
+                        damped[j * n + k] = (j == k) ? 1.0 : 0.0;
+                }
+
+                if (!active[j])
+                    damped[j * n + j] += lambda * std::max(a[j * n + j], 1.0e-12);
+            }
+
+            if (!solveLinear(damped, step, n))
+            {
+                lambda *= 10.0;
+                continue;
+            }
+
+            candidate = fit.values;
+
+            for (int k = 0; k < n; k++)
+                candidate[k] += step[k];
+
+            project(candidate);
+
+            if (evaluate(candidate, candidateResiduals, nullptr) && sumSquares(candidateResiduals) < fit.sumSquares)
+            {
+                improved = true;
+                break;
+            }
+
+            lambda *= 10.0;
+        }
+
+        if (!improved)
+            break;
+
+        double previousSumSquares = fit.sumSquares;
+
+        fit.values = candidate;
+        lambda = std::max(lambda / 10.0, 1.0e-12);
+
+        if (!evaluate(fit.values, residuals, &jacobian))
+            break;
+
+        fit.sumSquares = sumSquares(residuals);
+
+        if (previousSumSquares - fit.sumSquares <= 1.0e-12 * previousSumSquares)
+            break;
+    }
+
+    // Confidence intervals from the linearized covariance s^2 (J^T J)^-1 at the minimum
+
+    fit.standardErrors.assign(n, std::numeric_limits<double>::quiet_NaN());
+    fit.lower = fit.values;
+    fit.upper = fit.values;
+
+    std::fill(a.begin(), a.end(), 0.0);
+
+    for (size_t m = 0; m < residuals.size(); m++)
+    {
+        for (int j = 0; j < n; j++)
+            for (int k = 0; k < n; k++)
+                a[j * n + k] += jacobian[m * n + j] * jacobian[m * n + k];
+    }
+
+    int degreesOfFreedom = numResiduals - n;
+    double variance = fit.sumSquares / degreesOfFreedom;
+
+    boost::math::students_t distribution(degreesOfFreedom);
+    double quantile = boost::math::quantile(distribution, 0.5 + 0.5 * confidenceLevel);
+
+    for (int k = 0; k < n; k++)
+    {
+        std::vector<double> column(n, 0.0);
+        column[k] = 1.0;
+
+        if (solveLinear(a, column, n) && column[k] >= 0.0)
+        {
+            fit.standardErrors[k] = std::sqrt(variance * column[k]);
+            fit.lower[k] = fit.values[k] - quantile * fit.standardErrors[k];
+            fit.upper[k] = fit.values[k] + quantile * fit.standardErrors[k];
+        }
+        else
+        {
+            fit.lower[k] = std::numeric_limits<double>::quiet_NaN();
+            fit.upper[k] = std::numeric_limits<double>::quiet_NaN();
+        }
+    }
+
+    return fit;
+}
+
+FitResult ParameterFit::refit(const std::vector<double> &start, int fixedIndex, const std::atomic<bool> &canceled) const
+{
+    std::vector<double> values = start;
+    project(values);
+
+    FitResult fit = levenbergMarquardt(values, fixedIndex, canceled);
+    fit.scenarios = applyValues(fit.values);
+
+    return fit;
+}
+
+bool ParameterFit::run(const std::atomic<bool> &canceled, const std::function<void(double)> &progress)
+{
+    std::vector<FitResult> fits(settings.numStarts);
+
+    std::atomic<int> doneStarts(0);
+
+    parallelFor(settings.numStarts, canceled, [&](size_t start, int){
+        fits[start] = levenbergMarquardt(startValues(static_cast<int>(start)), -1, canceled);
+        fits[start].bestStart = static_cast<int>(start);
+
+        doneStarts++;
+    }, [&](){
+        if (progress)
+            progress(static_cast<double>(doneStarts) / settings.numStarts);
+    });
+
+    if (canceled)
+        return false;
+
+    // Lowest sum of squares among the starts
+
+    int best = -1;
+
+    for (int start = 0; start < settings.numStarts; start++)
+    {
+        if (std::isfinite(fits[start].sumSquares) && (best < 0 || fits[start].sumSquares < fits[best].sumSquares))
+            best = start;
+    }
+
+    if (best < 0)
+        return false;
+
+    result = fits[best];
+    result.scenarios = applyValues(result.values);
+
+    if (progress)
+        progress(1.0);
+
+    return true;
+}
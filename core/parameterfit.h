@@ -0,0 +1,109 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#ifndef PARAMETERFIT_H
+#define PARAMETERFIT_H
+
+#include "scenario.h"
+#include <atomic>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Least-squares fit of a scenario chain to observed data
+// Unknowns are the model parameters and, optionally, the initial conditions of the first
+// scenario but the first one, which takes up their changes so that their sum is kept
+// A parameter is shifted by the same amount in every scenario, so that the changes
+// between scenarios remain, and the fitted value is that of the first scenario
+// Each start runs a Levenberg-Marquardt iteration with Jacobians from the forward
+// sensitivities, projected onto the slider bounds
+
+struct FitSettings
+{
+    int modelIndex;
+    std::vector<Scenario> scenarios;
+
+    // Observations of each variable, at the observed times, empty if not fitted, NaN if missing
+
+    std::vector<double> observedTimes;
+    std::vector<std::vector<double>> observedValues;
+
+    bool fitInitialConditions;
+    int numStarts;
+    int maxIterations;
+};
+
+struct FitResult
+{
+    // Parameters, then initial conditions of the variables but the first one if fitted
+
+    std::vector<double> values;
+    std::vector<double> standardErrors;
+    std::vector<double> lower;
+    std::vector<double> upper;
+
+    std::vector<Scenario> scenarios;
+
+    double sumSquares;
+    int numResiduals;
+    int iterations;
+    int bestStart;
+};
+
+class ParameterFit
+{
+public:
+    static const int maxStarts = 256;
+    static constexpr double confidenceLevel = 0.95;
+
+    explicit ParameterFit(const FitSettings &fitSettings);
+
+    bool validate(std::string &error) const;
+
+    int getNumUnknowns() const;
+    const FitResult &getResult() const;
+
+    const std::vector<double> &getLowerBounds() const;
+    const std::vector<double> &getUpperBounds() const;
+
+    // Starts are fitted concurrently, progress is reported from the calling thread as a fraction
+
+    bool run(const std::atomic<bool> &canceled, const std::function<void(double)> &progress);
+
+    // Single fit from the given start, keeping the unknown fixedIndex, if any, at its start value
+
+    FitResult refit(const std::vector<double> &start, int fixedIndex, const std::atomic<bool> &canceled) const;
+
+private:
+    FitSettings settings;
+
+    std::vector<double> lowerBounds;
+    std::vector<double> upperBounds;
+    std::vector<double> fitTimes;
+    int numResiduals;
+
+    FitResult result;
+
+    std::vector<double> startValues(int start) const;
+    void project(std::vector<double> &values) const;
+    std::vector<Scenario> applyValues(const std::vector<double> &values) const;
+    bool evaluate(const std::vector<double> &values, std::vector<double> &residuals, std::vector<double> *jacobian) const;
+    FitResult levenbergMarquardt(const std::vector<double> &start, int fixedIndex, const std::atomic<bool> &canceled) const;
+};
+
+#endif // PARAMETERFIT_H
@@ -0,0 +1,353 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "parametersweep.h"
+#include "analyticmetrics.h"
+#include "modelcatalog.h"
+#include "parallelfor.h"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <boost/numeric/odeint.hpp>
+
+ParameterSweep::ParameterSweep(const SweepSettings &sweepSettings)
+{
+    settings = sweepSettings;
+}
+
+bool ParameterSweep::validate(std::string &error) const
+{
+    const std::vector<ModelDefinition> &definitions = scenarioModelDefinitions();
+
+    if (settings.modelIndex < 0 || settings.modelIndex >= static_cast<int>(definitions.size()))
+    {
+        error = "Unknown model";
+        return false;
+    }
+
+    const ModelDefinition &definition = definitions[settings.modelIndex];
+
+    if (settings.parameters.size() != definition.parameterNames.size() || settings.initialConditions.size() != definition.variableShortNames.size())
+    {
+        error = "Parameters or initial conditions do not match the model";
+        return false;
+    }
+
+    if (settings.axes.empty() || settings.axes.size() > maxAxes)
+    {
+        error = "Between 1 and 4 parameters must be swept";
+        return false;
+    }
+
+    for (size_t a = 0; a < settings.axes.size(); a++)
+    {
+        const SweepAxis &axis = settings.axes[a];
+
+        if (axis.parameterIndex < 0 || axis.parameterIndex >= static_cast<int>(settings.parameters.size()) || axis.numPoints < 1 || !(axis.min <= axis.max))
+        {
+            error = "Invalid sweep axis";
+            return false;
+        }
+
+        for (size_t b = 0; b < a; b++)
+        {
+            if (settings.axes[b].parameterIndex == axis.parameterIndex)
+            {
+                error = "A parameter is swept twice";
+                return false;
+            }
+        }
+    }
+
+    uint64_t numPoints = 1;
+
+    for (const SweepAxis &axis : settings.axes)
+    {
+        if (static_cast<uint64_t>(axis.numPoints) > maxPoints / numPoints)
+        {
+            error = "The grid has more than " + std::to_string(maxPoints) + " points";
+            return false;
+        }
+
+        numPoints *= static_cast<uint64_t>(axis.numPoints);
+    }
+
+    if (!(settings.timeEnd > 0.0))
+    {
+        error = "Time end must be positive";
+        return false;
+    }
+
+    if (settings.analytic && !hasAnalyticPeak(settings.modelIndex) && !hasAnalyticFinalSize(settings.modelIndex))
+    {
+        error = "The model has no closed-form metrics";
+        return false;
+    }
+
+    return true;
+}
+
+uint64_t ParameterSweep::getNumPoints() const
+{
+    uint64_t numPoints = 1;
+
+    for (const SweepAxis &axis : settings.axes)
+        numPoints *= static_cast<uint64_t>(axis.numPoints);
+
+    return numPoints;
+}
+
+double ParameterSweep::getAxisValue(int axis, uint64_t point) const
+{
+    // Last axis varies fastest
+
+    for (int a = static_cast<int>(settings.axes.size()) - 1; a > axis; a--)
+        point /= static_cast<uint64_t>(settings.axes[a].numPoints);
+
+    const SweepAxis &sweepAxis = settings.axes[axis];
+
+    uint64_t index = point % static_cast<uint64_t>(sweepAxis.numPoints);
+
+    if (sweepAxis.numPoints == 1)
+        return sweepAxis.min;
+
+    return sweepAxis.min + (sweepAxis.max - sweepAxis.min) * index / (sweepAxis.numPoints - 1);
+}
+
+const std::vector<SweepMetrics> &ParameterSweep::getMetrics() const
+{
+    return metrics;
+}
+
+// Reduces the trajectory to its metrics at every step
+
+template <typename State>
+struct MetricsObserver
+{
+    SweepMetrics &metrics;
+    int infectedIndex;
+    int asymptomaticIndex;
+
+    void operator()(const State &x, double t)
+    {
+        double infected = x[infectedIndex] + (asymptomaticIndex >= 0 ? x[asymptomaticIndex] : 0.0);
+
+        if (infected > metrics.peakInfected)
+        {
+            metrics.peakInfected = infected;
+            metrics.peakTime = t;
+        }
+
+        metrics.finalSusceptible = x[0];
+    }
+};
+
+template <typename State, typename Model>
+static SweepMetrics integrateMetrics(Model model, const state_type &initialConditions, double timeEnd, int infectedIndex, int asymptomaticIndex)
+{
+    using namespace boost::numeric::odeint;
+
+    typedef runge_kutta_dopri5<State> error_stepper_type;
+
+    State x;
+    std::copy(initialConditions.begin(), initialConditions.end(), x.begin());
+
+    SweepMetrics metrics = {-1.0, 0.0, x[0], 0.0};
+
+    integrate_adaptive(make_controlled<error_stepper_type>(1.0e-10, 1.0e-6), model, x, 0.0, timeEnd, 0.01, MetricsObserver<State>{metrics, infectedIndex, asymptomaticIndex});
+
+    metrics.attackRate = initialConditions[0] - metrics.finalSusceptible;
+
+    return metrics;
+}
+
+SweepMetrics ParameterSweep::pointMetrics(int modelIndex, const std::vector<double> &parameters, const state_type &initialConditions, double timeEnd)
+{
+    const ModelDefinition &definition = scenarioModelDefinitions()[modelIndex];
+
+    SweepMetrics metrics = SweepMetrics();
+
+    withModel(modelIndex, [&](auto type){
+        typedef decltype(type) Type;
+        metrics = integrateMetrics<std::array<double, Type::dimension>>(typename Type::template type<double>(parameters), initialConditions, timeEnd, definition.infectedIndex, definition.asymptomaticIndex);
+    });
+
+    return metrics;
+}
+
+SweepMetrics ParameterSweep::analyticPointMetrics(int modelIndex, const std::vector<double> &parameters, const state_type &initialConditions)
+{
+    AnalyticMetrics analytic = analyticMetrics(modelIndex, parameters, initialConditions);
+
+    return SweepMetrics{analytic.peakInfected, std::numeric_limits<double>::quiet_NaN(), analytic.finalSusceptible, analytic.attackRate};
+}
+
+bool ParameterSweep::run(const std::atomic<bool> &canceled, const std::function<void(double)> &progress)
+{
+    uint64_t numPoints = getNumPoints();
+
+    metrics.assign(numPoints, SweepMetrics());
+
+    // Blocks of points are spread over threads
+
+    const uint64_t blockSize = 64;
+    uint64_t numBlocks = (numPoints + blockSize - 1) / blockSize;
+
+    std::atomic<uint64_t> donePoints(0);
+
+    std::vector<std::vector<double>> threadParameters(parallelThreadCount(numBlocks), settings.parameters);
+
+    parallelFor(numBlocks, canceled, [&](size_t block, int thread){
+        std::vector<double> &parameters = threadParameters[thread];
+
+        uint64_t begin = block * blockSize;
+        uint64_t end = std::min(begin + blockSize, numPoints);
+
+        for (uint64_t point = begin; point < end; point++)
+        {
+            for (size_t a = 0; a < settings.axes.size(); a++)
+                parameters[settings.axes[a].parameterIndex] = getAxisValue(static_cast<int>(a), point);
+
+            if (settings.analytic)
+                metrics[point] = analyticPointMetrics(settings.modelIndex, parameters, settings.initialConditions);
+            else
+                metrics[point] = pointMetrics(settings.modelIndex, parameters, settings.initialConditions, settings.timeEnd);
+        }
+
+        donePoints += end - begin;
+    }, [&](){
+        if (progress)
+            progress(static_cast<double>(donePoints) / numPoints);
+    });
+
+    if (canceled)
+    {
+        std::vector<SweepMetrics>().swap(metrics);
+        return false;
+    }
+
+    if (progress)
+        progress(1.0);
+
+    return true;
+}
+
+bool ParameterSweep::writeText(const std::string &fileName) const
+{
+    std::FILE *file = std::fopen(fileName.c_str(), "wb");
+
+    if (file == nullptr)
+        return false;
+
+    const ModelDefinition &definition = scenarioModelDefinitions()[settings.modelIndex];
+    std::vector<QString> parameterNames(definition.parameterNames.begin(), definition.parameterNames.end());
+
+    // Header
+
+    std::string text = "# " + definition.name.toStdString() + " sweep, time end ";
+    text += (settings.analytic ? std::string("inf (analytic)") : std::to_string(settings.timeEnd)) + "\n";
+
+    for (size_t a = 0; a < settings.axes.size(); a++)
+        text += parameterNames[settings.axes[a].parameterIndex].toStdString() + "\t";
+
+    text += "PeakInfected\tPeakTime\tFinalSusceptible\tAttackRate\n";
+
+    // Rows, formatted in a buffer flushed when almost full
+
+    const size_t bufferSize = 1 << 20;
+    const size_t maxRowSize = 32 * (maxAxes + sweepNumMetrics);
+
+    size_t used = text.size();
+    text.resize(std::max(bufferSize, used + maxRowSize));
+
+    bool success = true;
+
+    for (uint64_t point = 0; point < metrics.size() && success; point++)
+    {
+        char *out = &text[used];
+
+        for (size_t a = 0; a < settings.axes.size(); a++)
+        {
+            out = std::to_chars(out, out + 32, getAxisValue(static_cast<int>(a), point)).ptr;
+            *out++ = '\t';
+        }
+
+        const double *values = &metrics[point].peakInfected;
+
+        for (uint32_t m = 0; m < sweepNumMetrics; m++)
+        {
+            out = std::to_chars(out, out + 32, values[m]).ptr;
+            *out++ = m + 1 < sweepNumMetrics ? '\t' : '\n';
+        }
+
+        used = out - text.data();
+
+        if (used + maxRowSize > text.size())
+        {
+            success = std::fwrite(text.data(), 1, used, file) == used;
+            used = 0;
+        }
+    }
+
+    if (success && used > 0)
+        success = std::fwrite(text.data(), 1, used, file) == used;
+
+    return std::fclose(file) == 0 && success;
+}
+
+bool ParameterSweep::writeBinary(const std::string &fileName) const
+{
+    std::FILE *file = std::fopen(fileName.c_str(), "wb");
+
+    if (file == nullptr)
+        return false;
+
+    SweepHeader header;
+    std::memcpy(header.magic, sweepMagic, sizeof(sweepMagic));
+    header.version = sweepVersion;
+    header.modelIndex = static_cast<uint32_t>(settings.modelIndex);
+    header.dimension = static_cast<uint32_t>(settings.initialConditions.size());
+    header.numParameters = static_cast<uint32_t>(settings.parameters.size());
+    header.numAxes = static_cast<uint32_t>(settings.axes.size());
+    header.numMetrics = sweepNumMetrics;
+    header.numPoints = metrics.size();
+    header.timeEnd = settings.analytic ? std::numeric_limits<double>::infinity() : settings.timeEnd;
+
+    bool success = std::fwrite(&header, sizeof(header), 1, file) == 1;
+
+    for (const SweepAxis &axis : settings.axes)
+    {
+        SweepAxisEntry entry;
+        entry.parameterIndex = static_cast<uint32_t>(axis.parameterIndex);
+        entry.numPoints = static_cast<uint32_t>(axis.numPoints);
+        entry.min = axis.min;
+        entry.max = axis.max;
+
+        success = success && std::fwrite(&entry, sizeof(entry), 1, file) == 1;
+    }
+
+    success = success && std::fwrite(settings.parameters.data(), sizeof(double), settings.parameters.size(), file) == settings.parameters.size();
+    success = success && std::fwrite(settings.initialConditions.data(), sizeof(double), settings.initialConditions.size(), file) == settings.initialConditions.size();
+    success = success && std::fwrite(metrics.data(), sizeof(SweepMetrics), metrics.size(), file) == metrics.size();
+
+    return std::fclose(file) == 0 && success;
+}
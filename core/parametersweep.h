@@ -0,0 +1,142 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#ifndef PARAMETERSWEEP_H
+#define PARAMETERSWEEP_H
+
+#include "models.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Binary sweep format
+// Fields are stored in the native byte order of the writer and every block is 8-byte aligned
+//
+// SweepHeader
+// Axes: one SweepAxisEntry per swept parameter
+// Base parameters (doubles), used for parameters not swept
+// Initial conditions (doubles)
+// Metrics: one row of numMetrics doubles per grid point, in the order of SweepMetrics,
+//          with the last axis varying fastest
+
+const char sweepMagic[8] = {'S', 'I', 'R', 'V', 'I', 'E', 'W', 'S'};
+const uint32_t sweepVersion = 1;
+
+struct SweepHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t modelIndex;
+    uint32_t dimension;
+    uint32_t numParameters;
+    uint32_t numAxes;
+    uint32_t numMetrics;
+    uint64_t numPoints;
+    double timeEnd;
+};
+
+struct SweepAxisEntry
+{
+    uint32_t parameterIndex;
+    uint32_t numPoints;
+    double min;
+    double max;
+};
+
+static_assert(sizeof(SweepHeader) == 48, "Unexpected sweep header size");
+static_assert(sizeof(SweepAxisEntry) == 24, "Unexpected sweep axis entry size");
+
+// Summary of a trajectory, reduced while integrating
+// Infected include asymptomatic ones in the SIRA model. The attack rate is the
+// fraction of the population infected, i.e. the drop of susceptibles, which
+// underestimates it when susceptibles are replenished (SIRS, vital dynamics)
+
+struct SweepMetrics
+{
+    double peakInfected;
+    double peakTime;
+    double finalSusceptible;
+    double attackRate;
+};
+
+const uint32_t sweepNumMetrics = sizeof(SweepMetrics) / sizeof(double);
+
+// Swept parameter with evenly spaced values from min to max
+
+struct SweepAxis
+{
+    int parameterIndex;
+    double min;
+    double max;
+    int numPoints;
+};
+
+struct SweepSettings
+{
+    int modelIndex;
+    std::vector<double> parameters;
+    state_type initialConditions;
+    double timeEnd;
+    std::vector<SweepAxis> axes;
+
+    // Closed forms instead of integration, see analyticmetrics.h, with time end written as infinity
+
+    bool analytic = false;
+};
+
+// Grid sweep of 1 to 4 parameters of a scenario model, from time 0 to timeEnd
+// Points are integrated on all cores with fixed-size states, and only their metrics are kept
+
+class ParameterSweep
+{
+public:
+    static const int maxAxes = 4;
+
+    // Metrics of every point are kept in memory, 32 bytes each
+
+    static const uint64_t maxPoints = uint64_t(1) << 25;
+
+    explicit ParameterSweep(const SweepSettings &sweepSettings);
+
+    bool validate(std::string &error) const;
+
+    uint64_t getNumPoints() const;
+    double getAxisValue(int axis, uint64_t point) const;
+    const std::vector<SweepMetrics> &getMetrics() const;
+
+    // Progress is reported from the calling thread as a fraction
+
+    bool run(const std::atomic<bool> &canceled, const std::function<void(double)> &progress);
+
+    bool writeText(const std::string &fileName) const;
+    bool writeBinary(const std::string &fileName) const;
+
+    static SweepMetrics pointMetrics(int modelIndex, const std::vector<double> &parameters, const state_type &initialConditions, double timeEnd);
+
+    // Metrics without a closed form for the model, always including the peak time, are NaN
+
+    static SweepMetrics analyticPointMetrics(int modelIndex, const std::vector<double> &parameters, const state_type &initialConditions);
+
+private:
+    SweepSettings settings;
+    std::vector<SweepMetrics> metrics;
+};
+
+#endif // PARAMETERSWEEP_H
@@ -0,0 +1,239 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "phasespaceexportjob.h"
+#include "phasespaceintegrator.h"
+#include <charconv>
+#include <cstring>
+
+PhaseSpaceExportJob::PhaseSpaceExportJob(const PhaseSpaceSource &exportSource, QString exportFileName, bool exportBinary)
+{
+    source = exportSource;
+    fileName = exportFileName;
+    binary = exportBinary;
+
+    canceled = false;
+    writeError = false;
+
+    buffer.reserve((1 << 20) + 4096);
+
+    // Deleted by the receiver of finished()
+
+    setAutoDelete(false);
+}
+
+void PhaseSpaceExportJob::run()
+{
+    bool success = execute();
+
+    emit finished(success, canceled);
+}
+
+void PhaseSpaceExportJob::cancel()
+{
+    canceled = true;
+}
+
+bool PhaseSpaceExportJob::execute()
+{
+    QFile file(fileName);
+
+    QIODevice::OpenMode mode = binary ? QIODevice::WriteOnly : QIODevice::WriteOnly | QIODevice::Text;
+
+    if (!file.open(mode))
+    {
+        return false;
+    }
+
+    emit progressChanged(0);
+
+    writeHeader();
+    flush(file);
+
+    size_t numTrajectories = source.initialConditions.size();
+
+    for (size_t i = 0; i < numTrajectories && !canceled && !writeError; i++)
+    {
+        writeTrajectory(file, i);
+
+        emit progressChanged(static_cast<int>(100 * (i + 1) / numTrajectories));
+    }
+
+    file.close();
+
+    if (canceled)
+    {
+        file.remove();
+        return false;
+    }
+
+    return !writeError;
+}
+
+void PhaseSpaceExportJob::writeHeader()
+{
+    if (binary)
+    {
+        QByteArray strings;
+
+        auto appendString = [&strings](QString string)
+        {
+            QByteArray utf8 = string.toUtf8();
+            quint32 length = static_cast<quint32>(utf8.size());
+            strings.append(reinterpret_cast<const char*>(&length), sizeof(length));
+            strings.append(utf8);
+        };
+
+        appendString(source.modelName);
+
+        for (size_t i = 0; i < source.variableShortNames.size(); i++)
+            appendString(source.variableShortNames[i]);
+
+        for (size_t i = 0; i < source.parameterNames.size(); i++)
+            appendString(source.parameterNames[i]);
+
+        PhaseSpaceHeader header;
+        std::memcpy(header.magic, phaseSpaceMagic, sizeof(phaseSpaceMagic));
+        header.version = phaseSpaceVersion;
+        header.modelIndex = static_cast<uint32_t>(source.modelIndex);
+        header.dimension = static_cast<uint32_t>(source.dimension);
+        header.numParameters = static_cast<uint32_t>(source.parameter.size());
+        header.numTrajectories = static_cast<uint32_t>(source.initialConditions.size());
+        header.stringsSize = static_cast<uint32_t>(strings.size());
+        header.timeEnd = source.timeEnd;
+
+        strings.append(QByteArray(static_cast<int>(columnarPadding(sizeof(header) + strings.size())), '\0'));
+
+        appendBinary(&header, sizeof(header));
+        appendBinary(strings.constData(), strings.size());
+        appendBinary(source.parameter.data(), source.parameter.size() * sizeof(double));
+    }
+    else
+    {
+        buffer.append("# Model\t" + source.modelName.toUtf8() + "\n");
+        buffer.append("# Parameters");
+
+        for (size_t i = 0; i < source.parameter.size(); i++)
+        {
+            buffer.append("\t" + source.parameterNames[i].toUtf8() + "=");
+            appendText(source.parameter[i], ' ');
+            buffer.chop(1);
+        }
+
+        buffer.append("\n# t");
+
+        for (size_t i = 0; i < source.variableShortNames.size(); i++)
+        {
+            buffer.append("\t" + source.variableShortNames[i].toUtf8());
+        }
+
+        buffer.append("\n\n");
+    }
+}
+
+void PhaseSpaceExportJob::writeTrajectory(QFile &file, size_t trajectoryIndex)
+{
+    const state_type &x0 = source.initialConditions[trajectoryIndex];
+
+    size_t dimension = x0.size();
+
+    quint64 numSteps = 0;
+    qint64 recordPosition = file.pos() + buffer.size();
+
+    if (binary)
+    {
+        appendBinary(&numSteps, sizeof(numSteps));
+        appendBinary(x0.data(), dimension * sizeof(double));
+    }
+    else
+    {
+        buffer.append("# Trajectory " + QByteArray::number(static_cast<qulonglong>(trajectoryIndex)) + "\tIC");
+
+        for (size_t k = 0; k < dimension; k++)
+            appendText(x0[k], '\t');
+
+        buffer.chop(1);
+        buffer.append('\n');
+    }
+
+    // Steps are written as soon as the integrator produces them
+
+    integratePhaseSpaceTrajectory(source.modelIndex, source.parameter, x0, source.timeEnd, [&](const state_type &x, double t){
+        if (binary)
+        {
+            appendBinary(&t, sizeof(t));
+            appendBinary(x.data(), dimension * sizeof(double));
+        }
+        else
+        {
+            appendText(t, '\t');
+
+            for (size_t k = 0; k < dimension; k++)
+                appendText(x[k], k + 1 < dimension ? '\t' : '\n');
+        }
+
+        numSteps++;
+
+        if (buffer.size() >= (1 << 20))
+            flush(file);
+    });
+
+    if (binary)
+    {
+        // Number of steps is known once the trajectory has been integrated
+
+        flush(file);
+
+        if (!writeError)
+        {
+            file.seek(recordPosition);
+            writeError = file.write(reinterpret_cast<const char*>(&numSteps), sizeof(numSteps)) != sizeof(numSteps);
+            file.seek(file.size());
+        }
+    }
+    else
+    {
+        buffer.append('\n');
+    }
+}
+
+void PhaseSpaceExportJob::appendBinary(const void *data, size_t size)
+{
+    buffer.append(reinterpret_cast<const char*>(data), static_cast<int>(size));
+}
+
+void PhaseSpaceExportJob::appendText(double value, char separator)
+{
+    // Shortest representation that round-trips exactly
+
+    char text[32];
+
+    std::to_chars_result result = std::to_chars(text, text + sizeof(text) - 1, value);
+    *result.ptr++ = separator;
+
+    buffer.append(text, static_cast<int>(result.ptr - text));
+}
+
+void PhaseSpaceExportJob::flush(QFile &file)
+{
+    if (!writeError && !buffer.isEmpty())
+    {
+        writeError = file.write(buffer) != buffer.size();
+    }
+
+    buffer.resize(0);
+}
@@ -0,0 +1,111 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef PHASESPACEEXPORTJOB_H
+#define PHASESPACEEXPORTJOB_H
+
+#include "exportjob.h"
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include <QObject>
+#include <QRunnable>
+#include <QString>
+#include <QByteArray>
+#include <QFile>
+
+typedef std::vector<double> state_type;
+
+// Binary phase space format
+// Fields are stored in little-endian byte order and every block is 8-byte aligned
+//
+// PhaseSpaceHeader
+// Strings: model name, variable short names and parameter names,
+//          each one as a uint32 byte count followed by UTF-8 bytes, padded to 8 bytes
+// Parameters (doubles)
+// Trajectory records: uint64 number of steps, initial condition (doubles),
+//                     and one row per step with time and variables (doubles)
+
+const char phaseSpaceMagic[8] = {'S', 'I', 'R', 'V', 'I', 'E', 'W', 'P'};
+const uint32_t phaseSpaceVersion = 1;
+
+struct PhaseSpaceHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t modelIndex;
+    uint32_t dimension;
+    uint32_t numParameters;
+    uint32_t numTrajectories;
+    uint32_t stringsSize;
+    double timeEnd;
+};
+
+static_assert(sizeof(PhaseSpaceHeader) == 40, "Unexpected phase space header size");
+
+// Phase space model and initial conditions grid to export
+
+struct PhaseSpaceSource
+{
+    QString modelName;
+    int modelIndex;
+    int dimension;
+    std::vector<QString> variableShortNames;
+    std::vector<QString> parameterNames;
+    std::vector<double> parameter;
+    std::vector<state_type> initialConditions;
+    double timeEnd;
+};
+
+// Export of phase space trajectories running on the compute thread pool, since integrating them dominates
+// Trajectories are integrated one at a time and their steps are streamed to the file
+// as they are computed, so no trajectory is held in memory
+
+class PhaseSpaceExportJob: public QObject, public QRunnable
+{
+    Q_OBJECT
+
+public:
+    PhaseSpaceExportJob(const PhaseSpaceSource &exportSource, QString exportFileName, bool exportBinary);
+
+    void run() override;
+    void cancel();
+
+signals:
+    void progressChanged(int percent);
+    void finished(bool success, bool canceled);
+
+private:
+    PhaseSpaceSource source;
+    QString fileName;
+    bool binary;
+
+    std::atomic<bool> canceled;
+
+    QByteArray buffer;
+    bool writeError;
+
+    bool execute();
+    void writeHeader();
+    void writeTrajectory(QFile &file, size_t trajectoryIndex);
+
+    void appendBinary(const void *data, size_t size);
+    void appendText(double value, char separator);
+    void flush(QFile &file);
+};
+
+#endif // PHASESPACEEXPORTJOB_H
@@ -0,0 +1,60 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#ifndef PHASESPACEINTEGRATOR_H
+#define PHASESPACEINTEGRATOR_H
+
+#include "models.h"
+#include <vector>
+#ifndef Q_MOC_RUN
+#include <boost/numeric/odeint.hpp>
+#endif
+
+// Integrates a single phase space trajectory from time 0, passing each step to the observer
+// Model indices: 0 SIR, 1 SIRS, 2 SIR + Vital dynamics, 3 SIRS + Vital dynamics
+
+template <typename Observer>
+void integratePhaseSpaceTrajectory(int modelIndex, const std::vector<double> &parameter, state_type x, double timeEnd, Observer observer)
+{
+    using namespace boost::numeric::odeint;
+
+    typedef runge_kutta_dopri5<state_type> error_stepper_type;
+
+    if (modelIndex == 0) // SIR model
+    {
+        SIR sir(parameter);
+        integrate_adaptive(make_controlled<error_stepper_type>(1.0e-10, 1.0e-6), sir, x, 0.0, timeEnd, 0.01, observer);
+    }
+    else if (modelIndex == 1) // SIRS model
+    {
+        SIRS sirs(parameter);
+        integrate_adaptive(make_controlled<error_stepper_type>(1.0e-10, 1.0e-6), sirs, x, 0.0, timeEnd, 0.01, observer);
+    }
+    else if (modelIndex == 2) // SIR + Vital dynamics model
+    {
+        SIRVitalDynamics sirVitalDynamics(parameter);
+        integrate_adaptive(make_controlled<error_stepper_type>(1.0e-10, 1.0e-6), sirVitalDynamics, x, 0.0, timeEnd, 0.01, observer);
+    }
+    else if (modelIndex == 3) // SIRS + Vital dynamics model
+    {
+        SIRSVitalDynamics sirsVitalDynamics(parameter);
+        integrate_adaptive(make_controlled<error_stepper_type>(1.0e-10, 1.0e-6), sirsVitalDynamics, x, 0.0, timeEnd, 0.01, observer);
+    }
+}
+
+#endif // PHASESPACEINTEGRATOR_H
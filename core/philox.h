@@ -0,0 +1,112 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#ifndef PHILOX_H
+#define PHILOX_H
+
+#include <cmath>
+#include <cstdint>
+
+// Philox4x32-10 counter-based random numbers (Salmon et al., SC 2011)
+// Each (seed, stream) key gives an independent sequence and the n-th block of a sequence
+// is a pure function of n, so threads need no shared state and results do not depend
+// on scheduling
+
+class Philox
+{
+public:
+    Philox(uint64_t seed, uint64_t stream): counter(0), index(4)
+    {
+        key[0] = static_cast<uint32_t>(seed);
+        key[1] = static_cast<uint32_t>(seed >> 32);
+        streamLow = static_cast<uint32_t>(stream);
+        streamHigh = static_cast<uint32_t>(stream >> 32);
+    }
+
+    uint32_t next()
+    {
+        if (index == 4)
+        {
+            generate();
+            index = 0;
+        }
+
+        return block[index++];
+    }
+
+    // Uniform in (0, 1), never 0 so that its logarithm is finite
+
+    double uniform()
+    {
+        uint64_t bits = (static_cast<uint64_t>(next()) << 21) ^ next();
+        return ((bits & ((uint64_t(1) << 53) - 1)) + 0.5) / 9007199254740992.0;
+    }
+
+    // Standard normal by Box-Muller, one value per pair of uniforms
+
+    double normal()
+    {
+        const double twoPi = 6.283185307179586;
+        return std::sqrt(-2.0 * std::log(uniform())) * std::cos(twoPi * uniform());
+    }
+
+private:
+    uint32_t key[2];
+    uint32_t streamLow;
+    uint32_t streamHigh;
+    uint64_t counter;
+
+    uint32_t block[4];
+    int index;
+
+    static void mulhilo(uint32_t a, uint32_t b, uint32_t &hi, uint32_t &lo)
+    {
+        uint64_t product = static_cast<uint64_t>(a) * b;
+        hi = static_cast<uint32_t>(product >> 32);
+        lo = static_cast<uint32_t>(product);
+    }
+
+    void generate()
+    {
+        uint32_t x[4] = {static_cast<uint32_t>(counter), static_cast<uint32_t>(counter >> 32), streamLow, streamHigh};
+        uint32_t k[2] = {key[0], key[1]};
+
+        for (int round = 0; round < 10; round++)
+        {
+            uint32_t hi0, lo0, hi1, lo1;
+
+            mulhilo(0xD2511F53u, x[0], hi0, lo0);
+            mulhilo(0xCD9E8D57u, x[2], hi1, lo1);
+
+            x[0] = hi1 ^ x[1] ^ k[0];
+            x[1] = lo1;
+            x[2] = hi0 ^ x[3] ^ k[1];
+            x[3] = lo0;
+
+            k[0] += 0x9E3779B9u;
+            k[1] += 0xBB67AE85u;
+        }
+
+        for (int i = 0; i < 4; i++)
+            block[i] = x[i];
+
+        counter++;
+    }
+};
+
+#endif // PHILOX_H
@@ -0,0 +1,546 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "posteriorsampler.h"
+#include "scenariointegrator.h"
+#include "modelcatalog.h"
+#include "philox.h"
+#include "parallelfor.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <mutex>
+
+// Lower triangular factor of a symmetric positive definite matrix, in place
+// Returns false if it is not positive definite
+
+static bool cholesky(std::vector<double> &a, int n)
+{
+    for (int j = 0; j < n; j++)
+    {
+        double diagonal = a[j * n + j];
+
+        for (int k = 0; k < j; k++)
+            diagonal -= a[j * n + k] * a[j * n + k];
+
+        if (diagonal <= 0.0)
+            return false;
+
+        a[j * n + j] = std::sqrt(diagonal);
+
+        for (int i = j + 1; i < n; i++)
+        {
+            double value = a[i * n + j];
+
+            for (int k = 0; k < j; k++)
+                value -= a[i * n + k] * a[j * n + k];
+
+            a[i * n + j] = value / a[j * n + j];
+        }
+
+        for (int k = j + 1; k < n; k++)
+            a[j * n + k] = 0.0;
+    }
+
+    return true;
+}
+
+PosteriorSampler::PosteriorSampler(const SamplerSettings &samplerSettings): settings(samplerSettings)
+{
+    // Infected compartment, unknown models fail validation
+
+    infectedIndex = isScenarioModel(settings.modelIndex) ? scenarioModelDefinitions()[settings.modelIndex].infectedIndex : -1;
+
+    if (settings.scenarios.empty())
+        return;
+
+    const Scenario &first = settings.scenarios.front();
+
+    // Slider bounds, then wide ranges of the logarithms
+
+    lowerBounds = first.parametersMin;
+    upperBounds = first.parametersMax;
+
+    double total = 0.0;
+
+    for (double value : first.x0)
+        total += value;
+
+    lowerBounds.push_back(std::log(1.0e-12));
+    upperBounds.push_back(std::log(std::max(total, 1.0e-12)));
+
+    lowerBounds.push_back(std::log(1.0e-9));
+    upperBounds.push_back(0.0);
+
+    // Observation times within the chain, each observation pointing at the row of its time
+
+    double timeStart = first.timeStart;
+    double timeEnd = settings.scenarios.back().timeEnd;
+
+    for (size_t n = 0; n < settings.observedTimes.size(); n++)
+    {
+        double time = settings.observedTimes[n];
+
+        if (time < timeStart || time > timeEnd)
+            continue;
+
+        for (size_t i = 0; i < settings.observedValues.size() && i < first.x0.size(); i++)
+        {
+            if (n < settings.observedValues[i].size() && std::isfinite(settings.observedValues[i][n]))
+            {
+                fitTimes.push_back(time);
+                break;
+            }
+        }
+    }
+
+    std::sort(fitTimes.begin(), fitTimes.end());
+    fitTimes.erase(std::unique(fitTimes.begin(), fitTimes.end()), fitTimes.end());
+
+    for (size_t n = 0; n < settings.observedTimes.size(); n++)
+    {
+        auto it = std::lower_bound(fitTimes.begin(), fitTimes.end(), settings.observedTimes[n]);
+
+        if (it == fitTimes.end() || *it != settings.observedTimes[n])
+            continue;
+
+        for (size_t i = 0; i < settings.observedValues.size() && i < first.x0.size(); i++)
+        {
+            if (n < settings.observedValues[i].size() && std::isfinite(settings.observedValues[i][n]))
+                observations.push_back(Observation{static_cast<size_t>(it - fitTimes.begin()), static_cast<int>(i), settings.observedValues[i][n]});
+        }
+    }
+}
+
+bool PosteriorSampler::validate(std::string &error) const
+{
+    if (!isScenarioModel(settings.modelIndex) || settings.scenarios.empty())
+    {
+        error = "Unknown model";
+        return false;
+    }
+
+    if (settings.numChains < 1 || settings.numChains > maxChains)
+    {
+        error = "Number of chains must be between 1 and " + std::to_string(maxChains);
+        return false;
+    }
+
+    if (settings.burnIn < 0 || settings.numSamples < 1)
+    {
+        error = "Number of samples must be positive";
+        return false;
+    }
+
+    if (observations.size() <= static_cast<size_t>(getNumUnknowns()))
+    {
+        error = "Fewer observations within the time range of the scenarios than unknowns";
+        return false;
+    }
+
+    return true;
+}
+
+int PosteriorSampler::getNumUnknowns() const
+{
+    return static_cast<int>(lowerBounds.size());
+}
+
+std::vector<std::string> PosteriorSampler::getUnknownNames() const
+{
+    const ModelDefinition &definition = scenarioModelDefinitions()[settings.modelIndex];
+
+    std::vector<std::string> names;
+
+    for (const QString &name : definition.parameterNames)
+        names.push_back(name.toStdString());
+
+    names.push_back("log" + std::next(definition.variableShortNames.begin(), infectedIndex)->toStdString() + "0");
+    names.push_back("logSigma");
+
+    return names;
+}
+
+const std::vector<std::vector<double>> &PosteriorSampler::getSamples() const
+{
+    return samples;
+}
+
+const std::vector<double> &PosteriorSampler::getAcceptanceRates() const
+{
+    return acceptanceRates;
+}
+
+std::vector<Scenario> PosteriorSampler::applyValues(const std::vector<double> &values) const
+{
+    std::vector<Scenario> scenarios = settings.scenarios;
+
+    const std::vector<double> &firstParameters = settings.scenarios.front().parameters;
+
+    for (Scenario &scenario : scenarios)
+    {
+        for (size_t k = 0; k < firstParameters.size(); k++)
+        {
+            double value = scenario.parameters[k] + values[k] - firstParameters[k];
+            scenario.parameters[k] = std::min(std::max(value, scenario.parametersMin[k]), scenario.parametersMax[k]);
+        }
+    }
+
+    state_type &x0 = scenarios.front().x0;
+
+    double infected = std::exp(values[firstParameters.size()]);
+
+    x0[0] = std::max(x0[0] + x0[infectedIndex] - infected, 0.0);
+    x0[infectedIndex] = infected;
+
+    return scenarios;
+}
+
+double PosteriorSampler::sumSquares(const std::vector<double> &values, std::vector<double> &buffer) const
+{
+    std::vector<Scenario> scenarios = applyValues(values);
+
+    size_t dimension = scenarios.front().x0.size();
+
+    buffer.resize(fitTimes.size() * dimension);
+
+    integrateChainOnGrid(settings.modelIndex, scenarios, fitTimes, buffer.data());
+
+    double sum = 0.0;
+
+    for (const Observation &observation : observations)
+    {
+        double residual = buffer[observation.row * dimension + observation.variable] - observation.value;
+        sum += residual * residual;
+    }
+
+    return std::isfinite(sum) ? sum : std::numeric_limits<double>::quiet_NaN();
+}
+
+double PosteriorSampler::logPosterior(const std::vector<double> &values, std::vector<double> &buffer) const
+{
+    for (size_t k = 0; k < values.size(); k++)
+    {
+        if (values[k] < lowerBounds[k] || values[k] > upperBounds[k])
+            return -std::numeric_limits<double>::infinity();
+    }
+
+    double sum = sumSquares(values, buffer);
+
+    if (std::isnan(sum))
+        return -std::numeric_limits<double>::infinity();
+
+    // Gaussian likelihood up to a constant, priors are flat within bounds
+
+    double logSigma = values.back();
+
+    return -static_cast<double>(observations.size()) * logSigma - 0.5 * sum * std::exp(-2.0 * logSigma);
+}
+
+std::vector<double> PosteriorSampler::startValues(int chain) const
+{
+    const Scenario &first = settings.scenarios.front();
+
+    std::vector<double> values = first.parameters;
+    values.push_back(std::log(std::max(first.x0[infectedIndex], 1.0e-12)));
+    values.push_back(0.0);
+
+    // Chains but the first one start scattered around the current values
+
+    if (chain > 0)
+    {
+        Philox generator(settings.seed, static_cast<uint64_t>(maxChains + chain));
+
+        for (size_t k = 0; k < first.parameters.size(); k++)
+            values[k] += 0.05 * (upperBounds[k] - lowerBounds[k]) * generator.normal();
+
+        values[first.parameters.size()] += 0.5 * generator.normal();
+    }
+
+    for (size_t k = 0; k + 1 < values.size(); k++)
+        values[k] = std::min(std::max(values[k], lowerBounds[k]), upperBounds[k]);
+
+    // Noise starts at the root mean square residual
+
+    std::vector<double> buffer;
+    double sum = sumSquares(values, buffer);
+
+    values.back() = std::isnan(sum) ? -3.0 : 0.5 * std::log(std::max(sum / observations.size(), 1.0e-18));
+    values.back() = std::min(std::max(values.back(), lowerBounds.back()), upperBounds.back());
+
+    return values;
+}
+
+bool PosteriorSampler::run(const std::atomic<bool> &canceled, const std::function<void(double)> &progress)
+{
+    int d = getNumUnknowns();
+    int numIterations = settings.burnIn + settings.numSamples;
+
+    std::FILE *file = nullptr;
+    std::mutex fileMutex;
+    bool writeFailed = false;
+
+    if (!settings.fileName.empty())
+    {
+        file = std::fopen(settings.fileName.c_str(), "wb");
+
+        if (file == nullptr)
+            return false;
+
+        std::string header = "# " + scenarioModelDefinitions()[settings.modelIndex].name.toStdString() + " posterior samples\nChain\tIteration\tLogPosterior";
+
+        for (const std::string &name : getUnknownNames())
+            header += "\t" + name;
+
+        header += "\n";
+
+        writeFailed = std::fwrite(header.data(), 1, header.size(), file) != header.size();
+    }
+
+    std::vector<std::vector<std::vector<double>>> chainSamples(settings.numChains);
+    std::vector<double> chainAcceptance(settings.numChains, 0.0);
+
+    std::atomic<int64_t> doneIterations(0);
+
+    auto chainWorker = [&](int chain)
+    {
+        Philox generator(settings.seed, static_cast<uint64_t>(chain));
+
+        std::vector<double> buffer;
+        std::vector<double> current = startValues(chain);
+        double currentLogPosterior = logPosterior(current, buffer);
+
+        // Proposal covariance, diagonal at first, then the scaled covariance of the second half of
+        // burn-in (Haario et al., 2001), with a global scale tuned towards the optimal acceptance rate
+
+        std::vector<double> factor(d * d, 0.0);
+
+        for (int k = 0; k < d; k++)
+            factor[k * d + k] = k < d - 2 ? 0.01 * (upperBounds[k] - lowerBounds[k]) : 0.05;
+
+        std::vector<double> mean(d, 0.0), covariance(d * d, 0.0);
+        const int covarianceStart = settings.burnIn / 2;
+        const double targetAcceptance = 0.234;
+        double logScale = 0.0;
+
+        std::vector<double> proposal(d), z(d);
+        std::string text;
+        int accepted = 0;
+
+        chainSamples[chain].reserve(settings.numSamples);
+
+        for (int iteration = 0; iteration < numIterations && !canceled; iteration++)
+        {
+            double stepScale = std::exp(logScale);
+
+            for (int k = 0; k < d; k++)
+                z[k] = generator.normal();
+
+            for (int i = 0; i < d; i++)
+            {
+                proposal[i] = current[i];
+
+                for (int k = 0; k <= i; k++)
+                    proposal[i] += stepScale * factor[i * d + k] * z[k];
+            }
+
+            double proposalLogPosterior = logPosterior(proposal, buffer);
+            double acceptance = std::min(1.0, std::exp(proposalLogPosterior - currentLogPosterior));
+
+            if (generator.uniform() < acceptance)
+            {
+                current = proposal;
+                currentLogPosterior = proposalLogPosterior;
+
+                if (iteration >= settings.burnIn)
+                    accepted++;
+            }
+
+            if (iteration < settings.burnIn)
+            {
+                logScale += (acceptance - targetAcceptance) / std::sqrt(iteration + 1.0);
+
+                // Running mean and covariance of the second half of burn-in
+
+                if (iteration >= covarianceStart)
+                {
+                    double n = iteration - covarianceStart + 1.0;
+
+                    for (int i = 0; i < d; i++)
+                    {
+                        double delta = current[i] - mean[i];
+                        mean[i] += delta / n;
+
+                        for (int k = 0; k < d; k++)
+                            covariance[i * d + k] += delta * (current[k] - mean[k]);
+                    }
+
+                    if (n >= 10.0 * d && (iteration + 1) % 100 == 0)
+                    {
+                        std::vector<double> candidate(d * d);
+
+                        for (int i = 0; i < d * d; i++)
+                            candidate[i] = 2.38 * 2.38 / d * covariance[i] / n;
+
+                        for (int k = 0; k < d; k++)
+                            candidate[k * d + k] += 1.0e-12 * (1.0 + std::fabs(mean[k]));
+
+                        if (cholesky(candidate, d))
+                            factor = candidate;
+                    }
+                }
+            }
+            else
+            {
+                chainSamples[chain].push_back(current);
+
+                if (file)
+                {
+                    char row[32 * 32];
+                    char *out = row;
+
+                    out = std::to_chars(out, out + 16, chain).ptr;
+                    *out++ = '\t';
+                    out = std::to_chars(out, out + 16, iteration - settings.burnIn).ptr;
+                    *out++ = '\t';
+                    out = std::to_chars(out, out + 32, currentLogPosterior).ptr;
+
+                    for (int k = 0; k < d; k++)
+                    {
+                        *out++ = '\t';
+                        out = std::to_chars(out, out + 32, current[k]).ptr;
+                    }
+
+                    *out++ = '\n';
+
+                    text.append(row, out);
+
+                    if (text.size() > (1 << 16) || iteration + 1 == numIterations)
+                    {
+                        std::lock_guard<std::mutex> lock(fileMutex);
+                        writeFailed = writeFailed || std::fwrite(text.data(), 1, text.size(), file) != text.size();
+                        text.clear();
+                    }
+                }
+            }
+
+            doneIterations++;
+        }
+
+        chainAcceptance[chain] = static_cast<double>(accepted) / settings.numSamples;
+    };
+
+    double totalIterations = static_cast<double>(settings.numChains) * numIterations;
+
+    parallelFor(settings.numChains, canceled, [&](size_t chain, int){
+        chainWorker(static_cast<int>(chain));
+    }, [&](){
+        if (progress)
+            progress(doneIterations / totalIterations);
+    });
+
+    bool success = !canceled && !writeFailed;
+
+    if (file)
+        success = std::fclose(file) == 0 && success;
+
+    if (!success)
+        return false;
+
+    samples.clear();
+
+    for (int chain = 0; chain < settings.numChains; chain++)
+        samples.insert(samples.end(), chainSamples[chain].begin(), chainSamples[chain].end());
+
+    acceptanceRates = chainAcceptance;
+
+    if (progress)
+        progress(1.0);
+
+    return true;
+}
+
+PosteriorBands PosteriorSampler::predictiveBands(const std::vector<double> &times, int maxDraws) const
+{
+    PosteriorBands bands;
+    bands.times = times;
+
+    if (samples.empty() || times.empty())
+        return bands;
+
+    size_t dimension = settings.scenarios.front().x0.size();
+
+    // Evenly spaced draws over all chains
+
+    size_t numDraws = std::min(samples.size(), static_cast<size_t>(std::max(maxDraws, 1)));
+
+    std::vector<std::vector<double>> values(dimension * times.size());
+    std::vector<double> buffer(dimension * times.size());
+
+    Philox generator(settings.seed, static_cast<uint64_t>(2 * maxChains));
+
+    for (size_t draw = 0; draw < numDraws; draw++)
+    {
+        const std::vector<double> &sample = samples[draw * samples.size() / numDraws];
+
+        integrateChainOnGrid(settings.modelIndex, applyValues(sample), times, buffer.data());
+
+        double sigma = std::exp(sample.back());
+
+        for (size_t n = 0; n < times.size(); n++)
+        {
+            for (size_t i = 0; i < dimension; i++)
+            {
+                double value = buffer[n * dimension + i];
+
+                if (i < settings.observedValues.size() && !settings.observedValues[i].empty())
+                    value += sigma * generator.normal();
+
+                if (std::isfinite(value))
+                    values[i * times.size() + n].push_back(value);
+            }
+        }
+    }
+
+    auto quantile = [](std::vector<double> &v, double p){
+        if (v.empty()) return std::numeric_limits<double>::quiet_NaN();
+        size_t k = std::min(v.size() - 1, static_cast<size_t>(p * v.size()));
+        std::nth_element(v.begin(), v.begin() + k, v.end());
+        return v[k];
+    };
+
+    bands.lower.assign(dimension, std::vector<double>(times.size()));
+    bands.median.assign(dimension, std::vector<double>(times.size()));
+    bands.upper.assign(dimension, std::vector<double>(times.size()));
+
+    for (size_t i = 0; i < dimension; i++)
+    {
+        for (size_t n = 0; n < times.size(); n++)
+        {
+            std::vector<double> &v = values[i * times.size() + n];
+
+            bands.lower[i][n] = quantile(v, 0.5 - 0.5 * bandLevel);
+            bands.median[i][n] = quantile(v, 0.5);
+            bands.upper[i][n] = quantile(v, 0.5 + 0.5 * bandLevel);
+        }
+    }
+
+    return bands;
+}
@@ -0,0 +1,119 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#ifndef POSTERIORSAMPLER_H
+#define POSTERIORSAMPLER_H
+
+#include "scenario.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Bayesian calibration of a scenario chain to observed data by adaptive Metropolis
+// Unknowns are the model parameters, shifted by the same amount in every scenario as in
+// the least-squares fit, the logarithm of the initial infected fraction of the first
+// scenario, with the susceptible one taking up its changes, and the logarithm of the
+// standard deviation of the Gaussian observation noise
+// Priors are uniform within the slider bounds and in the logarithms
+// Chains run on their own threads with independent Philox streams, adapt their proposal
+// covariance during burn-in only, and stream their samples to a text file
+
+struct SamplerSettings
+{
+    int modelIndex;
+    std::vector<Scenario> scenarios;
+
+    // Observations of each variable, at the observed times, empty if not fitted, NaN if missing
+
+    std::vector<double> observedTimes;
+    std::vector<std::vector<double>> observedValues;
+
+    int numChains;
+    int burnIn;
+    int numSamples;
+    uint64_t seed;
+
+    // Samples after burn-in, none written if empty
+
+    std::string fileName;
+};
+
+// Quantiles of the posterior predictive distribution of each variable over time
+
+struct PosteriorBands
+{
+    std::vector<double> times;
+    std::vector<std::vector<double>> lower;
+    std::vector<std::vector<double>> median;
+    std::vector<std::vector<double>> upper;
+};
+
+class PosteriorSampler
+{
+public:
+    static const int maxChains = 64;
+    static constexpr double bandLevel = 0.95;
+
+    explicit PosteriorSampler(const SamplerSettings &samplerSettings);
+
+    bool validate(std::string &error) const;
+
+    int getNumUnknowns() const;
+    std::vector<std::string> getUnknownNames() const;
+
+    // Samples of all chains after burn-in, one row of unknowns each, and acceptance rate per chain
+
+    const std::vector<std::vector<double>> &getSamples() const;
+    const std::vector<double> &getAcceptanceRates() const;
+
+    // Progress is reported from the calling thread as a fraction
+
+    bool run(const std::atomic<bool> &canceled, const std::function<void(double)> &progress);
+
+    // Bands from at most maxDraws samples, with noise added to the observed variables
+
+    PosteriorBands predictiveBands(const std::vector<double> &times, int maxDraws) const;
+
+private:
+    struct Observation
+    {
+        size_t row;
+        int variable;
+        double value;
+    };
+
+    SamplerSettings settings;
+
+    int infectedIndex;
+    std::vector<double> lowerBounds;
+    std::vector<double> upperBounds;
+    std::vector<double> fitTimes;
+    std::vector<Observation> observations;
+
+    std::vector<std::vector<double>> samples;
+    std::vector<double> acceptanceRates;
+
+    std::vector<double> startValues(int chain) const;
+    std::vector<Scenario> applyValues(const std::vector<double> &values) const;
+    double sumSquares(const std::vector<double> &values, std::vector<double> &buffer) const;
+    double logPosterior(const std::vector<double> &values, std::vector<double> &buffer) const;
+};
+
+#endif // POSTERIORSAMPLER_H
@@ -0,0 +1,214 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "profilelikelihood.h"
+#include "parallelfor.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <boost/math/distributions/chi_squared.hpp>
+
+ProfileLikelihood::ProfileLikelihood(const ProfileSettings &profileSettings): settings(profileSettings), fit(profileSettings.fit)
+{
+    boost::math::chi_squared distribution(1.0);
+    threshold = boost::math::quantile(distribution, confidenceLevel);
+}
+
+bool ProfileLikelihood::validate(std::string &error) const
+{
+    if (!fit.validate(error))
+        return false;
+
+    if (static_cast<int>(settings.optimum.values.size()) != fit.getNumUnknowns() || !std::isfinite(settings.optimum.sumSquares))
+    {
+        error = "The fit does not match the scenarios";
+        return false;
+    }
+
+    if (settings.numPoints < 1 || settings.numPoints > maxPoints)
+    {
+        error = "Number of points must be between 1 and " + std::to_string(maxPoints);
+        return false;
+    }
+
+    if (!(settings.span > 0.0))
+    {
+        error = "Span must be positive";
+        return false;
+    }
+
+    return true;
+}
+
+double ProfileLikelihood::getThreshold() const
+{
+    return threshold;
+}
+
+const std::vector<ParameterProfile> &ProfileLikelihood::getProfiles() const
+{
+    return profiles;
+}
+
+std::vector<double> ProfileLikelihood::grid(int unknown) const
+{
+    double value = settings.optimum.values[unknown];
+    double lowerBound = fit.getLowerBounds()[unknown];
+    double upperBound = fit.getUpperBounds()[unknown];
+
+    // Span of standard errors around the fit, or the whole slider range if there is no standard error
+
+    double standardError = settings.optimum.standardErrors[unknown];
+    double lowerEnd = lowerBound, upperEnd = upperBound;
+
+    if (std::isfinite(standardError) && standardError > 0.0)
+    {
+        lowerEnd = std::max(lowerBound, value - settings.span * standardError);
+        upperEnd = std::min(upperBound, value + settings.span * standardError);
+    }
+
+    std::vector<double> values(2 * settings.numPoints + 1);
+
+    for (int p = 0; p < settings.numPoints; p++)
+        values[p] = lowerEnd + (value - lowerEnd) * p / settings.numPoints;
+
+    values[settings.numPoints] = value;
+
+    for (int p = 1; p <= settings.numPoints; p++)
+        values[settings.numPoints + p] = value + (upperEnd - value) * p / settings.numPoints;
+
+    return values;
+}
+
+bool ProfileLikelihood::run(const std::atomic<bool> &canceled, const std::function<void(double)> &progress)
+{
+    int numUnknowns = fit.getNumUnknowns();
+    int numPoints = settings.numPoints;
+
+    profiles.assign(numUnknowns, ParameterProfile());
+
+    for (int k = 0; k < numUnknowns; k++)
+    {
+        profiles[k].values = grid(k);
+        profiles[k].sumSquares.assign(2 * numPoints + 1, std::numeric_limits<double>::quiet_NaN());
+        profiles[k].sumSquares[numPoints] = settings.optimum.sumSquares;
+    }
+
+    // A walk is one side of the grid of an unknown, walks are spread over threads
+
+    int numWalks = 2 * numUnknowns;
+    int numFits = numWalks * numPoints;
+
+    std::atomic<int> doneFits(0);
+
+    parallelFor(numWalks, canceled, [&](size_t walk, int){
+        int unknown = static_cast<int>(walk / 2);
+        int direction = (walk % 2 == 0) ? -1 : 1;
+
+        ParameterProfile &profile = profiles[unknown];
+        std::vector<double> start = settings.optimum.values;
+
+        for (int p = 1; p <= numPoints && !canceled; p++)
+        {
+            int point = numPoints + direction * p;
+
+            // Warm start from the optimum of the previous point
+
+            start[unknown] = profile.values[point];
+
+            FitResult pointFit = fit.refit(start, unknown, canceled);
+
+            if (std::isfinite(pointFit.sumSquares))
+            {
+                profile.sumSquares[point] = pointFit.sumSquares;
+                start = pointFit.values;
+            }
+
+            doneFits++;
+        }
+    }, [&](){
+        if (progress)
+            progress(static_cast<double>(doneFits) / numFits);
+    });
+
+    if (canceled)
+        return false;
+
+    // Deviances relative to the lowest sum of squares, which may be below that of the fit
+
+    double minSumSquares = settings.optimum.sumSquares;
+
+    for (const ParameterProfile &profile : profiles)
+    {
+        for (double sumSquares : profile.sumSquares)
+        {
+            if (std::isfinite(sumSquares))
+                minSumSquares = std::min(minSumSquares, sumSquares);
+        }
+    }
+
+    int numResiduals = settings.optimum.numResiduals;
+
+    for (ParameterProfile &profile : profiles)
+    {
+        profile.deviance.resize(profile.sumSquares.size());
+
+        for (size_t p = 0; p < profile.sumSquares.size(); p++)
+            profile.deviance[p] = numResiduals * std::log(profile.sumSquares[p] / minSumSquares);
+
+        // Threshold crossings on each side, interpolated linearly
+
+        auto crossing = [&](int direction, bool &crossed)
+        {
+            crossed = false;
+            int previous = numPoints;
+
+            for (int p = 1; p <= numPoints; p++)
+            {
+                int point = numPoints + direction * p;
+
+                if (!std::isfinite(profile.deviance[point]))
+                    break;
+
+                if (profile.deviance[point] >= threshold)
+                {
+                    double d0 = profile.deviance[previous], d1 = profile.deviance[point];
+                    double t = (d1 > d0) ? std::clamp((threshold - d0) / (d1 - d0), 0.0, 1.0) : 1.0;
+
+                    crossed = true;
+                    return profile.values[previous] + t * (profile.values[point] - profile.values[previous]);
+                }
+
+                previous = point;
+            }
+
+            return profile.values[previous];
+        };
+
+        bool crossedLower, crossedUpper;
+
+        profile.lower = crossing(-1, crossedLower);
+        profile.upper = crossing(1, crossedUpper);
+        profile.identifiable = crossedLower && crossedUpper;
+    }
+
+    if (progress)
+        progress(1.0);
+
+    return true;
+}
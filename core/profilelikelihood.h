@@ -0,0 +1,89 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#ifndef PROFILELIKELIHOOD_H
+#define PROFILELIKELIHOOD_H
+
+#include "parameterfit.h"
+#include <atomic>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Profile likelihoods of the unknowns of a parameter fit
+// Each unknown is fixed at the points of a grid around its fitted value while the others
+// are fitted again, starting from the optimum of the neighbouring point towards the fit
+// The grid is walked outwards from the fit on both sides, and the walks of all unknowns
+// run concurrently
+// With Gaussian errors of unknown variance the profile deviance is m log(S / S_min),
+// where m is the number of residuals and S the sum of squares, and the unknown is
+// identifiable if it exceeds the chi-squared threshold on both sides of the fit
+
+struct ProfileSettings
+{
+    FitSettings fit;
+    FitResult optimum;
+
+    // Points per side, and half width of the grid in standard errors
+
+    int numPoints;
+    double span;
+};
+
+struct ParameterProfile
+{
+    std::vector<double> values;
+    std::vector<double> sumSquares;
+    std::vector<double> deviance;
+
+    // Likelihood-based confidence interval, the end of the grid if the threshold is not crossed
+
+    double lower;
+    double upper;
+    bool identifiable;
+};
+
+class ProfileLikelihood
+{
+public:
+    static const int maxPoints = 100;
+    static constexpr double confidenceLevel = 0.95;
+
+    explicit ProfileLikelihood(const ProfileSettings &profileSettings);
+
+    bool validate(std::string &error) const;
+
+    double getThreshold() const;
+    const std::vector<ParameterProfile> &getProfiles() const;
+
+    // Progress is reported from the calling thread as a fraction
+
+    bool run(const std::atomic<bool> &canceled, const std::function<void(double)> &progress);
+
+private:
+    ProfileSettings settings;
+    ParameterFit fit;
+
+    double threshold;
+
+    std::vector<ParameterProfile> profiles;
+
+    std::vector<double> grid(int unknown) const;
+};
+
+#endif // PROFILELIKELIHOOD_H
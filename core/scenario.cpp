@@ -16,6 +16,8 @@
 // along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
 
 #include "scenario.h"
+#include "models.h"
+#include <algorithm>
 
 void Scenario::setTimeStart(int i, int indexMax)
 {
@@ -47,22 +49,25 @@ int Scenario::getIndexParameter(int k, int indexMax)
     return static_cast<int>(indexMax * (parameters[k] - parametersMin[k]) / (parametersMax[k] - parametersMin[k]));
 }
 
-void Scenario::interpolateX0(Scenario scenario)
+void Scenario::interpolateX0(const Scenario &scenario)
 {
-    if (scenario.times.size() > 1) // Times array with at least 2 elements
+    const std::vector<state_type> &steps = scenario.trajectory->steps;
+    const std::vector<double> &times = scenario.trajectory->times;
+
+    if (times.size() > 1) // Times array with at least 2 elements
     {
         double time0, time1;
         state_type step0, step1;
 
-        for (size_t i = 1; i < scenario.times.size(); i++)
+        for (size_t i = 1; i < times.size(); i++)
         {
-            if (scenario.times[i - 1] <= timeStart && timeStart <= scenario.times[i])
+            if (times[i - 1] <= timeStart && timeStart <= times[i])
             {
-                time0 = scenario.times[i - 1];
-                time1 = scenario.times[i];
+                time0 = times[i - 1];
+                time1 = times[i];
 
-                step0 = scenario.steps[i - 1];
-                step1 = scenario.steps[i];
+                step0 = steps[i - 1];
+                step1 = steps[i];
 
                 break;
             }
@@ -75,12 +80,57 @@ void Scenario::interpolateX0(Scenario scenario)
     }
     else // Times array with only 1 element
     {
-        x0 = scenario.steps.back();
+        x0 = steps.back();
     }
 }
 
+state_type Scenario::denseState(double time, int modelIndex) const
+{
+    // Cubic Hermite interpolation between the two solved steps around time,
+    // using the model derivatives at those steps
+
+    const std::vector<state_type> &steps = trajectory->steps;
+    const std::vector<double> &times = trajectory->times;
+
+    if (times.size() < 2 || time <= times.front())
+    {
+        return steps.front();
+    }
+
+    if (time >= times.back())
+    {
+        return steps.back();
+    }
+
+    size_t i = std::upper_bound(times.begin(), times.end(), time) - times.begin();
+
+    double h = times[i] - times[i - 1];
+    double s = (time - times[i - 1]) / h;
+
+    state_type dxdt0, dxdt1;
+    evaluateModel(modelIndex, parameters, steps[i - 1], dxdt0);
+    evaluateModel(modelIndex, parameters, steps[i], dxdt1);
+
+    double h00 = (1.0 + 2.0 * s) * (1.0 - s) * (1.0 - s);
+    double h10 = s * (1.0 - s) * (1.0 - s);
+    double h01 = s * s * (3.0 - 2.0 * s);
+    double h11 = s * s * (s - 1.0);
+
+    state_type x(steps[i].size());
+
+    for (size_t k = 0; k < x.size(); k++)
+    {
+        x[k] = h00 * steps[i - 1][k] + h10 * h * dxdt0[k] + h01 * steps[i][k] + h11 * h * dxdt1[k];
+    }
+
+    return x;
+}
+
 void Scenario::setAbscissaOrdinate()
 {
+    const std::vector<state_type> &steps = trajectory->steps;
+    const std::vector<double> &times = trajectory->times;
+
     abscissa = QVector<double>(times.begin(), times.end());
 
     ordinate.clear();
@@ -100,6 +150,9 @@ void Scenario::setAbscissaOrdinate()
 
 void Scenario::setAbscissaOrdinate(double time)
 {
+    const std::vector<state_type> &steps = trajectory->steps;
+    const std::vector<double> &times = trajectory->times;
+
     unsigned long index = 0;
 
     for (unsigned long i = 1; i < times.size(); i++)
@@ -159,3 +212,25 @@ void Scenario::setAbscissaOrdinate(double time)
         ordinateRight.push_back(w);
     }
 }
+
+void Scenario::clearAbscissaOrdinate()
+{
+    abscissa.clear();
+    abscissaLeft.clear();
+    abscissaRight.clear();
+
+    ordinate.clear();
+    ordinateLeft.clear();
+    ordinateRight.clear();
+}
+
+size_t switchStepIndex(const std::vector<Scenario> &scenarios, size_t scenarioIndex)
+{
+    if (scenarioIndex + 1 >= scenarios.size()) return 0;
+
+    const std::vector<double> &times = scenarios[scenarioIndex].trajectory->times;
+
+    size_t count = std::lower_bound(times.begin(), times.end(), scenarios[scenarioIndex + 1].timeStart) - times.begin();
+
+    return count > 0 ? count - 1 : 0;
+}
@@ -19,17 +19,27 @@
 #define SCENARIO_H
 
 #include <vector>
+#include <memory>
 #include <QVector>
 
 typedef std::vector<double> state_type;
 
+// Solved trajectory of a scenario
+// Never modified once solved: integration creates a new one, so copies of a
+// scenario (e.g. snapshots) can keep referencing the old one
+
+struct Trajectory
+{
+    std::vector<state_type> steps;
+    std::vector<double> times;
+};
+
 class Scenario
 {
 public:
     state_type x;
     std::vector<double> x0;
-    std::vector<state_type> steps;
-    std::vector<double> times;
+    std::shared_ptr<const Trajectory> trajectory;
 
     QVector<double> abscissa, abscissaLeft, abscissaRight;
     std::vector<QVector<double>> ordinate, ordinateLeft, ordinateRight;
@@ -40,6 +50,7 @@ public:
 
     Scenario(std::vector<double> xStart, std::vector<double> p, std::vector<double> pMin, std::vector<double> pMax, double t0, double t0Min, double t0Max, double t1, double t1Min, double t1Max):
         x0(xStart),
+        trajectory(std::make_shared<Trajectory>()),
         timeStart(t0),
         timeStartMin(t0Min),
         timeStartMax(t0Max),
@@ -58,10 +69,16 @@ public:
     int getIndexTimeEnd(int indexMax);
     int getIndexParameter(int k, int indexMax);
 
-    void interpolateX0(Scenario scenario);
+    void interpolateX0(const Scenario &scenario);
+    state_type denseState(double time, int modelIndex) const;
 
     void setAbscissaOrdinate();
     void setAbscissaOrdinate(double time);
+    void clearAbscissaOrdinate();
 };
 
+// Last time index of a scenario before the next one in the chain starts, 0 for the last one
+
+size_t switchStepIndex(const std::vector<Scenario> &scenarios, size_t scenarioIndex);
+
 #endif // SCENARIO_H
@@ -0,0 +1,153 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "scenariointegrator.h"
+#include "models.h"
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <boost/numeric/odeint.hpp>
+
+void integrateScenario(int modelIndex, Scenario &scenario)
+{
+    using namespace boost::numeric::odeint;
+
+    typedef runge_kutta_dopri5<state_type> error_stepper_type;
+
+    scenario.x = scenario.x0;
+
+    // New trajectory, snapshots may still reference the previous one
+
+    std::shared_ptr<Trajectory> trajectory = std::make_shared<Trajectory>();
+
+    withModel(modelIndex, [&](auto type){
+        typename decltype(type)::template type<double> model(scenario.parameters);
+        integrate_adaptive(make_controlled<error_stepper_type>(1.0e-10, 1.0e-6), model, scenario.x, scenario.timeStart, scenario.timeEnd, 0.01, push_back_state_and_time(trajectory->steps, trajectory->times));
+    });
+
+    scenario.trajectory = trajectory;
+}
+
+void integrateScenarios(int modelIndex, std::vector<Scenario> &scenarios, size_t firstIndex, bool interpolation)
+{
+    for (size_t i = firstIndex; i < scenarios.size(); i++)
+    {
+        if (interpolation && i > 0)
+        {
+            scenarios[i].interpolateX0(scenarios[i - 1]);
+        }
+
+        interpolation = true;
+
+        integrateScenario(modelIndex, scenarios[i]);
+    }
+}
+
+void integrateOnGrid(int modelIndex, const std::vector<double> &parameters, state_type x, const std::vector<double> &times, double *output)
+{
+    using namespace boost::numeric::odeint;
+
+    typedef runge_kutta_dopri5<state_type> error_stepper_type;
+
+    auto observer = [&output](const state_type &state, double)
+    {
+        output = std::copy(state.begin(), state.end(), output);
+    };
+
+    withModel(modelIndex, [&](auto type){
+        typename decltype(type)::template type<double> model(parameters);
+        integrate_times(make_dense_output<error_stepper_type>(1.0e-10, 1.0e-6), model, x, times.begin(), times.end(), 0.01, observer);
+    });
+}
+
+// Fixed-size states of the dimension of the model
+
+template <typename Type>
+static void integrateChain(const std::vector<Scenario> &scenarios, const std::vector<double> &times, double *output)
+{
+    using namespace boost::numeric::odeint;
+
+    typedef std::array<double, Type::dimension> State;
+    typedef runge_kutta_dopri5<State> error_stepper_type;
+
+    const size_t dimension = Type::dimension;
+
+    std::fill(output, output + times.size() * dimension, std::numeric_limits<double>::quiet_NaN());
+
+    State x;
+    std::copy(scenarios.front().x0.begin(), scenarios.front().x0.end(), x.begin());
+
+    size_t next = std::lower_bound(times.begin(), times.end(), scenarios.front().timeStart) - times.begin();
+
+    std::vector<double> segmentTimes;
+    std::vector<size_t> segmentRows;
+
+    for (size_t s = 0; s < scenarios.size(); s++)
+    {
+        const Scenario &scenario = scenarios[s];
+
+        bool last = s + 1 == scenarios.size();
+        double timeSwitch = last ? scenario.timeEnd : std::min(scenario.timeEnd, std::max(scenario.timeStart, scenarios[s + 1].timeStart));
+
+        // Grid times of this scenario, between its start and the switch to the next one
+
+        segmentTimes.assign(1, scenario.timeStart);
+        segmentRows.assign(1, times.size());
+
+        for (; next < times.size() && (times[next] < timeSwitch || (last && times[next] == timeSwitch)); next++)
+        {
+            if (times[next] == scenario.timeStart)
+            {
+                segmentRows[0] = next;
+            }
+            else
+            {
+                segmentTimes.push_back(times[next]);
+                segmentRows.push_back(next);
+            }
+        }
+
+        if (segmentTimes.back() < timeSwitch)
+        {
+            segmentTimes.push_back(timeSwitch);
+            segmentRows.push_back(times.size());
+        }
+
+        size_t step = 0;
+
+        auto observer = [&](const State &state, double)
+        {
+            if (segmentRows[step] < times.size())
+                std::copy(state.begin(), state.end(), output + segmentRows[step] * dimension);
+
+            step++;
+        };
+
+        typename Type::template type<double> model(scenario.parameters);
+
+        if (segmentTimes.size() > 1)
+            integrate_times(make_dense_output<error_stepper_type>(1.0e-10, 1.0e-6), model, x, segmentTimes.begin(), segmentTimes.end(), 0.01, observer);
+        else
+            observer(x, scenario.timeStart);
+    }
+}
+
+void integrateChainOnGrid(int modelIndex, const std::vector<Scenario> &scenarios, const std::vector<double> &times, double *output)
+{
+    withModel(modelIndex, [&](auto type){ integrateChain<decltype(type)>(scenarios, times, output); });
+}
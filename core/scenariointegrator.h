@@ -0,0 +1,47 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#ifndef SCENARIOINTEGRATOR_H
+#define SCENARIOINTEGRATOR_H
+
+#include "scenario.h"
+#include <vector>
+
+// Integration of scenarios with the model selected by index, shared by the
+// scenario widget and the headless solver so both produce identical trajectories
+
+void integrateScenario(int modelIndex, Scenario &scenario);
+
+// Integrates scenarios from firstIndex on, each one starting where the previous one
+// ends, except for the first integrated one if interpolation is false
+
+void integrateScenarios(int modelIndex, std::vector<Scenario> &scenarios, size_t firstIndex, bool interpolation);
+
+// Integrates from the first time of the grid with dense output, storing the state
+// at every grid time in output (times.size() * dimension values, row-major)
+// Grid times must be increasing
+
+void integrateOnGrid(int modelIndex, const std::vector<double> &parameters, state_type x, const std::vector<double> &times, double *output);
+
+// Same for a whole scenario chain, with fixed-size states for repeated solves
+// Each scenario covers times until the start of the next one, which starts from its
+// state there, and grid times outside the chain are NaN
+
+void integrateChainOnGrid(int modelIndex, const std::vector<Scenario> &scenarios, const std::vector<double> &times, double *output);
+
+#endif // SCENARIOINTEGRATOR_H
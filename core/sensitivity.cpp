@@ -0,0 +1,190 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "sensitivity.h"
+#include "models.h"
+#include "dual.h"
+#include <algorithm>
+#include <boost/numeric/odeint.hpp>
+
+// State and sensitivities system of a model, see sensitivity.h
+// The tangent of the right-hand side along (dx/dPk, ek) gives the variational equation
+// d(dx/dPk)/dt = J dx/dPk + df/dPk, and along (dx/dx0, 0) that of the initial conditions
+// Directions are evaluated in groups of as many as a dual number carries
+
+template <template <typename> class Model>
+class SensitivitySystem
+{
+public:
+    std::vector<double> P;
+    int dimension;
+    int numDirections;
+
+    SensitivitySystem(const std::vector<double> &p, int dim, int directions): P(p), dimension(dim), numDirections(directions){}
+
+    void operator()(const state_type &z, state_type &dzdt, const double t)
+    {
+        int numParameters = static_cast<int>(P.size());
+
+        std::vector<Dual> x(dimension), dxdt(dimension), p(numParameters);
+
+        for (int first = 0; first == 0 || first < numDirections; first += maxDualTangents)
+        {
+            int count = std::min(maxDualTangents, numDirections - first);
+
+            for (int i = 0; i < dimension; i++)
+            {
+                x[i] = Dual(z[i]);
+
+                for (int k = 0; k < count; k++)
+                    x[i].d[k] = z[dimension * (first + k + 1) + i];
+            }
+
+            for (int j = 0; j < numParameters; j++)
+            {
+                p[j] = Dual(P[j]);
+
+                if (j >= first && j < first + count)
+                    p[j].d[j - first] = 1.0;
+            }
+
+            Model<Dual> model(p);
+            model(x, dxdt, t);
+
+            for (int i = 0; i < dimension; i++)
+            {
+                dzdt[i] = dxdt[i].value;
+
+                for (int k = 0; k < count; k++)
+                    dzdt[dimension * (first + k + 1) + i] = dxdt[i].d[k];
+            }
+        }
+    }
+};
+
+template <class System>
+static void integrateSystem(System system, state_type &z, double timeStart, double timeEnd, const std::vector<double> &outputTimes, std::vector<state_type> &steps, std::vector<double> &times)
+{
+    using namespace boost::numeric::odeint;
+
+    typedef runge_kutta_dopri5<state_type> error_stepper_type;
+
+    if (outputTimes.empty())
+    {
+        integrate_adaptive(make_controlled<error_stepper_type>(1.0e-10, 1.0e-6), system, z, timeStart, timeEnd, 0.01, push_back_state_and_time(steps, times));
+        return;
+    }
+
+    // Dense output at the requested times only, bounded by the scenario time range
+
+    std::vector<double> scenarioTimes = {timeStart};
+
+    for (double time : outputTimes)
+    {
+        if (time > timeStart && time < timeEnd)
+            scenarioTimes.push_back(time);
+    }
+
+    if (timeEnd > timeStart)
+        scenarioTimes.push_back(timeEnd);
+
+    if (scenarioTimes.size() < 2)
+    {
+        steps.push_back(z);
+        times.push_back(timeStart);
+        return;
+    }
+
+    integrate_times(make_dense_output<error_stepper_type>(1.0e-10, 1.0e-6), system, z, scenarioTimes.begin(), scenarioTimes.end(), 0.01, push_back_state_and_time(steps, times));
+}
+
+std::shared_ptr<SensitivityTrajectory> integrateSensitivities(int modelIndex, const std::vector<Scenario> &scenarios, const std::vector<state_type> &initialTangents, const std::vector<double> &outputTimes)
+{
+    std::shared_ptr<SensitivityTrajectory> trajectory = std::make_shared<SensitivityTrajectory>();
+
+    int dimension = static_cast<int>(scenarios.front().x0.size());
+    int numParameters = static_cast<int>(scenarios.front().parameters.size());
+    int numDirections = numParameters + static_cast<int>(initialTangents.size());
+
+    trajectory->dimension = dimension;
+    trajectory->numParameters = numParameters;
+    trajectory->numDirections = numDirections;
+
+    state_type z(dimension * (numDirections + 1), 0.0);
+
+    for (size_t s = 0; s < scenarios.size(); s++)
+    {
+        const Scenario &scenario = scenarios[s];
+
+        // Later scenarios start from the state and sensitivities of the previous one at their time start
+
+        if (s == 0)
+        {
+            std::copy(scenario.x0.begin(), scenario.x0.end(), z.begin());
+
+            for (size_t k = 0; k < initialTangents.size(); k++)
+                std::copy(initialTangents[k].begin(), initialTangents[k].end(), z.begin() + dimension * (numParameters + k + 1));
+        }
+        else
+        {
+            std::vector<double> &times = trajectory->times;
+
+            size_t i = std::lower_bound(times.begin(), times.end(), scenario.timeStart) - times.begin();
+            i = std::min(i, times.size() - 1);
+
+            if (i > 0 && times[i] > times[i - 1])
+            {
+                double w = (scenario.timeStart - times[i - 1]) / (times[i] - times[i - 1]);
+
+                for (size_t j = 0; j < z.size(); j++)
+                    z[j] = trajectory->steps[i - 1][j] + w * (trajectory->steps[i][j] - trajectory->steps[i - 1][j]);
+            }
+            else
+            {
+                z = trajectory->steps[i];
+            }
+
+            // Steps past the time start of this scenario belong to the previous one only
+
+            times.resize(i);
+            trajectory->steps.resize(i);
+        }
+
+        // With output times, each scenario also stops at the start of the next one, so the above is exact
+
+        double timeEnd = scenario.timeEnd;
+
+        if (!outputTimes.empty() && s + 1 < scenarios.size())
+            timeEnd = std::min(timeEnd, std::max(scenario.timeStart, scenarios[s + 1].timeStart));
+
+        std::vector<state_type> steps;
+        std::vector<double> times;
+
+        const std::vector<double> &p = scenario.parameters;
+
+        withModel(modelIndex, [&](auto type){
+            typedef decltype(type) Type;
+            integrateSystem(SensitivitySystem<Type::template type>(p, dimension, numDirections), z, scenario.timeStart, timeEnd, outputTimes, steps, times);
+        });
+
+        trajectory->times.insert(trajectory->times.end(), times.begin(), times.end());
+        trajectory->steps.insert(trajectory->steps.end(), steps.begin(), steps.end());
+    }
+
+    return trajectory;
+}
@@ -0,0 +1,50 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#ifndef SENSITIVITY_H
+#define SENSITIVITY_H
+
+#include "scenario.h"
+#include <memory>
+#include <vector>
+
+// Forward sensitivities of a scenario chain
+// The state is integrated together with its derivatives dx/dP with respect to every
+// parameter, obtained by evaluating the model with dual numbers, so that all
+// gradients come from a single solve. Each step holds the state followed by one
+// block of dimension values per direction: x, dx/dP0, dx/dP1, ..., then the derivatives
+// along the requested directions of the initial conditions of the first scenario
+// Sensitivities refer to changing a parameter by the same amount in every scenario,
+// and are carried over from one scenario to the next
+
+struct SensitivityTrajectory
+{
+    int dimension;
+    int numParameters;
+    int numDirections;
+    std::vector<double> times;
+    std::vector<state_type> steps;
+};
+
+// Parameter sensitivities start at zero, those of the initial conditions at their tangents
+// Steps are those of the adaptive solver, or exactly the given sorted output times within
+// the chain, plus the time start of each scenario
+
+std::shared_ptr<SensitivityTrajectory> integrateSensitivities(int modelIndex, const std::vector<Scenario> &scenarios, const std::vector<state_type> &initialTangents = {}, const std::vector<double> &outputTimes = {});
+
+#endif // SENSITIVITY_H
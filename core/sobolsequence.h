@@ -0,0 +1,112 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#ifndef SOBOLSEQUENCE_H
+#define SOBOLSEQUENCE_H
+
+#include <cstdint>
+#include <vector>
+
+// Sobol low-discrepancy sequence in up to maxDimension dimensions, generated in Gray code
+// order with the direction numbers of Joe and Kuo (new-joe-kuo-6.21201)
+// The first point, all zeros, is skipped
+
+class SobolSequence
+{
+public:
+    static const int maxDimension = 10;
+
+    explicit SobolSequence(int dimension): numDimensions(dimension), index(0), x(dimension, 0), v(dimension, std::vector<uint32_t>(32, 0))
+    {
+        // Degree, polynomial coefficients and initial direction numbers of dimensions 2 on
+
+        struct Polynomial { int s; uint32_t a; uint32_t m[5]; };
+
+        static const Polynomial polynomials[maxDimension - 1] = {
+            {1, 0, {1}},
+            {2, 1, {1, 3}},
+            {3, 1, {1, 3, 1}},
+            {3, 2, {1, 1, 1}},
+            {4, 1, {1, 1, 3, 3}},
+            {4, 4, {1, 3, 5, 13}},
+            {5, 2, {1, 1, 5, 5, 17}},
+            {5, 4, {1, 1, 5, 5, 5}},
+            {5, 7, {1, 1, 7, 11, 19}}
+        };
+
+        for (int j = 0; j < numDimensions; j++)
+        {
+            if (j == 0)
+            {
+                for (int k = 0; k < 32; k++)
+                    v[j][k] = uint32_t(1) << (31 - k);
+
+                continue;
+            }
+
+            const Polynomial &polynomial = polynomials[j - 1];
+
+            for (int k = 0; k < polynomial.s; k++)
+                v[j][k] = polynomial.m[k] << (31 - k);
+
+            for (int k = polynomial.s; k < 32; k++)
+            {
+                v[j][k] = v[j][k - polynomial.s] ^ (v[j][k - polynomial.s] >> polynomial.s);
+
+                for (int l = 1; l < polynomial.s; l++)
+                {
+                    if ((polynomial.a >> (polynomial.s - 1 - l)) & 1)
+                        v[j][k] ^= v[j][k - l];
+                }
+            }
+        }
+    }
+
+    // Next point, each coordinate in [0, 1)
+
+    void next(double *point)
+    {
+        // Rightmost zero bit of the index selects the direction number to flip
+
+        int c = 0;
+        uint64_t value = index;
+
+        while (value & 1)
+        {
+            value >>= 1;
+            c++;
+        }
+
+        index++;
+
+        for (int j = 0; j < numDimensions; j++)
+        {
+            x[j] ^= v[j][c];
+            point[j] = x[j] / 4294967296.0;
+        }
+    }
+
+private:
+    int numDimensions;
+    uint64_t index;
+
+    std::vector<uint32_t> x;
+    std::vector<std::vector<uint32_t>> v;
+};
+
+#endif // SOBOLSEQUENCE_H
@@ -0,0 +1,81 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#ifndef SOLVEPROTOCOL_H
+#define SOLVEPROTOCOL_H
+
+#include <cstdint>
+
+// Framing of the local solve service
+// Fields are stored in little-endian byte order and every block is 8-byte aligned
+//
+// Each message is a uint32 payload byte count followed by the payload
+//
+// Request payload: SolveRequestHeader
+//                  Time grid (numTimes doubles, increasing), shared by all problems
+//                  For each problem: parameters and initial conditions (doubles)
+//
+// Response payload: SolveResponseHeader
+//                   Error message (UTF-8, messageSize bytes), padded to 8 bytes
+//                   For each problem: state at every grid time (numTimes * dimension doubles)
+
+const uint32_t solveRequestMagic = 0x51524953;  // "SIRQ"
+const uint32_t solveResponseMagic = 0x50524953; // "SIRP"
+const uint32_t solveProtocolVersion = 1;
+
+// Largest payload accepted, to reject corrupt frames early, and largest response sent
+
+const uint32_t solveMaxPayloadSize = 256u << 20;
+
+enum SolveStatus: uint32_t
+{
+    SolveOk = 0,
+    SolveInvalidRequest = 1
+};
+
+struct SolveRequestHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t requestId;
+    uint32_t modelIndex;
+    uint32_t numProblems;
+    uint32_t numTimes;
+};
+
+struct SolveResponseHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t requestId;
+    uint32_t status;
+    uint32_t numProblems;
+    uint32_t numTimes;
+    uint32_t dimension;
+    uint32_t messageSize;
+};
+
+static_assert(sizeof(SolveRequestHeader) == 24, "Unexpected solve request header size");
+static_assert(sizeof(SolveResponseHeader) == 32, "Unexpected solve response header size");
+
+inline uint32_t solvePadding(uint32_t size)
+{
+    return (8 - size % 8) % 8;
+}
+
+#endif // SOLVEPROTOCOL_H
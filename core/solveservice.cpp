@@ -0,0 +1,257 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "solveservice.h"
+#include "scenariointegrator.h"
+#include "modelcatalog.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <future>
+#include <thread>
+
+SolveService::SolveService(size_t cacheCapacity)
+{
+    capacity = cacheCapacity;
+
+    caches.resize(scenarioModelDefinitions().size());
+
+    numSolved = 0;
+    numCacheHits = 0;
+}
+
+uint64_t SolveService::getNumSolved() const
+{
+    return numSolved;
+}
+
+uint64_t SolveService::getNumCacheHits() const
+{
+    return numCacheHits;
+}
+
+std::vector<char> SolveService::errorResponse(uint32_t requestId, const std::string &message)
+{
+    SolveResponseHeader header;
+    header.magic = solveResponseMagic;
+    header.version = solveProtocolVersion;
+    header.requestId = requestId;
+    header.status = SolveInvalidRequest;
+    header.numProblems = 0;
+    header.numTimes = 0;
+    header.dimension = 0;
+    header.messageSize = static_cast<uint32_t>(message.size());
+
+    std::vector<char> response(sizeof(header) + message.size() + solvePadding(header.messageSize), '\0');
+
+    std::memcpy(response.data(), &header, sizeof(header));
+    std::memcpy(response.data() + sizeof(header), message.data(), message.size());
+
+    return response;
+}
+
+std::vector<char> SolveService::handle(const char *payload, size_t size)
+{
+    // Header
+
+    SolveRequestHeader request;
+
+    if (size < sizeof(request))
+        return errorResponse(0, "Truncated request header");
+
+    std::memcpy(&request, payload, sizeof(request));
+
+    if (request.magic != solveRequestMagic || request.version != solveProtocolVersion)
+        return errorResponse(request.requestId, "Unsupported request format");
+
+    const std::vector<ModelDefinition> &definitions = scenarioModelDefinitions();
+
+    if (request.modelIndex >= definitions.size())
+        return errorResponse(request.requestId, "Unknown model");
+
+    const ModelDefinition &definition = definitions[request.modelIndex];
+
+    size_t dimension = definition.variableShortNames.size();
+    size_t numParameters = definition.parameterNames.size();
+    size_t problemSize = numParameters + dimension;
+
+    if (request.numTimes == 0 || request.numProblems == 0)
+        return errorResponse(request.requestId, "Empty request");
+
+    uint64_t expectedSize = sizeof(request) + sizeof(double) * (static_cast<uint64_t>(request.numTimes) + static_cast<uint64_t>(request.numProblems) * problemSize);
+
+    if (expectedSize != size)
+        return errorResponse(request.requestId, "Request size does not match its header");
+
+    // Time grid and problems, copied since the payload need not be aligned
+
+    std::vector<double> times(request.numTimes);
+    std::memcpy(times.data(), payload + sizeof(request), times.size() * sizeof(double));
+
+    for (size_t i = 0; i < times.size(); i++)
+    {
+        if (!std::isfinite(times[i]) || (i > 0 && times[i] <= times[i - 1]))
+            return errorResponse(request.requestId, "Time grid must be finite and increasing");
+    }
+
+    const char *problemsData = payload + sizeof(request) + times.size() * sizeof(double);
+
+    std::vector<double> problems(static_cast<size_t>(request.numProblems) * problemSize);
+    std::memcpy(problems.data(), problemsData, problems.size() * sizeof(double));
+
+    for (double value : problems)
+    {
+        if (!std::isfinite(value))
+            return errorResponse(request.requestId, "Parameters and initial conditions must be finite");
+    }
+
+    // Response, solutions are written in place
+    // Its size is bounded like requests, checking before multiplying so that it cannot overflow
+
+    size_t solutionSize = times.size() * dimension;
+
+    if (solutionSize * sizeof(double) > (solveMaxPayloadSize - sizeof(SolveResponseHeader)) / request.numProblems)
+        return errorResponse(request.requestId, "Response too large, split the request");
+
+    SolveResponseHeader header;
+    header.magic = solveResponseMagic;
+    header.version = solveProtocolVersion;
+    header.requestId = request.requestId;
+    header.status = SolveOk;
+    header.numProblems = request.numProblems;
+    header.numTimes = request.numTimes;
+    header.dimension = static_cast<uint32_t>(dimension);
+    header.messageSize = 0;
+
+    std::vector<char> response(sizeof(header) + static_cast<size_t>(request.numProblems) * solutionSize * sizeof(double));
+    std::memcpy(response.data(), &header, sizeof(header));
+
+    double *solutions = reinterpret_cast<double*>(response.data() + sizeof(header));
+
+    auto problemKey = [&](size_t p)
+    {
+        return std::string(problemsData + p * problemSize * sizeof(double), problemSize * sizeof(double));
+    };
+
+    // Cached solutions, the cache is reset when the time grid of the model changes
+
+    std::vector<size_t> misses;
+
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+
+        ModelCache &cache = caches[request.modelIndex];
+
+        if (cache.times != times)
+        {
+            cache.times = times;
+            cache.solutions.clear();
+            cache.index.clear();
+        }
+
+        for (size_t p = 0; p < request.numProblems; p++)
+        {
+            auto found = cache.index.find(problemKey(p));
+
+            if (found == cache.index.end())
+            {
+                misses.push_back(p);
+                continue;
+            }
+
+            cache.solutions.splice(cache.solutions.begin(), cache.solutions, found->second);
+            std::copy(found->second->values.begin(), found->second->values.end(), solutions + p * solutionSize);
+        }
+    }
+
+    numCacheHits += request.numProblems - misses.size();
+
+    // Integrate the remaining problems, split among threads for large batches
+
+    auto solveRange = [&](size_t begin, size_t end)
+    {
+        std::vector<double> parameters(numParameters);
+        state_type x0(dimension);
+
+        for (size_t m = begin; m < end; m++)
+        {
+            const double *problem = problems.data() + misses[m] * problemSize;
+
+            std::copy(problem, problem + numParameters, parameters.begin());
+            std::copy(problem + numParameters, problem + problemSize, x0.begin());
+
+            integrateOnGrid(request.modelIndex, parameters, x0, times, solutions + misses[m] * solutionSize);
+        }
+    };
+
+    size_t numThreads = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), misses.size() / 16 + 1);
+
+    if (numThreads > 1)
+    {
+        std::vector<std::future<void>> futures;
+
+        for (size_t t = 0; t < numThreads; t++)
+        {
+            futures.push_back(std::async(std::launch::async, solveRange, misses.size() * t / numThreads, misses.size() * (t + 1) / numThreads));
+        }
+
+        for (size_t t = 0; t < futures.size(); t++)
+            futures[t].get();
+    }
+    else
+    {
+        solveRange(0, misses.size());
+    }
+
+    numSolved += misses.size();
+
+    // Store new solutions, evicting the least recently used ones
+
+    if (capacity > 0 && !misses.empty())
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+
+        ModelCache &cache = caches[request.modelIndex];
+
+        // Another request may have changed the grid meanwhile
+
+        if (cache.times == times)
+        {
+            for (size_t p : misses)
+            {
+                std::string key = problemKey(p);
+
+                if (cache.index.count(key) > 0)
+                    continue;
+
+                const double *solution = solutions + p * solutionSize;
+
+                cache.solutions.push_front(CachedSolution{key, std::vector<double>(solution, solution + solutionSize)});
+                cache.index[key] = cache.solutions.begin();
+
+                if (cache.solutions.size() > capacity)
+                {
+                    cache.index.erase(cache.solutions.back().key);
+                    cache.solutions.pop_back();
+                }
+            }
+        }
+    }
+
+    return response;
+}
@@ -0,0 +1,76 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#ifndef SOLVESERVICE_H
+#define SOLVESERVICE_H
+
+#include "solveprotocol.h"
+#include <atomic>
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Solves batched requests of the local solve service, see solveprotocol.h
+// Stays alive across requests and connections, keeping the solutions of recent problems
+// on the last time grid of each model, so that repeated problems (e.g. from fitting
+// tools or dashboards polling the same scenarios) are answered without integrating
+// Requests can be handled concurrently from several threads
+
+class SolveService
+{
+public:
+    explicit SolveService(size_t cacheCapacity = 65536);
+
+    // Returns the response payload for a request payload
+
+    std::vector<char> handle(const char *payload, size_t size);
+
+    uint64_t getNumSolved() const;
+    uint64_t getNumCacheHits() const;
+
+private:
+    struct CachedSolution
+    {
+        std::string key;
+        std::vector<double> values;
+    };
+
+    // Least recently used solutions of a model, valid for its time grid
+
+    struct ModelCache
+    {
+        std::vector<double> times;
+        std::list<CachedSolution> solutions;
+        std::unordered_map<std::string, std::list<CachedSolution>::iterator> index;
+    };
+
+    size_t capacity;
+
+    std::mutex cacheMutex;
+    std::vector<ModelCache> caches;
+
+    std::atomic<uint64_t> numSolved;
+    std::atomic<uint64_t> numCacheHits;
+
+    static std::vector<char> errorResponse(uint32_t requestId, const std::string &message);
+};
+
+#endif // SOLVESERVICE_H
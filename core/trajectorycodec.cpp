@@ -0,0 +1,397 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "trajectorycodec.h"
+#include <cstdint>
+#include <cstring>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+static int countLeadingZeros(uint64_t value)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return 63 - static_cast<int>(index);
+#else
+    return __builtin_clzll(value);
+#endif
+}
+
+static int countTrailingZeros(uint64_t value)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(value);
+#endif
+}
+
+static uint64_t doubleBits(double value)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static double bitsDouble(uint64_t bits)
+{
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+class BitWriter
+{
+public:
+    std::vector<unsigned char> &bytes;
+
+    BitWriter(std::vector<unsigned char> &out): bytes(out), bitCount(0){}
+
+    void writeBits(uint64_t value, int numBits)
+    {
+        for (int i = numBits - 1; i >= 0; i--)
+        {
+            if (bitCount % 8 == 0)
+            {
+                bytes.push_back(0);
+            }
+
+            if ((value >> i) & 1)
+            {
+                bytes.back() |= static_cast<unsigned char>(0x80 >> (bitCount % 8));
+            }
+
+            bitCount++;
+        }
+    }
+
+    void writeVarint(uint64_t value)
+    {
+        // Varints are byte aligned
+
+        bitCount = 8 * bytes.size();
+
+        while (value >= 0x80)
+        {
+            bytes.push_back(static_cast<unsigned char>(value | 0x80));
+            value >>= 7;
+        }
+
+        bytes.push_back(static_cast<unsigned char>(value));
+
+        bitCount = 8 * bytes.size();
+    }
+
+private:
+    size_t bitCount;
+};
+
+class BitReader
+{
+public:
+    // Set when reading past the end of the data or a malformed varint
+
+    bool failed;
+
+    BitReader(const unsigned char *in, size_t size): failed(false), data(in), numBytes(size), bitCount(0){}
+
+    uint64_t readBits(int numBits)
+    {
+        uint64_t value = 0;
+
+        for (int i = 0; i < numBits; i++)
+        {
+            size_t byteIndex = bitCount / 8;
+
+            if (byteIndex >= numBytes)
+            {
+                failed = true;
+                return 0;
+            }
+
+            unsigned bit = (data[byteIndex] >> (7 - bitCount % 8)) & 1;
+            value = (value << 1) | bit;
+            bitCount++;
+        }
+
+        return value;
+    }
+
+    uint64_t readVarint()
+    {
+        bitCount = 8 * ((bitCount + 7) / 8);
+
+        // A 64-bit value takes at most 10 bytes
+
+        uint64_t value = 0;
+
+        for (int shift = 0; shift < 70; shift += 7)
+        {
+            if (bitCount / 8 >= numBytes)
+            {
+                break;
+            }
+
+            unsigned char byte = data[bitCount / 8];
+            bitCount += 8;
+
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+
+            if (!(byte & 0x80))
+            {
+                return value;
+            }
+        }
+
+        failed = true;
+        return 0;
+    }
+
+private:
+    const unsigned char *data;
+    size_t numBytes;
+    size_t bitCount;
+};
+
+// Two's complement values held in unsigned integers, so that their arithmetic wraps around
+
+static uint64_t zigzagEncode(uint64_t value)
+{
+    return (value << 1) ^ (0 - (value >> 63));
+}
+
+static uint64_t zigzagDecode(uint64_t value)
+{
+    return (value >> 1) ^ (0 - (value & 1));
+}
+
+static void encodeValues(BitWriter &writer, const std::vector<state_type> &steps, size_t k)
+{
+    uint64_t previous = doubleBits(steps[0][k]);
+    int previousLeading = -1;
+    int previousTrailing = 0;
+
+    writer.writeBits(previous, 64);
+
+    for (size_t i = 1; i < steps.size(); i++)
+    {
+        uint64_t current = doubleBits(steps[i][k]);
+        uint64_t xorValue = current ^ previous;
+
+        if (xorValue == 0)
+        {
+            writer.writeBits(0, 1);
+        }
+        else
+        {
+            int leading = countLeadingZeros(xorValue);
+            int trailing = countTrailingZeros(xorValue);
+
+            if (leading > 31)
+            {
+                leading = 31;
+            }
+
+            writer.writeBits(1, 1);
+
+            if (previousLeading >= 0 && leading >= previousLeading && trailing >= previousTrailing)
+            {
+                // Meaningful bits fit in the previous window
+
+                writer.writeBits(0, 1);
+                writer.writeBits(xorValue >> previousTrailing, 64 - previousLeading - previousTrailing);
+            }
+            else
+            {
+                int meaningful = 64 - leading - trailing;
+
+                writer.writeBits(1, 1);
+                writer.writeBits(leading, 5);
+                writer.writeBits(meaningful & 63, 6);
+                writer.writeBits(xorValue >> trailing, meaningful);
+
+                previousLeading = leading;
+                previousTrailing = trailing;
+            }
+        }
+
+        previous = current;
+    }
+}
+
+static bool decodeValues(BitReader &reader, std::vector<state_type> &steps, size_t k)
+{
+    uint64_t previous = reader.readBits(64);
+    int previousLeading = -1;
+    int previousTrailing = 0;
+
+    steps[0][k] = bitsDouble(previous);
+
+    for (size_t i = 1; i < steps.size(); i++)
+    {
+        if (reader.readBits(1) == 1)
+        {
+            if (reader.readBits(1) == 1)
+            {
+                previousLeading = static_cast<int>(reader.readBits(5));
+
+                int meaningful = static_cast<int>(reader.readBits(6));
+
+                if (meaningful == 0)
+                {
+                    meaningful = 64;
+                }
+
+                previousTrailing = 64 - previousLeading - meaningful;
+            }
+
+            // A window must have been given, within the 64 bits of a double
+
+            if (previousLeading < 0 || previousTrailing < 0)
+            {
+                return false;
+            }
+
+            uint64_t xorValue = reader.readBits(64 - previousLeading - previousTrailing) << previousTrailing;
+            previous ^= xorValue;
+        }
+
+        steps[i][k] = bitsDouble(previous);
+    }
+
+    return !reader.failed;
+}
+
+std::vector<unsigned char> encodeTrajectory(const Trajectory &trajectory)
+{
+    std::vector<unsigned char> bytes;
+    BitWriter writer(bytes);
+
+    size_t numPoints = trajectory.times.size();
+    size_t dimension = numPoints > 0 ? trajectory.steps[0].size() : 0;
+
+    writer.writeVarint(numPoints);
+    writer.writeVarint(dimension);
+
+    if (numPoints == 0)
+    {
+        return bytes;
+    }
+
+    // Times: delta-of-delta of the bit patterns, monotonic for increasing positive times
+
+    uint64_t previous = 0;
+    uint64_t previousDelta = 0;
+
+    for (size_t i = 0; i < numPoints; i++)
+    {
+        uint64_t current = doubleBits(trajectory.times[i]);
+        uint64_t delta = current - previous;
+
+        writer.writeVarint(zigzagEncode(delta - previousDelta));
+
+        previous = current;
+        previousDelta = delta;
+    }
+
+    // Variables: one XOR stream per variable
+
+    for (size_t k = 0; k < dimension; k++)
+    {
+        encodeValues(writer, trajectory.steps, k);
+    }
+
+    return bytes;
+}
+
+std::shared_ptr<Trajectory> decodeTrajectory(const unsigned char *data, size_t size)
+{
+    std::shared_ptr<Trajectory> trajectory = std::make_shared<Trajectory>();
+
+    // Corrupt data decodes to an empty trajectory, its header is checked before allocating
+
+    size_t numPoints, dimension;
+
+    if (!encodedTrajectoryShape(data, size, numPoints, dimension) || numPoints == 0)
+    {
+        return trajectory;
+    }
+
+    trajectory->times.resize(numPoints);
+    trajectory->steps.assign(numPoints, state_type(dimension));
+
+    BitReader reader(data, size);
+
+    reader.readVarint();
+    reader.readVarint();
+
+    uint64_t previous = 0;
+    uint64_t previousDelta = 0;
+
+    for (size_t i = 0; i < numPoints; i++)
+    {
+        uint64_t delta = previousDelta + zigzagDecode(reader.readVarint());
+        uint64_t current = previous + delta;
+
+        trajectory->times[i] = bitsDouble(current);
+
+        previous = current;
+        previousDelta = delta;
+    }
+
+    for (size_t k = 0; k < dimension; k++)
+    {
+        if (!decodeValues(reader, trajectory->steps, k))
+        {
+            return std::make_shared<Trajectory>();
+        }
+    }
+
+    if (reader.failed)
+    {
+        return std::make_shared<Trajectory>();
+    }
+
+    return trajectory;
+}
+
+bool encodedTrajectoryShape(const unsigned char *data, size_t size, size_t &numPoints, size_t &dimension)
+{
+    if (size == 0)
+    {
+        return false;
+    }
+
+    BitReader reader(data, size);
+
+    numPoints = reader.readVarint();
+    dimension = reader.readVarint();
+
+    // Every time takes at least one byte, every variable 64 bits and one more bit per further point
+
+    if (reader.failed || numPoints > size || dimension > size / 8)
+    {
+        return false;
+    }
+
+    return dimension == 0 || numPoints <= 8 * size / dimension;
+}
@@ -0,0 +1,37 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef TRAJECTORYCODEC_H
+#define TRAJECTORYCODEC_H
+
+#include "scenario.h"
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+// Lossless compact encoding of solved trajectories
+// Times are stored as delta-of-delta of their bit patterns (zigzag varints)
+// Each variable is stored as a stream of XOR-compressed doubles
+
+std::vector<unsigned char> encodeTrajectory(const Trajectory &trajectory);
+std::shared_ptr<Trajectory> decodeTrajectory(const unsigned char *data, size_t size);
+
+// Number of points and dimension of an encoded trajectory, read from its header without decoding it
+
+bool encodedTrajectoryShape(const unsigned char *data, size_t size, size_t &numPoints, size_t &dimension);
+
+#endif // TRAJECTORYCODEC_H
@@ -0,0 +1,238 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "trajectoryfeed.h"
+#include "columnarwriter.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <new>
+
+TrajectoryFeedPublisher::TrajectoryFeedPublisher(QString feedKey, uint32_t feedNumSlots, uint64_t feedSlotSize): memory(feedKey)
+{
+    numSlots = feedNumSlots;
+    slotSize = feedSlotSize;
+}
+
+QString TrajectoryFeedPublisher::defaultKey()
+{
+    return "sirview-feed";
+}
+
+bool TrajectoryFeedPublisher::start()
+{
+    if (memory.isAttached())
+        return true;
+
+    // Shared memory sizes are ints, checked before multiplying so that they cannot overflow
+
+    uint64_t maxSize = static_cast<uint64_t>(std::numeric_limits<int>::max());
+
+    if (numSlots == 0 || slotSize > maxSize || sizeof(TrajectoryFeedSlot) + slotSize > (maxSize - sizeof(TrajectoryFeedHeader)) / numSlots)
+    {
+        error = QString("Feed of %1 slots of %2 MB is too large").arg(numSlots).arg(slotSize >> 20);
+        return false;
+    }
+
+    int size = static_cast<int>(sizeof(TrajectoryFeedHeader) + numSlots * (sizeof(TrajectoryFeedSlot) + slotSize));
+
+    // A segment left by a publisher that crashed is released by attaching and detaching as its last user
+
+    if (memory.attach(QSharedMemory::ReadOnly))
+        memory.detach();
+
+    if (!memory.create(size))
+    {
+        error = memory.errorString();
+        return false;
+    }
+
+    // Sequences are constructed in place, then the header is published with its magic
+
+    TrajectoryFeedHeader *feedHeader = new (memory.data()) TrajectoryFeedHeader;
+    feedHeader->version = trajectoryFeedVersion;
+    feedHeader->numSlots = numSlots;
+    feedHeader->slotSize = slotSize;
+    feedHeader->sequence.store(0, std::memory_order_relaxed);
+
+    for (uint32_t i = 0; i < numSlots; i++)
+    {
+        TrajectoryFeedSlot *feedSlot = new (slot(i)) TrajectoryFeedSlot;
+        feedSlot->sequence.store(0, std::memory_order_relaxed);
+        feedSlot->size = 0;
+    }
+
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(feedHeader->magic, trajectoryFeedMagic, sizeof(trajectoryFeedMagic));
+
+    return true;
+}
+
+void TrajectoryFeedPublisher::stop()
+{
+    memory.detach();
+}
+
+bool TrajectoryFeedPublisher::isActive() const
+{
+    return memory.isAttached();
+}
+
+QString TrajectoryFeedPublisher::getKey() const
+{
+    return memory.key();
+}
+
+QString TrajectoryFeedPublisher::errorString() const
+{
+    return error;
+}
+
+TrajectoryFeedHeader *TrajectoryFeedPublisher::header()
+{
+    return reinterpret_cast<TrajectoryFeedHeader*>(memory.data());
+}
+
+TrajectoryFeedSlot *TrajectoryFeedPublisher::slot(uint64_t index)
+{
+    char *base = reinterpret_cast<char*>(memory.data());
+
+    return reinterpret_cast<TrajectoryFeedSlot*>(base + sizeof(TrajectoryFeedHeader) + index * (sizeof(TrajectoryFeedSlot) + slotSize));
+}
+
+bool TrajectoryFeedPublisher::publish(const ExportSource &source)
+{
+    if (!memory.isAttached())
+        return false;
+
+    ColumnarWriter writer(source);
+
+    if (writer.getSize() > slotSize)
+    {
+        error = QString("Solved scenarios (%1 MB) do not fit in a feed slot (%2 MB)").arg(writer.getSize() >> 20).arg(slotSize >> 20);
+        return false;
+    }
+
+    TrajectoryFeedHeader *feedHeader = header();
+
+    uint64_t sequence = feedHeader->sequence.load(std::memory_order_relaxed) + 1;
+
+    TrajectoryFeedSlot *feedSlot = slot((sequence - 1) % numSlots);
+
+    // Odd while writing, so that readers of a previous chain in this slot retry
+
+    feedSlot->sequence.store(2 * sequence - 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    char *out = reinterpret_cast<char*>(feedSlot + 1);
+
+    writer.write([&out](const void *block, uint64_t size){
+        std::memcpy(out, block, size);
+        out += size;
+        return true;
+    });
+
+    feedSlot->size = writer.getSize();
+
+    feedSlot->sequence.store(2 * sequence, std::memory_order_release);
+    feedHeader->sequence.store(sequence, std::memory_order_release);
+
+    return true;
+}
+
+TrajectoryFeedReader::TrajectoryFeedReader(QString feedKey): memory(feedKey)
+{
+}
+
+bool TrajectoryFeedReader::attach()
+{
+    if (memory.isAttached())
+        return true;
+
+    if (!memory.attach(QSharedMemory::ReadOnly))
+        return false;
+
+    const TrajectoryFeedHeader *feedHeader = reinterpret_cast<const TrajectoryFeedHeader*>(memory.constData());
+
+    if (static_cast<size_t>(memory.size()) < sizeof(TrajectoryFeedHeader) ||
+        std::memcmp(feedHeader->magic, trajectoryFeedMagic, sizeof(trajectoryFeedMagic)) != 0 ||
+        feedHeader->version != trajectoryFeedVersion ||
+        static_cast<uint64_t>(memory.size()) < sizeof(TrajectoryFeedHeader) + feedHeader->numSlots * (sizeof(TrajectoryFeedSlot) + feedHeader->slotSize))
+    {
+        memory.detach();
+        return false;
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    return true;
+}
+
+void TrajectoryFeedReader::detach()
+{
+    memory.detach();
+}
+
+bool TrajectoryFeedReader::isAttached() const
+{
+    return memory.isAttached();
+}
+
+uint64_t TrajectoryFeedReader::getSequence() const
+{
+    if (!memory.isAttached())
+        return 0;
+
+    return reinterpret_cast<const TrajectoryFeedHeader*>(memory.constData())->sequence.load(std::memory_order_acquire);
+}
+
+uint64_t TrajectoryFeedReader::visitLatest(const std::function<void(const ColumnarReader &reader)> &visitor) const
+{
+    if (!memory.isAttached())
+        return 0;
+
+    const char *base = reinterpret_cast<const char*>(memory.constData());
+    const TrajectoryFeedHeader *feedHeader = reinterpret_cast<const TrajectoryFeedHeader*>(base);
+
+    while (true)
+    {
+        uint64_t sequence = feedHeader->sequence.load(std::memory_order_acquire);
+
+        if (sequence == 0)
+            return 0;
+
+        const TrajectoryFeedSlot *feedSlot = reinterpret_cast<const TrajectoryFeedSlot*>(base + sizeof(TrajectoryFeedHeader) + ((sequence - 1) % feedHeader->numSlots) * (sizeof(TrajectoryFeedSlot) + feedHeader->slotSize));
+
+        if (feedSlot->sequence.load(std::memory_order_acquire) != 2 * sequence)
+            continue;
+
+        // The size may be torn if the slot is being overwritten, then the check below fails
+
+        ColumnarReader reader;
+
+        bool valid = reader.open(feedSlot + 1, std::min<uint64_t>(feedSlot->size, feedHeader->slotSize));
+
+        if (valid)
+            visitor(reader);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (feedSlot->sequence.load(std::memory_order_relaxed) == 2 * sequence)
+            return valid ? sequence : 0;
+    }
+}
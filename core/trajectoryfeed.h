@@ -0,0 +1,117 @@
+// Copyright 2021 Jose Maria Castelo Ares
+
+// This file is part of SIRview.
+
+// SIRview is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// SIRview is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with SIRview.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#ifndef TRAJECTORYFEED_H
+#define TRAJECTORYFEED_H
+
+#include "exportjob.h"
+#include "columnarreader.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <QSharedMemory>
+#include <QString>
+
+// Live feed of solved scenario chains through a named shared memory ring
+//
+// TrajectoryFeedHeader
+// Slots: TrajectoryFeedSlot followed by slotSize bytes holding a columnar image
+//        (see columnarformat.h) of the published chain
+//
+// A single publisher writes chain n (counting from 1) into slot (n - 1) % numSlots.
+// Each slot is guarded by a sequence lock: its sequence is odd while being written
+// and 2n once chain n is complete, after which the header sequence is set to n.
+// Readers never block the publisher: they read the latest slot in place and
+// check that its sequence did not change meanwhile, otherwise they retry
+
+const char trajectoryFeedMagic[8] = {'S', 'I', 'R', 'V', 'I', 'E', 'W', 'F'};
+const uint32_t trajectoryFeedVersion = 1;
+
+struct TrajectoryFeedHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t numSlots;
+    uint64_t slotSize;
+    std::atomic<uint64_t> sequence;
+};
+
+struct TrajectoryFeedSlot
+{
+    std::atomic<uint64_t> sequence;
+    uint64_t size;
+};
+
+static_assert(sizeof(TrajectoryFeedHeader) == 32, "Unexpected trajectory feed header size");
+static_assert(sizeof(TrajectoryFeedSlot) == 16, "Unexpected trajectory feed slot size");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Shared memory sequences must be lock free");
+
+class TrajectoryFeedPublisher
+{
+public:
+    explicit TrajectoryFeedPublisher(QString feedKey = defaultKey(), uint32_t feedNumSlots = 4, uint64_t feedSlotSize = 32 << 20);
+
+    bool start();
+    void stop();
+
+    bool isActive() const;
+    QString getKey() const;
+    QString errorString() const;
+
+    // Fails if the chain does not fit in a slot
+
+    bool publish(const ExportSource &source);
+
+    static QString defaultKey();
+
+private:
+    QSharedMemory memory;
+    uint32_t numSlots;
+    uint64_t slotSize;
+    QString error;
+
+    TrajectoryFeedHeader *header();
+    TrajectoryFeedSlot *slot(uint64_t index);
+};
+
+class TrajectoryFeedReader
+{
+public:
+    explicit TrajectoryFeedReader(QString feedKey = TrajectoryFeedPublisher::defaultKey());
+
+    bool attach();
+    void detach();
+
+    bool isAttached() const;
+
+    // Number of chains published so far
+
+    uint64_t getSequence() const;
+
+    // Calls the visitor with the latest chain read in place, without copies
+    // The visitor is called again if the publisher overwrote the chain while it was
+    // being visited, so it must not keep pointers into the reader nor depend on being
+    // called once. Returns the sequence number of the visited chain, 0 if none
+
+    uint64_t visitLatest(const std::function<void(const ColumnarReader &reader)> &visitor) const;
+
+private:
+    QSharedMemory memory;
+};
+
+#endif // TRAJECTORYFEED_H